@@ -0,0 +1,274 @@
+#include "pomeloc/pomeloc.h"
+#include "pomeloc/idl.h"
+#include "pomeloc/compiler.h"
+#include "pomeloc/util.h"
+#include "pomeloc/stats.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Compile throughput benchmark on synthetic proto sets.
+// Builds a client and a server proto file of the requested size in memory,
+// then times parsing, the server/client merge and the C# generation
+// separately over several iterations. Nothing is written to disk.
+
+struct BenchOptions
+{
+    int routes;         // client routes
+    int fields;         // scalar fields per message
+    int depth;          // levels of nested messages under each route
+    double repeated;    // share of repeated fields
+    double responses;   // share of routes the server answers
+    double pushes;      // server pushes per client route
+    int iterations;
+    unsigned seed;
+    bool binary;
+    bool as_json;
+};
+
+// Small deterministic generator so runs are comparable across machines.
+class Random
+{
+public:
+    explicit Random(unsigned seed) : state_(seed ? seed : 1) {}
+
+    uint32_t Next()
+    {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_;
+    }
+
+    bool Chance(double p) { return Next() < p * 4294967295.0; }
+
+private:
+    uint32_t state_;
+};
+
+static const char* const kScalarTypes[] = {
+    "int32", "uInt32", "sInt32", "float", "double", "string"
+};
+
+// Writes the fields of one message and, below the last level, a nested
+// message that one of the fields refers to.
+static void SynthesizeMessage(const BenchOptions& opts, Random& rnd, int level,
+    std::string* out)
+{
+    int index = 1;
+    for (int i = 0; i < opts.fields; ++i)
+    {
+        const char* opt = rnd.Chance(opts.repeated) ? "repeated"
+            : (rnd.Next() & 1) ? "required" : "optional";
+        *out += "\"";
+        *out += opt;
+        *out += " ";
+        *out += kScalarTypes[rnd.Next() % 6];
+        *out += " f" + std::to_string(i) + "\": " + std::to_string(index++) + ",";
+    }
+    if (level < opts.depth)
+    {
+        std::string type = "Level" + std::to_string(level + 1);
+        *out += "\"message " + type + "\": {";
+        SynthesizeMessage(opts, rnd, level + 1, out);
+        *out += "},";
+        const char* opt = rnd.Chance(opts.repeated) ? "repeated" : "optional";
+        *out += "\"" + std::string(opt) + " " + type + " child\": " +
+            std::to_string(index++) + ",";
+    }
+    if (out->back() == ',') out->erase(out->size() - 1);
+}
+
+static std::string RouteName(int i)
+{
+    return "area" + std::to_string(i % 16) + ".handler" + std::to_string(i / 16 % 64) +
+        ".method" + std::to_string(i);
+}
+
+static void Synthesize(const BenchOptions& opts, std::string* client, std::string* server)
+{
+    Random rnd(opts.seed);
+    *client = "{";
+    *server = "{";
+    for (int i = 0; i < opts.routes; ++i)
+    {
+        if (i) *client += ",";
+        *client += "\"" + RouteName(i) + "\": {";
+        SynthesizeMessage(opts, rnd, 0, client);
+        *client += "}";
+        if (rnd.Chance(opts.responses))
+        {
+            if (server->size() > 1) *server += ",";
+            *server += "\"" + RouteName(i) + "\": {";
+            SynthesizeMessage(opts, rnd, 0, server);
+            *server += "}";
+        }
+    }
+    int pushes = static_cast<int>(opts.routes * opts.pushes);
+    for (int i = 0; i < pushes; ++i)
+    {
+        if (server->size() > 1) *server += ",";
+        *server += "\"onPush" + std::to_string(i) + "\": {";
+        SynthesizeMessage(opts, rnd, 0, server);
+        *server += "}";
+    }
+    *client += "}";
+    *server += "}";
+}
+
+// One full compile, charged to the parse, merge and emit phases.
+static bool CompileOnce(const BenchOptions& opts, const std::string& client_json,
+    const std::string& server_json, pomeloc::Stats* stats, size_t* routes)
+{
+    pomeloc::IDLOptions idl;
+    idl.binary_codec = opts.binary;
+    pomeloc::Parser client(idl);
+    pomeloc::Parser server(idl);
+    client.stats_ = stats;
+    {
+        pomeloc::ScopedPhase phase(stats, pomeloc::kPhaseParse);
+        if (!client.Parse(client_json.c_str(), client_json.size(), "client") ||
+            !server.Parse(server_json.c_str(), server_json.size(), "server"))
+        {
+            printf("%s%s", client.error_.c_str(), server.error_.c_str());
+            return false;
+        }
+        phase.AddBytes(client_json.size() + server_json.size());
+    }
+    {
+        pomeloc::ScopedPhase phase(stats, pomeloc::kPhaseMerge);
+        pomeloc::MergeServerRoutes(server.structs_, &client);
+    }
+    *routes = client.structs_.size() + client.event_structs_.size();
+
+    std::vector<pomeloc::GeneratedFile> files;
+    client.outputs_ = &files;
+    pomeloc::ScopedPhase phase(stats, pomeloc::kPhaseEmit);
+    if (!pomeloc::GenerateGeneral(client, "", "clientProtos"))
+    {
+        printf("unable to generate C#\n");
+        return false;
+    }
+    return true;
+}
+
+static double Median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+static void Usage(const char* program)
+{
+    printf(
+        "usage: %s [OPTION]...\n"
+        "  --routes N      client routes, default 5000\n"
+        "  --fields N      scalar fields per message, default 8\n"
+        "  --depth N       nested message levels per route, default 2\n"
+        "  --repeated R    share of repeated fields, default 0.25\n"
+        "  --responses R   share of routes with a server response, default 0.7\n"
+        "  --pushes R      server pushes per client route, default 0.1\n"
+        "  --iterations N  compiles to time, default 5\n"
+        "  --seed N        seed of the synthetic schema, default 1\n"
+        "  --binary        also generate the pomelo-protobuf codecs\n"
+        "  --json          print the results as a json object\n",
+        program);
+    exit(1);
+}
+
+int main(int argc, const char* argv[])
+{
+    BenchOptions opts = { 5000, 8, 2, 0.25, 0.7, 0.1, 5, 1, false, false };
+    for (int argi = 1; argi < argc; argi++)
+    {
+        std::string arg = argv[argi];
+        bool has_value = argi + 1 < argc;
+        if (arg == "--routes" && has_value) opts.routes = atoi(argv[++argi]);
+        else if (arg == "--fields" && has_value) opts.fields = atoi(argv[++argi]);
+        else if (arg == "--depth" && has_value) opts.depth = atoi(argv[++argi]);
+        else if (arg == "--repeated" && has_value) opts.repeated = atof(argv[++argi]);
+        else if (arg == "--responses" && has_value) opts.responses = atof(argv[++argi]);
+        else if (arg == "--pushes" && has_value) opts.pushes = atof(argv[++argi]);
+        else if (arg == "--iterations" && has_value) opts.iterations = atoi(argv[++argi]);
+        else if (arg == "--seed" && has_value) opts.seed = atoi(argv[++argi]);
+        else if (arg == "--binary") opts.binary = true;
+        else if (arg == "--json") opts.as_json = true;
+        else Usage(argv[0]);
+    }
+    if (opts.routes < 1 || opts.fields < 1 || opts.depth < 0 || opts.iterations < 1)
+        Usage(argv[0]);
+
+    std::string client_json, server_json;
+    Synthesize(opts, &client_json, &server_json);
+    double input_mb = (client_json.size() + server_json.size()) / (1024.0 * 1024.0);
+
+    const pomeloc::Phase timed[] = {
+        pomeloc::kPhaseParse, pomeloc::kPhaseMerge, pomeloc::kPhaseEmit
+    };
+    const size_t num_timed = sizeof(timed) / sizeof(timed[0]);
+    std::vector<double> seconds[num_timed];
+    std::vector<double> totals;
+    uint64_t output_bytes = 0;
+    size_t routes = 0;
+    for (int i = 0; i < opts.iterations; ++i)
+    {
+        pomeloc::Stats stats;
+        if (!CompileOnce(opts, client_json, server_json, &stats, &routes)) return 1;
+        stats.Stop();
+        for (size_t p = 0; p < num_timed; ++p)
+        {
+            seconds[p].push_back(stats.phase(timed[p]).seconds_);
+        }
+        totals.push_back(stats.total_seconds());
+        output_bytes = stats.phase(pomeloc::kPhaseEmit).bytes_;
+    }
+
+    double output_mb = output_bytes / (1024.0 * 1024.0);
+    // Parse reads the input, emit produces the output, merge only moves
+    // routes.
+    const double phase_mb[num_timed] = { input_mb, 0, output_mb };
+    uint64_t rss = pomeloc::PeakRssKb();
+    if (opts.as_json)
+    {
+        json root = json::object();
+        json& schema = root["schema"];
+        schema["routes"] = routes;
+        schema["input_bytes"] = client_json.size() + server_json.size();
+        schema["output_bytes"] = output_bytes;
+        json& phases = root["phases"];
+        for (size_t p = 0; p < num_timed; ++p)
+        {
+            double median = Median(seconds[p]);
+            json& item = phases[pomeloc::kPhaseNames[timed[p]]];
+            item["ms"] = median * 1000;
+            item["routes_per_sec"] = routes / median;
+            if (phase_mb[p] > 0) item["mb_per_sec"] = phase_mb[p] / median;
+        }
+        double total = Median(totals);
+        root["total_ms"] = total * 1000;
+        root["routes_per_sec"] = routes / total;
+        root["iterations"] = opts.iterations;
+        root["peak_rss_kb"] = rss;
+        printf("%s\n", root.dump().c_str());
+        return 0;
+    }
+
+    printf("schema   %llu routes, %.2f MB in, %.2f MB out\n",
+        static_cast<unsigned long long>(routes), input_mb, output_mb);
+    printf("%-8s %10s %14s %10s\n", "phase", "ms", "routes/s", "MB/s");
+    for (size_t p = 0; p < num_timed; ++p)
+    {
+        double median = Median(seconds[p]);
+        printf("%-8s %10.3f %14.0f", pomeloc::kPhaseNames[timed[p]], median * 1000,
+            routes / median);
+        if (phase_mb[p] > 0) printf(" %10.1f\n", phase_mb[p] / median);
+        else printf(" %10s\n", "-");
+    }
+    double total = Median(totals);
+    printf("%-8s %10.3f %14.0f\n", "total", total * 1000, routes / total);
+    printf("median of %d iterations, peak rss %llu KB\n", opts.iterations,
+        static_cast<unsigned long long>(rss));
+    return 0;
+}
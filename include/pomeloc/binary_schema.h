@@ -0,0 +1,78 @@
+#ifndef POMELOC_BINARY_SCHEMA_H_
+#define POMELOC_BINARY_SCHEMA_H_
+
+#include <string>
+
+#include "pomeloc/idl.h"
+#include "pomeloc/schema.h"
+#include "pomeloc/util.h"
+#include "pomeloc/reflection_generated.h"
+
+// Precompiled schema (.pbfs): the merged routes, responses and pushes
+// serialized as a reflection::Schema, so tools can map the file and read
+// it in place instead of parsing the proto JSON again.
+//
+// Layout:
+//   objects  every message, sorted by name for LookupByKey. A request or
+//            push is named after its route ("chat.chatHandler.send"), a
+//            response "<route>:response" and a nested message
+//            "<parent>/<name>".
+//   fields   sorted by name. id is the protobuf field number, required is
+//            set for required fields. type.base_type is the pomelo type, or
+//            Vector with the type in type.element for repeated fields: Int
+//            (int32 and sInt32, pomelo zigzags both), UInt, Float, Double,
+//            String or Obj, whose object is type.index. offset stays 0, the
+//            messages have no table layout.
+//   enums    "routes": the client routes, each value's object is the
+//            request and its value the object index of the response or -1.
+//            "pushes": the server pushes, each value's object is the push.
+//            Both are in route order.
+
+namespace pomeloc
+{
+    const char* const kBinarySchemaIdentifier = "PBFS";
+    const char* const kBinarySchemaExtension = "pbfs";
+
+    // Serializes a flattened schema and finishes the builder. Fails if a
+    // field number does not fit the 16 bit id of a reflection field.
+    bool BuildBinarySchema(const FlatSchema& schema, FlatBufferBuilder* fbb,
+        std::string* error);
+
+    // Checks the identifier and runs the Verifier over a whole buffer.
+    // Returns the schema, or nullptr if the buffer is not a valid .pbfs.
+    const reflection::Schema* VerifyBinarySchema(const void* buf, size_t len);
+
+    // The pomelo type of a field from its base type, or its element type
+    // for a vector. Fails for base types pomelo has no type for.
+    bool GetFieldType(const reflection::Field& field, kType* type);
+
+    // Index of the object called name, -1 if there is none.
+    int32_t LookupObject(const reflection::Schema& schema, const char* name);
+
+    // Rebuilds the IR of a client parser with its responses and pushes
+    // merged in, so every generator can run from a precompiled schema.
+    bool LoadBinarySchema(const reflection::Schema& schema, Parser* parser,
+        std::string* error);
+
+    // A .pbfs file mapped into memory and verified once. The schema points
+    // into the mapping and lives as long as this object.
+    class BinarySchemaFile
+    {
+    public:
+        BinarySchemaFile() : schema_(nullptr) {}
+
+        bool Open(const std::string& path);
+
+        const reflection::Schema* schema() const { return schema_; }
+
+    private:
+        MappedFile file_;
+        const reflection::Schema* schema_;
+
+    public:
+        std::string error_;     // User readable error_ if Open() returned false
+    };
+
+}  // namespace pomeloc
+
+#endif  // POMELOC_BINARY_SCHEMA_H_
@@ -0,0 +1,236 @@
+#ifndef POMELOC_CODE_WRITER_H_
+#define POMELOC_CODE_WRITER_H_
+
+#include <cassert>
+#include <cstring>
+#include <string>
+
+// Output sink of the generators.
+// Generators append brace-soup ("class A{int a;}") and the writer lays it
+// out while appending: every '{' opens an indented block on its own line,
+// and every ';' or '}' ends a line. A "};" stays on one line, so does a
+// ';' inside parentheses as in for(;;), and a "= {...}" initializer.
+// Each byte is written once into a buffer sized up front, instead of
+// building the whole file and indenting it in a second pass.
+
+namespace pomeloc
+{
+    class CodeWriter
+    {
+    public:
+        explicit CodeWriter(size_t reserve = 0)
+            : depth_(0), state_(kText), inline_depth_(0)
+        {
+            out_.reserve(reserve);
+        }
+
+        // A fragment continues another writer at the given block depth,
+        // right after that writer's EndLine(). Fragments can be written
+        // independently and joined in order with Append().
+        CodeWriter(size_t reserve, int depth)
+            : depth_(depth), state_(kText), inline_depth_(0)
+        {
+            out_.reserve(reserve);
+        }
+
+        CodeWriter& operator+=(char ch)
+        {
+            Put(ch);
+            return *this;
+        }
+
+        CodeWriter& operator+=(const char* str)
+        {
+            Append(str, strlen(str));
+            return *this;
+        }
+
+        CodeWriter& operator+=(const std::string& str)
+        {
+            Append(str.c_str(), str.size());
+            return *this;
+        }
+
+        void Append(const char* str, size_t len)
+        {
+            const char* end = str + len;
+            while (str < end)
+            {
+                if (state_ != kText)
+                {
+                    Put(*str++);
+                    continue;
+                }
+                // copy the run up to the next layout character in one go
+                const char* run = str;
+                while (str < end && *str != '{' && *str != '}' && *str != ';')
+                {
+                    ++str;
+                }
+                out_.append(run, str - run);
+                if (str < end)
+                {
+                    Put(*str++);
+                }
+            }
+        }
+
+        // Breaks a pending line so the next text starts on a fresh one.
+        // That text must not start with '}' or ';'.
+        void EndLine()
+        {
+            if (state_ == kAfterBrace)
+            {
+                --depth_;
+                state_ = kLineBreak;
+            }
+            if (state_ == kLineBreak)
+            {
+                NewLine(depth_);
+                state_ = kText;
+            }
+        }
+
+        // Joins a fragment created at depth() after EndLine().
+        void Append(const CodeWriter& fragment)
+        {
+            assert(state_ == kText);
+            out_ += fragment.out_;
+            depth_ = fragment.depth_;
+            state_ = fragment.state_;
+        }
+
+        // Appends text without layout, e.g. preprocessor lines. Only valid
+        // outside of any block.
+        void AppendRaw(const std::string& str)
+        {
+            Finish();
+            out_ += str;
+        }
+
+        // Ends the pending line. The text is complete once every block
+        // is closed.
+        const std::string& Finish()
+        {
+            EndLine();
+            assert(0 == depth_ && "mismatch {} !!!");
+            return out_;
+        }
+
+        const std::string& str() const { return out_; }
+        int depth() const { return depth_; }
+        size_t size() const { return out_.size(); }
+
+    private:
+        enum State
+        {
+            kText,          // inside a line
+            kAfterBrace,    // a '}' was written, a ';' may still join it
+            kLineBreak,     // the line ended, its indent waits for the next char
+            kInline,        // inside a "= {...}" initializer, copied as is
+        };
+
+        void NewLine(int depth)
+        {
+            out_ += '\n';
+            if (depth > 0)
+            {
+                out_.append(4 * depth, ' ');
+            }
+        }
+
+        // The last non-blank character of the current line, or 0.
+        char LastChar() const
+        {
+            for (size_t i = out_.size(); i-- > 0 && out_[i] != '\n';)
+            {
+                if (out_[i] != ' ') return out_[i];
+            }
+            return 0;
+        }
+
+        // Whether the current line has an unclosed '('.
+        bool InParens() const
+        {
+            int open = 0;
+            for (size_t i = out_.size(); i-- > 0 && out_[i] != '\n';)
+            {
+                if (out_[i] == '(') ++open;
+                else if (out_[i] == ')') --open;
+            }
+            return open > 0;
+        }
+
+        void Put(char ch)
+        {
+            if (state_ == kInline)
+            {
+                out_ += ch;
+                if (ch == '{') ++inline_depth_;
+                else if (ch == '}' && --inline_depth_ == 0) state_ = kText;
+                return;
+            }
+            if (state_ == kAfterBrace)
+            {
+                --depth_;
+                state_ = kLineBreak;
+                if (ch == ';')
+                {
+                    out_ += ch;
+                    return;
+                }
+            }
+            if (state_ == kLineBreak)
+            {
+                // a closing brace is outdented to its block
+                NewLine(ch == '}' ? depth_ - 1 : depth_);
+                state_ = kText;
+            }
+            switch (ch)
+            {
+            case '{':
+            {
+                char last = LastChar();
+                if (last == '=')
+                {
+                    out_ += ch;
+                    inline_depth_ = 1;
+                    state_ = kInline;
+                    break;
+                }
+                // a brace at the start of a line does not break it again
+                if (last != 0)
+                {
+                    NewLine(depth_);
+                }
+                ++depth_;
+                out_ += ch;
+                NewLine(depth_);
+                break;
+            }
+            case '}':
+                out_ += ch;
+                state_ = kAfterBrace;
+                break;
+            case ';':
+                out_ += ch;
+                if (!InParens())
+                {
+                    state_ = kLineBreak;
+                }
+                break;
+            default:
+                out_ += ch;
+                break;
+            }
+        }
+
+        std::string out_;
+        int depth_;
+        State state_;
+        int inline_depth_;  // open braces of a kInline initializer
+    };
+
+}  // namespace pomeloc
+
+#endif  // POMELOC_CODE_WRITER_H_
@@ -0,0 +1,152 @@
+#ifndef POMELOC_CODEC_H_
+#define POMELOC_CODEC_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "pomeloc/idl.h"
+#include "pomeloc/schema.h"
+#include "pomeloc/reflection_generated.h"
+
+// Table-driven pomelo-protobuf codec built from the flattened schema.
+// Every schema message is compiled once into a field table with
+// precomputed tags, so encoding and decoding never touch the IR again.
+
+namespace pomeloc
+{
+    enum WireType
+    {
+        kWireVarint = 0,
+        kWireFixed64 = 1,
+        kWireLengthDelimited = 2,
+        kWireFixed32 = 5,
+    };
+
+    // One field of a compiled message, ordered by index_ inside its table.
+    struct CodecField
+    {
+        int32_t index_;
+        MetaTypeOpt opt_;
+        kType type_;
+        WireType wire_;
+        bool packed_;           // repeated numeric: one tag, count, values
+        int32_t message_;       // table of a kMessage field, -1 otherwise
+        uint32_t tag_;          // (index_ << 3) | wire_
+        uint8_t tag_size_;
+        uint8_t tag_bytes_[5];  // tag_ as an encoded varint
+        std::string name_;
+    };
+
+    struct CodecMessage
+    {
+        std::string name_;
+        std::vector<CodecField> fields_;
+        // Field index_ -> slot in fields_, -1 if unknown. Empty when the
+        // indices are too sparse, lookups then binary search fields_.
+        std::vector<int16_t> slots_;
+    };
+
+    // The message a route carries: the request a client sends on it, the
+    // response the server answers with, or the message of a push.
+    enum RouteDirection
+    {
+        kRequest,
+        kResponse,
+        kPush,
+        kRouteDirectionMAX
+    };
+
+    // Receives the typed values of a decoded message in wire order.
+    // Repeated fields report one call per element.
+    class CodecVisitor
+    {
+    public:
+        virtual ~CodecVisitor() {}
+        virtual void OnInt32(const CodecField& field, int32_t val) = 0;
+        virtual void OnUInt32(const CodecField& field, uint32_t val) = 0;
+        virtual void OnFloat(const CodecField& field, float val) = 0;
+        virtual void OnDouble(const CodecField& field, double val) = 0;
+        virtual void OnString(const CodecField& field, const char* str, size_t len) = 0;
+        virtual void BeginMessage(const CodecField& field, const CodecMessage& msg) = 0;
+        virtual void EndMessage(const CodecField& field, const CodecMessage& msg) = 0;
+    };
+
+    class Codec
+    {
+    public:
+        Codec() {}
+
+        // Compiles every route of a parsed proto file. A parser with the
+        // client and server protos merged knows all three directions.
+        bool Load(const Parser& parser);
+        bool Load(const FlatSchema& schema);
+        // Compiles a verified .pbfs schema, table ids are its object
+        // indices. See binary_schema.h.
+        bool Load(const reflection::Schema& schema);
+
+        // Table id of a route's message, -1 if unknown. Notifies have no
+        // response.
+        int32_t LookupRoute(const std::string& route, RouteDirection dir) const;
+        const CodecMessage& GetMessage(int32_t id) const { return messages_[id]; }
+
+        bool Encode(const std::string& route, RouteDirection dir, const json& msg,
+            std::string* out);
+        bool Encode(int32_t id, const json& msg, std::string* out);
+
+        bool Decode(const std::string& route, RouteDirection dir, const uint8_t* buf,
+            size_t len, json* out);
+        bool Decode(int32_t id, const uint8_t* buf, size_t len, json* out);
+        bool Decode(const std::string& route, RouteDirection dir, const uint8_t* buf,
+            size_t len, CodecVisitor* visitor);
+        bool Decode(int32_t id, const uint8_t* buf, size_t len, CodecVisitor* visitor);
+
+        // What a client sends and receives.
+        bool EncodeRequest(const std::string& route, const json& msg, std::string* out)
+        {
+            return Encode(route, kRequest, msg, out);
+        }
+        bool DecodeResponse(const std::string& route, const uint8_t* buf, size_t len,
+            json* out)
+        {
+            return Decode(route, kResponse, buf, len, out);
+        }
+        bool DecodeResponse(const std::string& route, const uint8_t* buf, size_t len,
+            CodecVisitor* visitor)
+        {
+            return Decode(route, kResponse, buf, len, visitor);
+        }
+        bool DecodePush(const std::string& route, const uint8_t* buf, size_t len,
+            json* out)
+        {
+            return Decode(route, kPush, buf, len, out);
+        }
+        bool DecodePush(const std::string& route, const uint8_t* buf, size_t len,
+            CodecVisitor* visitor)
+        {
+            return Decode(route, kPush, buf, len, visitor);
+        }
+
+    private:
+        bool CompileMessage(const FlatSchema& schema, int32_t id);
+        bool CompileMessage(const reflection::Schema& schema, int32_t id);
+        bool CompileField(const CodecMessage& msg, CodecField* field);
+        void BuildSlots(CodecMessage* msg);
+        const CodecField* LookupField(const CodecMessage& msg, int32_t index) const;
+        bool EncodeMessage(int32_t id, const json& msg, std::string* out);
+        bool EncodeValue(const CodecField& field, const json& val, std::string* out);
+        bool DecodeMessage(int32_t id, const uint8_t* p, const uint8_t* end,
+            CodecVisitor* visitor, int depth);
+        bool Error(const std::string& msg);
+        void Clear();
+
+    public:
+        std::vector<CodecMessage> messages_;
+        // Route -> table id, one map per RouteDirection.
+        std::unordered_map<std::string, int32_t> routes_[kRouteDirectionMAX];
+        std::string error_;     // User readable error_ if a call returned false
+    };
+
+}  // namespace pomeloc
+
+#endif  // POMELOC_CODEC_H_
@@ -0,0 +1,63 @@
+#ifndef POMELOC_COMPILER_H_
+#define POMELOC_COMPILER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "pomeloc/idl.h"
+
+// Embeddable entry points of pomeloc. Nothing in here touches the disk or
+// exits the process: proto JSON comes in as strings, generated sources go
+// out as buffers and failures are returned as error_ strings.
+
+namespace pomeloc
+{
+    // Concatenates the routes parsed from the fragments of one side, sorted
+    // by route like the routes of a single file. Fails on a route defined by
+    // two fragments, names label the fragments in the error.
+    bool MergeFragments(std::vector<std::vector<RootStruct>>& fragments,
+        const std::vector<std::string>& names, std::vector<RootStruct>* routes,
+        std::string* error);
+
+    // Moves server routes into a client parser: the responses of requests
+    // go to response_maps_ and pushes to event_structs_.
+    void MergeServerRoutes(std::vector<RootStruct>& server, Parser* client);
+
+    // Keeps parsed proto fragments resident between compiles, so a caller
+    // only pays for parsing the fragments it replaces. Not thread safe.
+    class Compiler
+    {
+    public:
+        explicit Compiler(const IDLOptions& options = IDLOptions());
+
+        // Adds the fragment called name, or replaces it if it exists. The
+        // json does not need to be zero terminated.
+        bool SetClientProtos(const std::string& name, const char* json, size_t length);
+        bool SetServerProtos(const std::string& name, const char* json, size_t length);
+
+        void RemoveProtos(const std::string& name);
+        void Clear();
+
+        // Generates the code of every fragment set so far. file_name names
+        // the output in one-file mode. The files are appended to "files".
+        bool Generate(IDLOptions::Language lang, const std::string& file_name,
+            std::vector<GeneratedFile>* files);
+
+        IDLOptions opts;
+        std::string error_;         // User readable error_ if a call returned false
+
+    private:
+        typedef std::map<std::string, std::vector<RootStruct>> Fragments;
+
+        bool SetProtos(Fragments& side, const std::string& name, const char* json,
+            size_t length);
+        bool MergeSide(const Fragments& side, std::vector<RootStruct>* routes);
+
+        Fragments client_;
+        Fragments server_;
+    };
+
+}  // namespace pomeloc
+
+#endif  // POMELOC_COMPILER_H_
@@ -17,6 +17,10 @@ using namespace nlohmann;
 
 namespace pomeloc
 {
+    struct sslice;
+    class Stats;
+    struct ServerRoutes;
+
     enum MetaTypeOpt
     {
         kRequired = 0,
@@ -57,51 +61,21 @@ namespace pomeloc
         std::string name_;
         std::string ns_;
         std::vector<MetaVariable> vars_;
-        std::unordered_map<std::string, tagMetaStruct> structs_;
+        std::map<std::string, tagMetaStruct> structs_;
     }MetaStruct;
-    typedef struct tagRootStruct
+    // A route is a message with routing information. Sharing the base lets
+    // the generators and the merge step use a route as its message and move
+    // the definition instead of copying it.
+    typedef struct tagRootStruct : public tagMetaStruct
     {
         tagRootStruct()
             : is_event_(false)
         {
-
         }
 
-		tagRootStruct(const tagRootStruct& it)
-		{
-			if (&it != this)
-			{
-				this->ns_ = it.ns_;
-				this->class_ = it.class_;
-				this->method_ = it.method_;
-				this->router_ = it.router_;
-				this->vars_ = it.vars_;
-				this->structs_ = it.structs_;
-                this->is_event_ = it.is_event_;
-			}
-		}
-		tagRootStruct& operator=(const tagRootStruct& it)
-		{
-			if (&it == this)
-			{
-				return *this;
-			}
-			this->ns_ = it.ns_;
-			this->class_ = it.class_;
-			this->method_ = it.method_;
-			this->router_ = it.router_;
-			this->vars_ = it.vars_;
-			this->structs_ = it.structs_;
-            this->is_event_ = it.is_event_;
-            return *this;
-		}
-
-        std::string ns_;
         std::string class_;
         std::string method_;
         std::string router_;
-        std::vector<MetaVariable> vars_;
-        std::unordered_map<std::string, tagMetaStruct> structs_;
         bool is_event_;
     }RootStruct;
 
@@ -121,12 +95,21 @@ namespace pomeloc
         bool proto_mode;
         bool generate_all;
         bool skip_unexpected_fields_in_json;
+        bool binary_codec;
+        bool route_ids;     // pass pomelo dictionary codes instead of route strings
+        // The routes the server numbers, from --routes, may be null.
+        std::shared_ptr<const ServerRoutes> server_routes;
+        bool pooled;        // recycle generated message objects through pools
+        bool value_structs; // emit small nested messages as C# structs
+        bool stream_json;   // send requests through a reused JsonWriter
+        bool read_json;     // read responses and pushes with a JsonReader
+        int jobs;   // worker threads the generators may use
         std::string custom_ns;
 
         // Possible options for the more general generator below.
         enum Language
         {
-            kCSharp, kMAX
+            kCSharp, kCpp, kMAX
         };
 
         Language lang;
@@ -139,12 +122,20 @@ namespace pomeloc
             output_enum_identifiers(true), prefixed_enums(true), scoped_enums(false),
             include_dependence_headers(true),
             mutable_buffer(false),
-            one_file(false),
+            one_file(true),
             proto_mode(false),
             generate_all(false),
             skip_unexpected_fields_in_json(false),
-            lang(IDLOptions::kCSharp),
-            custom_ns("")
+            binary_codec(false),
+            route_ids(false),
+            server_routes(),
+            pooled(false),
+            value_structs(false),
+            stream_json(false),
+            read_json(false),
+            jobs(1),
+            custom_ns(""),
+            lang(IDLOptions::kCSharp)
         {}
     };
 
@@ -199,11 +190,19 @@ namespace pomeloc
 #define FLATBUFFERS_CHECKED_ERROR CheckedError
 #endif
 
+    // A generated source file handed back in memory instead of written.
+    struct GeneratedFile
+    {
+        std::string name_;
+        std::string contents_;
+    };
+
     class Parser
     {
     public:
         explicit Parser(const IDLOptions &options = IDLOptions())
-            : opts(options)
+            : cursor_(nullptr), end_(nullptr), line_(1), stats_(nullptr),
+            outputs_(nullptr), opts(options)
         {
         }
 
@@ -212,29 +211,80 @@ namespace pomeloc
         }
         bool Parse(const char *_source,
             const char *source_filename);
+        // _source does not need to be zero terminated, so a mapped file can
+        // be parsed in place.
+        bool Parse(const char *_source, size_t length,
+            const char *source_filename);
 
     private:
         FLATBUFFERS_CHECKED_ERROR Error(const std::string &msg);
-        FLATBUFFERS_CHECKED_ERROR DoParse(const char *_source,
+        FLATBUFFERS_CHECKED_ERROR DoParse(const char *_source, size_t length,
             const char *source_filename);
-        FLATBUFFERS_CHECKED_ERROR ParseRoot(std::vector<RootStruct>& rss, const char* key, json& val);
-        FLATBUFFERS_CHECKED_ERROR ParseStruct(std::unordered_map<std::string, MetaStruct>& lookupt,
-            const char* key, json& val);
-        FLATBUFFERS_CHECKED_ERROR ParseVariable(std::unordered_map<std::string, MetaStruct>& lookupt, 
-            std::vector<MetaVariable>& ret, const char* key, json& val);
+        void SkipWhitespace();
+        FLATBUFFERS_CHECKED_ERROR Expect(char ch);
+        FLATBUFFERS_CHECKED_ERROR NextMember(bool* more);
+        FLATBUFFERS_CHECKED_ERROR ParseKey(sslice* key);
+        FLATBUFFERS_CHECKED_ERROR ParseInteger(int32_t* val);
+        FLATBUFFERS_CHECKED_ERROR ParseMembers(std::map<std::string, MetaStruct>& lookupt,
+            std::vector<MetaVariable>& vars);
+        FLATBUFFERS_CHECKED_ERROR ResolveVariables(const std::map<std::string, MetaStruct>& lookupt,
+            std::vector<MetaVariable>& vars);
+        FLATBUFFERS_CHECKED_ERROR ParseRoot(std::vector<RootStruct>& rss, const sslice& key);
+        FLATBUFFERS_CHECKED_ERROR ParseStruct(std::map<std::string, MetaStruct>& lookupt,
+            const sslice& key, const sslice* words);
+        FLATBUFFERS_CHECKED_ERROR ParseVariable(std::vector<MetaVariable>& ret, const sslice& key,
+            const sslice* words);
+
+        const char* cursor_;
+        const char* end_;
+        int line_;
+        std::string key_buf_;
 
     public:
-        nlohmann::json json_content_;
         std::vector<RootStruct> structs_;
         std::unordered_map<std::string, MetaStruct> response_maps_;
         std::vector<RootStruct> event_structs_;
         std::string error_;         // User readable error_ if Parse() == false
+        // Files the generators produced from this parser, written or not.
+        mutable std::vector<std::string> generated_files_;
+        // Phase counters the generators report into, may be null.
+        Stats* stats_;
+        // When set, the generators append their files here and leave the
+        // disk alone.
+        std::vector<GeneratedFile>* outputs_;
 
         IDLOptions opts;
     };
 
     // Utility functions for multiple generators:
 
+    // Saves a generated file unless it is unchanged on disk, or hands it to
+    // parser.outputs_. Records it in generated_files_ either way.
+    extern bool SaveGeneratedFile(const Parser &parser, const std::string &filename,
+        const std::string &code, bool binary = false);
+
+    // Pomelo dictionary codes. The server numbers every handler route from
+    // 1 in sorted order and appends the routes of config/dictionary.json.
+    // Without opts.server_routes the client routes are taken to be every
+    // handler route, so they get 1..n and the pushes follow. Fails past the
+    // 16 bit code range or when a route is not in opts.server_routes.
+    // See idl_gen_dictionary.cpp.
+    typedef std::unordered_map<std::string, uint16_t> RouteIds;
+    extern bool AssignRouteIds(const Parser &parser, RouteIds *ids,
+        std::string *error = nullptr);
+
+    // The routes of the server. A handler manifest, a json array of every
+    // handler route, is numbered the way the server does and the pushes
+    // follow. A dictionary, the json object of route codes a client gets in
+    // the handshake, fixes the code of every route, pushes included.
+    struct ServerRoutes
+    {
+        RouteIds ids;
+        bool complete;  // a dictionary, the pushes must be listed too
+    };
+    extern bool ParseServerRoutes(const std::string &text, ServerRoutes *routes,
+        std::string *error);
+
     extern std::string MakeCamel(const std::string &in, bool first = true);
 
     struct CommentConfig;
@@ -257,6 +307,25 @@ namespace pomeloc
         const std::string &path,
         const std::string &file_name);
 
+    // Generate C++ structs with inline pomelo-protobuf codecs.
+    // See idl_gen_cpp.cpp.
+    extern bool GenerateCpp(const Parser &parser,
+        const std::string &path,
+        const std::string &file_name);
+
+    // Generate a precompiled .pbfs schema of the merged routes.
+    // See binary_schema.cpp.
+    extern bool GenerateBinarySchema(const Parser &parser,
+        const std::string &path,
+        const std::string &file_name);
+
+    // Generate the pomelo dictionary.json listing the pushes, so the server
+    // assigns the codes of AssignRouteIds().
+    // See idl_gen_dictionary.cpp.
+    extern bool GenerateRouteDictionary(const Parser &parser,
+        const std::string &path,
+        const std::string &file_name);
+
     // Generate Java/C#/.. files from the definitions in the Parser object.
     // See idl_gen_general.cpp.
     extern bool GenerateGeneral(const Parser &parser,
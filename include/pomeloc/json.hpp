@@ -810,8 +810,8 @@ class basic_json
     value
     @since version 1.0.0
     */
-    basic_json(const value_t value_type)
-        : m_type(value_type), m_value(value_type)
+    basic_json(const value_t v)
+        : m_type(v), m_value(v)
     {}
 
     /*!
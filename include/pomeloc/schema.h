@@ -0,0 +1,158 @@
+#ifndef POMELOC_SCHEMA_H_
+#define POMELOC_SCHEMA_H_
+
+#include <string>
+
+#include "pomeloc/idl.h"
+
+// Flattened, read-only view of a parsed schema.
+// Messages, fields and routes live in three contiguous arrays and every
+// identifier is interned once into a shared string pool, all carved out of
+// a single arena. Consumers walk index ranges instead of the nested maps of
+// the parser IR.
+
+namespace pomeloc
+{
+    // Bump allocator handing out memory from large blocks obtained through a
+    // simple_allocator. Everything is released at once when the arena dies,
+    // so only trivially destructible types may live in it.
+    class Arena
+    {
+    public:
+        explicit Arena(size_t block_size = 4096,
+            const simple_allocator* allocator = nullptr);
+        ~Arena();
+
+        void* Allocate(size_t size, size_t align);
+
+        template<typename T> T* AllocateArray(size_t count)
+        {
+            return static_cast<T*>(Allocate(sizeof(T) * count, AlignOf<T>()));
+        }
+
+        // Returns every block to the allocator.
+        void Reset();
+
+        size_t used() const { return used_; }
+        size_t reserved() const { return reserved_; }
+
+    private:
+        struct Block
+        {
+            Block* next_;
+        };
+
+        Arena(const Arena&);
+        Arena& operator=(const Arena&);
+
+        simple_allocator default_allocator_;
+        const simple_allocator& allocator_;
+        size_t block_size_;
+        Block* head_;
+        uint8_t* cur_;
+        uint8_t* end_;
+        size_t used_;
+        size_t reserved_;
+    };
+
+    struct FlatField
+    {
+        int32_t index_;
+        MetaTypeOpt opt_;
+        kType type_;
+        int32_t message_;       // message of a kMessage field, -1 otherwise
+        uint32_t name_;         // string pool offset
+    };
+
+    struct FlatMessage
+    {
+        uint32_t name_;         // string pool offset
+        int32_t parent_;        // enclosing message, -1 for a route message
+        uint32_t fields_begin_; // fields ordered by index_
+        uint32_t fields_size_;
+        uint32_t nested_begin_; // nested messages are stored adjacently
+        uint32_t nested_size_;
+    };
+
+    // Lets range-for walk the fields of one message.
+    struct FlatFieldRange
+    {
+        const FlatField* begin_;
+        const FlatField* end_;
+
+        const FlatField* begin() const { return begin_; }
+        const FlatField* end() const { return end_; }
+    };
+
+    struct FlatRoute
+    {
+        uint32_t router_;       // string pool offsets
+        uint32_t ns_;
+        uint32_t class_;
+        uint32_t method_;
+        int32_t request_;       // message sent on the route
+        int32_t response_;      // -1 for notifies and pushes
+        bool is_event_;
+        bool is_push_;          // a server push rather than a client route
+    };
+
+    class FlatSchema
+    {
+    public:
+        explicit FlatSchema(const simple_allocator* allocator = nullptr);
+
+        // Flattens the routes, server pushes and responses of a parser.
+        // Routes are kept sorted by name.
+        bool Build(const Parser& parser);
+
+        size_t messages_size() const { return messages_size_; }
+        size_t fields_size() const { return fields_size_; }
+        size_t routes_size() const { return routes_size_; }
+        size_t pool_size() const { return pool_size_; }
+        size_t arena_bytes() const { return arena_.used(); }
+
+        const FlatMessage& message(int32_t id) const { return messages_[id]; }
+        const FlatRoute& route(size_t i) const { return routes_[i]; }
+        FlatFieldRange fields(const FlatMessage& msg) const
+        {
+            FlatFieldRange range = {
+                fields_ + msg.fields_begin_,
+                fields_ + msg.fields_begin_ + msg.fields_size_
+            };
+            return range;
+        }
+
+        // Interned identifiers are NUL terminated.
+        const char* str(uint32_t offset) const { return pool_ + offset; }
+
+        // Index into the route table, -1 if unknown.
+        int32_t LookupRoute(const std::string& router) const;
+
+    private:
+        void Clear();
+        bool Error(const std::string& msg);
+        uint32_t Intern(const std::string& s);
+        int32_t AddMessage(const std::string& name, const MetaStruct& ms,
+            int32_t parent);
+        bool FillMessage(int32_t id, const MetaStruct& ms);
+        bool AddRoute(const RootStruct& rs, int32_t response, bool is_push);
+
+        Arena arena_;
+        FlatMessage* messages_;
+        FlatField* fields_;
+        FlatRoute* routes_;
+        char* pool_;
+        uint32_t* intern_;      // open addressing, pool offset + 1, 0 is empty
+        size_t messages_size_;
+        size_t fields_size_;
+        size_t routes_size_;
+        size_t pool_size_;
+        size_t intern_mask_;
+
+    public:
+        std::string error_;     // User readable error_ if Build() returned false
+    };
+
+}  // namespace pomeloc
+
+#endif  // POMELOC_SCHEMA_H_
@@ -0,0 +1,130 @@
+#ifndef POMELOC_STATS_H_
+#define POMELOC_STATS_H_
+
+#include <chrono>
+#include <cstdint>
+
+// Per-phase wall time and byte counters for --stats.
+// Phases nest: entering a phase pauses the enclosing one, so every
+// millisecond is charged to exactly one phase.
+
+namespace pomeloc
+{
+    enum Phase
+    {
+        kPhaseLoad = 0,     // reading / mapping the input files
+        kPhaseParse,        // tokenizing the json straight into the IR
+        kPhaseMerge,        // moving server responses and pushes into the client IR
+        kPhaseEmit,         // writing the generated source text
+        kPhaseSave,         // comparing and writing output files
+        kPhaseMAX
+    };
+
+    const char* const kPhaseNames[] = {
+        "load",
+        "parse",
+        "merge",
+        "emit",
+        "save",
+    };
+
+    struct PhaseStats
+    {
+        double seconds_;
+        uint64_t calls_;
+        uint64_t bytes_;
+    };
+
+    class Stats
+    {
+    public:
+        Stats()
+            : current_(kPhaseMAX), mark_(Now()), start_(mark_), stop_(0)
+        {
+            for (int i = 0; i < kPhaseMAX; ++i)
+            {
+                phases_[i].seconds_ = 0;
+                phases_[i].calls_ = 0;
+                phases_[i].bytes_ = 0;
+            }
+        }
+
+        // Returns the phase to hand back to Leave().
+        Phase Enter(Phase phase)
+        {
+            Charge();
+            Phase prev = current_;
+            current_ = phase;
+            ++phases_[phase].calls_;
+            return prev;
+        }
+
+        void Leave(Phase prev)
+        {
+            Charge();
+            current_ = prev;
+        }
+
+        void AddBytes(Phase phase, uint64_t bytes) { phases_[phase].bytes_ += bytes; }
+
+        const PhaseStats& phase(Phase which) const { return phases_[which]; }
+        // Freezes total_seconds(), e.g. when a batch project is done.
+        void Stop() { stop_ = Now(); }
+        double total_seconds() const { return (stop_ ? stop_ : Now()) - start_; }
+
+    private:
+        static double Now()
+        {
+            return std::chrono::duration<double>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        void Charge()
+        {
+            double now = Now();
+            if (current_ != kPhaseMAX)
+            {
+                phases_[current_].seconds_ += now - mark_;
+            }
+            mark_ = now;
+        }
+
+        PhaseStats phases_[kPhaseMAX];
+        Phase current_;
+        double mark_;
+        double start_;
+        double stop_;
+    };
+
+    // Charges the enclosing scope to a phase, does nothing without stats.
+    class ScopedPhase
+    {
+    public:
+        ScopedPhase(Stats* stats, Phase phase)
+            : stats_(stats), phase_(phase), prev_(kPhaseMAX)
+        {
+            if (stats_) prev_ = stats_->Enter(phase_);
+        }
+
+        ~ScopedPhase()
+        {
+            if (stats_) stats_->Leave(prev_);
+        }
+
+        void AddBytes(uint64_t bytes)
+        {
+            if (stats_) stats_->AddBytes(phase_, bytes);
+        }
+
+    private:
+        ScopedPhase(const ScopedPhase&);
+        ScopedPhase& operator=(const ScopedPhase&);
+
+        Stats* stats_;
+        Phase phase_;
+        Phase prev_;
+    };
+
+}  // namespace pomeloc
+
+#endif  // POMELOC_STATS_H_
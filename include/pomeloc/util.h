@@ -17,12 +17,17 @@
 #ifndef FLATBUFFERS_UTIL_H_
 #define FLATBUFFERS_UTIL_H_
 
+#include <atomic>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <vector>
 #include <stdlib.h>
 #include <assert.h>
+#include <algorithm>
 #ifdef _WIN32
 #ifndef WIN32_LEAN_AND_MEAN
   #define WIN32_LEAN_AND_MEAN
@@ -33,9 +38,16 @@
 #include <windows.h>
 #include <winbase.h>
 #include <direct.h>
+#include <psapi.h>
 #else
+#include <sys/resource.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <limits.h>
+#include <dirent.h>
+#include <glob.h>
 #endif
 
 #include "pomeloc/pomeloc.h"
@@ -47,32 +59,27 @@ namespace pomeloc {
         size_t sz;
     };
 
-    static int32_t strslice(const char *s, size_t sz, std::vector<sslice>& result, const char * delim)
+    // Splits s into the words separated by runs of delim, storing at most
+    // max of them in words. Returns the number of words, max + 1 if there
+    // are more. Nothing is allocated, the words point into s.
+    inline size_t SplitWords(const char *s, size_t sz, char delim, sslice *words,
+                             size_t max)
     {
-        int32_t i = 0;
-        if (sz == 0)
-            sz = strlen(s);
-        while (sz > 0) {
-            size_t j;
-            if (strchr(delim, *s)) {
+        const char *end = s + sz;
+        size_t n = 0;
+        while (s < end) {
+            if (*s == delim) {
                 ++s;
-                --sz;
                 continue;
             }
-            sslice slice = { 0 };
-            slice.ptr = s++;
-            --sz;
-            for (j = 0; j < sz; j++, s++) {
-                if (strchr(delim, *s)) {
-                    break;
-                }
-            }
-            slice.sz = j + 1;
-            result.push_back(slice);
-            sz -= j;
-            ++i;
+            if (n == max) return max + 1;
+            const char *start = s;
+            while (s < end && *s != delim) ++s;
+            words[n].ptr = start;
+            words[n].sz = s - start;
+            ++n;
         }
-        return i;
+        return n;
     }
 
 // Convert an integer or floating point value to a string.
@@ -149,6 +156,76 @@ inline bool FileExists(const char *name) {
   return ifs.good();
 }
 
+// Check if "name" is a directory.
+inline bool DirExists(const char *name) {
+  #ifdef _WIN32
+    DWORD attrs = GetFileAttributesA(name);
+    return attrs != INVALID_FILE_ATTRIBUTES &&
+           (attrs & FILE_ATTRIBUTE_DIRECTORY);
+  #else
+    struct stat st;
+    return stat(name, &st) == 0 && S_ISDIR(st.st_mode);
+  #endif
+}
+
+// Expands "path" into the files it names, appended to "files": the path
+// itself if it is neither a directory nor a wildcard pattern, else every
+// .json file of the directory or every match of the pattern (wildcards only
+// in the last component on Windows), sorted. Returns false if a directory
+// or pattern matched nothing.
+inline bool ExpandInputPath(const std::string &path,
+                            std::vector<std::string> *files) {
+  std::vector<std::string> found;
+  bool is_dir = DirExists(path.c_str());
+  bool is_pattern = path.find_first_of("*?[") != std::string::npos;
+  if (!is_dir && !is_pattern) {
+    files->push_back(path);
+    return true;
+  }
+  #ifdef _WIN32
+    std::string dir = is_dir ? path : path.substr(0,
+        path.find_last_of("\\/") == std::string::npos
+            ? 0 : path.find_last_of("\\/") + 1);
+    std::string pattern = is_dir ? path + "\\*.json" : path;
+    if (is_dir) dir += "\\";
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA(pattern.c_str(), &data);
+    if (find != INVALID_HANDLE_VALUE) {
+      do {
+        if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+          found.push_back(dir + data.cFileName);
+      } while (FindNextFileA(find, &data));
+      FindClose(find);
+    }
+  #else
+    if (is_dir) {
+      DIR *dir = opendir(path.c_str());
+      if (!dir) return false;
+      while (struct dirent *ent = readdir(dir)) {
+        std::string name = ent->d_name;
+        if (name.size() > 5 && name.compare(name.size() - 5, 5, ".json") == 0) {
+          std::string file = path;
+          if (file[file.size() - 1] != '/') file += '/';
+          file += name;
+          if (!DirExists(file.c_str())) found.push_back(file);
+        }
+      }
+      closedir(dir);
+    } else {
+      glob_t g;
+      if (glob(path.c_str(), 0, nullptr, &g) == 0) {
+        for (size_t i = 0; i < g.gl_pathc; i++) {
+          if (!DirExists(g.gl_pathv[i])) found.push_back(g.gl_pathv[i]);
+        }
+      }
+      globfree(&g);
+    }
+  #endif
+  std::sort(found.begin(), found.end());
+  files->insert(files->end(), found.begin(), found.end());
+  return !found.empty();
+}
+
 // Load file "name" into "buf" returning true if successful
 // false otherwise.  If "binary" is false data is read
 // using ifstream's text mode, otherwise data is read with
@@ -171,6 +248,73 @@ inline bool LoadFile(const char *name, bool binary, std::string *buf) {
   return !ifs.bad();
 }
 
+// Read-only view of a whole file, mapped into memory where the platform
+// supports it. The data is not zero terminated.
+class MappedFile {
+ public:
+  MappedFile() : data_(nullptr), size_(0), mapped_(false) {}
+  ~MappedFile() { Close(); }
+
+  bool Open(const char *name) {
+    Close();
+    #ifdef _WIN32
+      // No mapping on Windows, fall back to reading the file.
+      if (!LoadFile(name, true, &buf_)) return false;
+      data_ = buf_.c_str();
+      size_ = buf_.size();
+      return true;
+    #else
+      int fd = open(name, O_RDONLY);
+      if (fd < 0) return false;
+      struct stat st;
+      if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+      }
+      size_ = static_cast<size_t>(st.st_size);
+      if (!size_) {
+        close(fd);
+        data_ = "";
+        return true;
+      }
+      void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (p == MAP_FAILED) {
+        size_ = 0;
+        if (!LoadFile(name, true, &buf_)) return false;
+        data_ = buf_.c_str();
+        size_ = buf_.size();
+        return true;
+      }
+      data_ = static_cast<const char *>(p);
+      mapped_ = true;
+      return true;
+    #endif
+  }
+
+  void Close() {
+    #ifndef _WIN32
+      if (mapped_) munmap(const_cast<char *>(data_), size_);
+    #endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    buf_.clear();
+  }
+
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile(const MappedFile &);
+  MappedFile &operator=(const MappedFile &);
+
+  const char *data_;
+  size_t size_;
+  bool mapped_;
+  std::string buf_;
+};
+
 // Save data "buf" of length "len" bytes into a file
 // "name" returning true if successful, false otherwise.
 // If "binary" is false data is written using ifstream's
@@ -192,6 +336,79 @@ inline bool SaveFile(const char *name, const std::string &buf, bool binary) {
   return SaveFile(name, buf.c_str(), buf.size(), binary);
 }
 
+// Save data "buf" into file "name" only if the file does not already hold
+// exactly these bytes, so unchanged outputs keep their modification time.
+// "written" (optional) tells whether the file was rewritten.
+inline bool SaveFileIfChanged(const char *name, const std::string &buf,
+                              bool binary, bool *written = nullptr) {
+  std::string existing;
+  if (FileExists(name) && LoadFile(name, binary, &existing) &&
+      existing == buf) {
+    if (written) *written = false;
+    return true;
+  }
+  if (written) *written = true;
+  return SaveFile(name, buf, binary);
+}
+
+// 64 bit FNV-1a hash of "len" bytes at "data", chained through "hash".
+inline uint64_t HashFnv1a64(const char *data, size_t len,
+                            uint64_t hash = 0xcbf29ce484222325ULL) {
+  for (size_t i = 0; i < len; i++) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+inline uint64_t HashFnv1a64(const std::string &str,
+                            uint64_t hash = 0xcbf29ce484222325ULL) {
+  return HashFnv1a64(str.c_str(), str.size(), hash);
+}
+
+// Number of worker threads to use when the user did not ask for one.
+inline int DefaultJobs() {
+  unsigned n = std::thread::hardware_concurrency();
+  return n ? static_cast<int>(n) : 1;
+}
+
+// Runs fn(0) .. fn(count - 1) on up to "jobs" threads, the calling thread
+// included, and returns once every call finished. Calls must not depend on
+// each other; results are expected to go into per-index slots.
+inline void ParallelFor(size_t count, int jobs,
+                        const std::function<void(size_t)> &fn) {
+  size_t threads = jobs > 1 ? (std::min)(static_cast<size_t>(jobs), count) : 1;
+  if (threads <= 1) {
+    for (size_t i = 0; i < count; i++) fn(i);
+    return;
+  }
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < count; i = next++) fn(i);
+  };
+  std::vector<std::thread> pool;
+  for (size_t t = 1; t < threads; t++) pool.emplace_back(worker);
+  worker();
+  for (auto &th : pool) th.join();
+}
+
+// Peak resident set size of the process in kilobytes, 0 if unknown.
+inline uint64_t PeakRssKb() {
+  #ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+    return pmc.PeakWorkingSetSize / 1024;
+  #else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage)) return 0;
+    #ifdef __APPLE__
+      return static_cast<uint64_t>(usage.ru_maxrss) / 1024;
+    #else
+      return static_cast<uint64_t>(usage.ru_maxrss);
+    #endif
+  #endif
+}
+
 // Functionality for minimalistic portable path handling:
 
 static const char kPosixPathSeparator = '/';
@@ -0,0 +1,470 @@
+#include <algorithm>
+#include <cstring>
+
+#include "pomeloc/binary_schema.h"
+
+namespace pomeloc {
+
+    // Schema tables nest at most five deep: enum, value, object, field, type.
+    static const size_t kMaxSchemaDepth = 8;
+
+    inline reflection::BaseType MaptoBaseType(kType t)
+    {
+        switch (t)
+        {
+        case kInt32:
+        case ksInt32:
+            return reflection::Int;
+        case kuInt32:
+            return reflection::UInt;
+        case kfloat:
+            return reflection::Float;
+        case kdouble:
+            return reflection::Double;
+        case kstring:
+            return reflection::String;
+        case kMessage:
+            return reflection::Obj;
+        default:
+            return reflection::None;
+        }
+    }
+
+    bool GetFieldType(const reflection::Field& field, kType* type)
+    {
+        const reflection::Type* t = field.type();
+        switch (t->base_type() == reflection::Vector ? t->element() : t->base_type())
+        {
+        case reflection::Int:
+            *type = kInt32;
+            return true;
+        case reflection::UInt:
+            *type = kuInt32;
+            return true;
+        case reflection::Float:
+            *type = kfloat;
+            return true;
+        case reflection::Double:
+            *type = kdouble;
+            return true;
+        case reflection::String:
+            *type = kstring;
+            return true;
+        case reflection::Obj:
+            *type = kMessage;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Full object names: routes and responses first, nested messages always
+    // come after their parent in id order.
+    static void ObjectNames(const FlatSchema& schema, std::vector<std::string>* names)
+    {
+        names->assign(schema.messages_size(), std::string());
+        for (size_t i = 0; i < schema.routes_size(); ++i)
+        {
+            const FlatRoute& route = schema.route(i);
+            (*names)[route.request_] = schema.str(route.router_);
+            if (route.response_ >= 0)
+            {
+                (*names)[route.response_] = std::string(schema.str(route.router_)) + ":response";
+            }
+        }
+        for (size_t id = 0; id < schema.messages_size(); ++id)
+        {
+            const FlatMessage& msg = schema.message(static_cast<int32_t>(id));
+            if (msg.parent_ >= 0)
+            {
+                (*names)[id] = (*names)[msg.parent_] + "/" + schema.str(msg.name_);
+            }
+        }
+    }
+
+    static Offset<reflection::Enum> CreateRouteEnum(FlatBufferBuilder* fbb,
+        const FlatSchema& schema, bool pushes, const std::vector<int32_t>& pos,
+        const std::vector<Offset<reflection::Object>>& objects)
+    {
+        std::vector<Offset<reflection::EnumVal>> values;
+        for (size_t i = 0; i < schema.routes_size(); ++i)
+        {
+            const FlatRoute& route = schema.route(i);
+            if (route.is_push_ != pushes)
+            {
+                continue;
+            }
+            int64_t value = route.response_ >= 0 ? pos[route.response_] : -1;
+            values.push_back(reflection::CreateEnumVal(*fbb, fbb->CreateString(
+                schema.str(route.router_)), value, objects[pos[route.request_]]));
+        }
+        return reflection::CreateEnum(*fbb, fbb->CreateString(pushes ? "pushes" : "routes"),
+            fbb->CreateVector(values), 0, reflection::CreateType(*fbb, reflection::Int));
+    }
+
+    bool BuildBinarySchema(const FlatSchema& schema, FlatBufferBuilder* fbb,
+        std::string* error)
+    {
+        // '/' separates nested messages in the object names.
+        for (size_t id = 0; id < schema.messages_size(); ++id)
+        {
+            const FlatMessage& msg = schema.message(static_cast<int32_t>(id));
+            if (msg.parent_ >= 0 && strchr(schema.str(msg.name_), '/'))
+            {
+                *error = std::string("error: message name ") + schema.str(msg.name_) +
+                    " does not fit a binary schema";
+                return false;
+            }
+        }
+        for (size_t i = 0; i < schema.routes_size(); ++i)
+        {
+            if (strchr(schema.str(schema.route(i).router_), '/'))
+            {
+                *error = std::string("error: route ") + schema.str(schema.route(i).router_) +
+                    " does not fit a binary schema";
+                return false;
+            }
+        }
+        std::vector<std::string> names;
+        ObjectNames(schema, &names);
+        std::vector<int32_t> order(schema.messages_size());
+        for (size_t id = 0; id < order.size(); ++id)
+        {
+            order[id] = static_cast<int32_t>(id);
+        }
+        std::sort(order.begin(), order.end(), [&names](int32_t l, int32_t r) -> bool {
+            return names[l] < names[r];
+        });
+        std::vector<int32_t> pos(order.size());
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            pos[order[i]] = static_cast<int32_t>(i);
+        }
+
+        // Tables are created in key order, so no vector needs sorting
+        // inside the builder.
+        std::vector<Offset<reflection::Object>> objects;
+        std::vector<Offset<reflection::Field>> fields;
+        std::vector<const FlatField*> sorted;
+        objects.reserve(order.size());
+        for (int32_t id : order)
+        {
+            const FlatMessage& msg = schema.message(id);
+            sorted.clear();
+            for (const auto& ff : schema.fields(msg))
+            {
+                sorted.push_back(&ff);
+            }
+            std::sort(sorted.begin(), sorted.end(),
+                [&schema](const FlatField* l, const FlatField* r) -> bool {
+                return strcmp(schema.str(l->name_), schema.str(r->name_)) < 0;
+            });
+            fields.clear();
+            for (const FlatField* field : sorted)
+            {
+                const FlatField& ff = *field;
+                if (ff.index_ <= 0 || ff.index_ > 0xFFFF)
+                {
+                    *error = "error: field index " + NumToString(ff.index_) + " of " +
+                        names[id] + " does not fit a binary schema";
+                    return false;
+                }
+                reflection::BaseType base = MaptoBaseType(ff.type_);
+                int32_t index = ff.message_ >= 0 ? pos[ff.message_] : -1;
+                auto type = ff.opt_ == kRepeated
+                    ? reflection::CreateType(*fbb, reflection::Vector, base, index)
+                    : reflection::CreateType(*fbb, base, reflection::None, index);
+                fields.push_back(reflection::CreateField(*fbb,
+                    fbb->CreateString(schema.str(ff.name_)), type,
+                    static_cast<uint16_t>(ff.index_), 0, 0, 0.0, 0, ff.opt_ == kRequired));
+            }
+            objects.push_back(reflection::CreateObject(*fbb, fbb->CreateString(names[id]),
+                fbb->CreateVector(fields)));
+        }
+
+        std::vector<Offset<reflection::Enum>> enums;
+        enums.push_back(CreateRouteEnum(fbb, schema, true, pos, objects));     // "pushes"
+        enums.push_back(CreateRouteEnum(fbb, schema, false, pos, objects));    // "routes"
+        auto root = reflection::CreateSchema(*fbb, fbb->CreateVector(objects),
+            fbb->CreateVector(enums),
+            fbb->CreateString(kBinarySchemaIdentifier),
+            fbb->CreateString(kBinarySchemaExtension));
+        fbb->Finish(root, kBinarySchemaIdentifier);
+        return true;
+    }
+
+    const reflection::Schema* VerifyBinarySchema(const void* buf, size_t len)
+    {
+        if (len < sizeof(uoffset_t) + 4 || !BufferHasIdentifier(buf, kBinarySchemaIdentifier))
+        {
+            return nullptr;
+        }
+        // Every table takes at least 4 bytes, which bounds the table count.
+        Verifier verifier(static_cast<const uint8_t*>(buf), len, kMaxSchemaDepth, len / 4);
+        if (!reflection::VerifySchemaBuffer(verifier))
+        {
+            return nullptr;
+        }
+        return reflection::GetSchema(buf);
+    }
+
+    int32_t LookupObject(const reflection::Schema& schema, const char* name)
+    {
+        auto objects = schema.objects();
+        size_t lo = 0, hi = objects->size();
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            int cmp = strcmp(objects->Get(static_cast<uoffset_t>(mid))->name()->c_str(), name);
+            if (!cmp)
+            {
+                return static_cast<int32_t>(mid);
+            }
+            if (cmp < 0)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return -1;
+    }
+
+    // The Verifier only checks the buffer layout, references between objects
+    // are checked while the IR is rebuilt.
+    class SchemaLoader
+    {
+    public:
+        SchemaLoader(const reflection::Schema& schema, std::string* error)
+            : objects_(*schema.objects()), error_(error)
+        {
+        }
+
+        bool Error(const std::string& msg)
+        {
+            *error_ = "error: " + msg;
+            return false;
+        }
+
+        const reflection::Object* Get(int64_t index)
+        {
+            if (index < 0 || index >= static_cast<int64_t>(objects_.size()))
+            {
+                return nullptr;
+            }
+            return objects_.Get(static_cast<uoffset_t>(index));
+        }
+
+        // Nested messages are the objects named "<name>/<child>", which sort
+        // right after "<name>/".
+        bool LoadMessage(const reflection::Object& object, MetaStruct* ms)
+        {
+            std::string prefix = object.name()->str() + "/";
+            size_t slash = object.name()->str().rfind('/');
+            ms->name_ = slash == std::string::npos ? object.name()->str()
+                : object.name()->str().substr(slash + 1);
+
+            auto fields = object.fields();
+            ms->vars_.resize(fields->size());
+            for (uoffset_t i = 0; i < fields->size(); ++i)
+            {
+                const reflection::Field* field = fields->Get(i);
+                MetaVariable& mv = ms->vars_[i];
+                mv.index_ = field->id();
+                mv.opt_ = field->type()->base_type() == reflection::Vector ? kRepeated
+                    : field->required() ? kRequired : kOptional;
+                mv.name_ = field->name()->str();
+                if (!GetFieldType(*field, &mv.type_))
+                {
+                    return Error("field " + mv.name_ + " of " + object.name()->str() +
+                        " has an unknown type");
+                }
+                if (mv.type_ == kMessage)
+                {
+                    const reflection::Object* target = Get(field->type()->index());
+                    const std::string target_name = target ? target->name()->str() : "";
+                    if (target_name.size() <= prefix.size() ||
+                        target_name.compare(0, prefix.size(), prefix) ||
+                        target_name.find('/', prefix.size()) != std::string::npos)
+                    {
+                        return Error("field " + mv.name_ + " of " + object.name()->str() +
+                            " refers to no nested message");
+                    }
+                    mv.typename_ = target_name.substr(prefix.size());
+                }
+            }
+            std::sort(ms->vars_.begin(), ms->vars_.end(),
+                [](const MetaVariable& l, const MetaVariable& r) -> bool {
+                return l.index_ < r.index_;
+            });
+            for (size_t i = 1; i < ms->vars_.size(); ++i)
+            {
+                if (ms->vars_[i - 1].index_ == ms->vars_[i].index_)
+                {
+                    return Error("duplicate field index in " + object.name()->str());
+                }
+            }
+
+            int32_t i = LookupFirst(prefix);
+            for (; i < static_cast<int32_t>(objects_.size()); ++i)
+            {
+                const reflection::Object* child = objects_.Get(i);
+                const std::string& name = child->name()->str();
+                if (name.compare(0, prefix.size(), prefix))
+                {
+                    break;
+                }
+                if (name.find('/', prefix.size()) != std::string::npos)
+                {
+                    continue;
+                }
+                MetaStruct& nested = ms->structs_[name.substr(prefix.size())];
+                if (!LoadMessage(*child, &nested))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool LoadRoute(const reflection::EnumVal& value, RootStruct* rs)
+        {
+            if (!value.object())
+            {
+                return Error("route " + value.name()->str() + " has no message");
+            }
+            if (!LoadMessage(*value.object(), rs))
+            {
+                return false;
+            }
+            // Same split as Parser::ParseRoot.
+            rs->router_ = value.name()->str();
+            sslice words[3];
+            if (SplitWords(rs->router_.c_str(), rs->router_.size(), '.', words, 3) == 3)
+            {
+                rs->ns_.assign(words[0].ptr, words[0].sz);
+                rs->class_.assign(words[1].ptr, words[1].sz);
+                rs->method_.assign(words[2].ptr, words[2].sz);
+            }
+            else
+            {
+                rs->method_ = rs->router_;
+                rs->is_event_ = true;
+            }
+            rs->name_ = rs->method_;
+            return true;
+        }
+
+    private:
+        // First object not less than name.
+        int32_t LookupFirst(const std::string& name)
+        {
+            size_t lo = 0, hi = objects_.size();
+            while (lo < hi)
+            {
+                size_t mid = lo + (hi - lo) / 2;
+                if (objects_.Get(static_cast<uoffset_t>(mid))->name()->str() < name)
+                {
+                    lo = mid + 1;
+                }
+                else
+                {
+                    hi = mid;
+                }
+            }
+            return static_cast<int32_t>(lo);
+        }
+
+        const Vector<Offset<reflection::Object>>& objects_;
+        std::string* error_;
+    };
+
+    bool LoadBinarySchema(const reflection::Schema& schema, Parser* parser,
+        std::string* error)
+    {
+        const reflection::Enum* routes = schema.enums()->LookupByKey("routes");
+        const reflection::Enum* pushes = schema.enums()->LookupByKey("pushes");
+        if (!routes || !pushes)
+        {
+            *error = "error: binary schema has no route table";
+            return false;
+        }
+        SchemaLoader loader(schema, error);
+        parser->structs_.resize(routes->values()->size());
+        for (uoffset_t i = 0; i < routes->values()->size(); ++i)
+        {
+            const reflection::EnumVal* value = routes->values()->Get(i);
+            RootStruct& rs = parser->structs_[i];
+            if (!loader.LoadRoute(*value, &rs))
+            {
+                return false;
+            }
+            if (value->value() < 0)
+            {
+                continue;
+            }
+            const reflection::Object* response = loader.Get(value->value());
+            if (!response)
+            {
+                return loader.Error("route " + rs.router_ + " has an unknown response");
+            }
+            MetaStruct& ms = parser->response_maps_[rs.router_];
+            if (!loader.LoadMessage(*response, &ms))
+            {
+                return false;
+            }
+            ms.name_ = rs.method_ + "_result";
+        }
+        parser->event_structs_.resize(pushes->values()->size());
+        for (uoffset_t i = 0; i < pushes->values()->size(); ++i)
+        {
+            RootStruct& rs = parser->event_structs_[i];
+            if (!loader.LoadRoute(*pushes->values()->Get(i), &rs))
+            {
+                return false;
+            }
+            rs.is_event_ = true;
+        }
+        return true;
+    }
+
+    bool BinarySchemaFile::Open(const std::string& path)
+    {
+        schema_ = nullptr;
+        error_.clear();
+        if (!file_.Open(path.c_str()))
+        {
+            error_ = "error: unable to load file: " + path;
+            return false;
+        }
+        schema_ = VerifyBinarySchema(file_.data(), file_.size());
+        if (!schema_)
+        {
+            error_ = "error: " + path + " is not a valid binary schema";
+            return false;
+        }
+        return true;
+    }
+
+    bool GenerateBinarySchema(const Parser& parser, const std::string& path,
+        const std::string& file_name)
+    {
+        FlatSchema schema;
+        if (!schema.Build(parser))
+        {
+            return false;
+        }
+        FlatBufferBuilder fbb;
+        std::string error;
+        if (!BuildBinarySchema(schema, &fbb, &error))
+        {
+            return false;
+        }
+        std::string code(reinterpret_cast<const char*>(fbb.GetBufferPointer()), fbb.GetSize());
+        return SaveGeneratedFile(parser, path + file_name + "." + kBinarySchemaExtension,
+            code, true);
+    }
+
+}  // namespace pomeloc
@@ -0,0 +1,698 @@
+#include <algorithm>
+
+#include "pomeloc/codec.h"
+#include "pomeloc/binary_schema.h"
+#include "pomeloc/util.h"
+
+namespace pomeloc {
+
+    // Nested messages deeper than this are rejected while decoding.
+    static const int kMaxDepth = 64;
+
+    // Beyond this index the per-message slot table is not built.
+    static const int32_t kMaxSlotIndex = 1024;
+
+    inline WireType MaptoWireType(kType t)
+    {
+        switch (t)
+        {
+        case kInt32:
+        case kuInt32:
+        case ksInt32:
+            return kWireVarint;
+        case kfloat:
+            return kWireFixed32;
+        case kdouble:
+            return kWireFixed64;
+        default:
+            return kWireLengthDelimited;
+        }
+    }
+
+    inline size_t EncodeVarint(uint32_t v, uint8_t* buf)
+    {
+        size_t n = 0;
+        while (v > 0x7F)
+        {
+            buf[n++] = static_cast<uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+        buf[n++] = static_cast<uint8_t>(v);
+        return n;
+    }
+
+    inline void WriteVarint(uint32_t v, std::string* out)
+    {
+        uint8_t buf[5];
+        size_t n = EncodeVarint(v, buf);
+        out->append(reinterpret_cast<const char*>(buf), n);
+    }
+
+    inline void WriteFixed32(uint32_t v, std::string* out)
+    {
+        char buf[4] = {
+            static_cast<char>(v),
+            static_cast<char>(v >> 8),
+            static_cast<char>(v >> 16),
+            static_cast<char>(v >> 24),
+        };
+        out->append(buf, 4);
+    }
+
+    inline uint32_t ZigZag(int32_t v)
+    {
+        return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+    }
+
+    inline int32_t UnZigZag(uint32_t v)
+    {
+        return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+    }
+
+    // Reads a varint of up to 10 bytes, keeping the low 32 bits.
+    inline bool ReadVarint(const uint8_t*& p, const uint8_t* end, uint32_t* v)
+    {
+        if (p < end && *p < 0x80)
+        {
+            *v = *p++;
+            return true;
+        }
+        uint32_t ret = 0;
+        for (int shift = 0; shift < 70; shift += 7)
+        {
+            if (p >= end)
+            {
+                return false;
+            }
+            uint8_t b = *p++;
+            if (shift < 32)
+            {
+                ret |= static_cast<uint32_t>(b & 0x7F) << shift;
+            }
+            if (!(b & 0x80))
+            {
+                *v = ret;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline uint32_t ReadFixed32(const uint8_t* p)
+    {
+        return static_cast<uint32_t>(p[0]) |
+            (static_cast<uint32_t>(p[1]) << 8) |
+            (static_cast<uint32_t>(p[2]) << 16) |
+            (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    // Builds a json DOM out of the visitor callbacks.
+    class JsonBuilder : public CodecVisitor
+    {
+    public:
+        explicit JsonBuilder(json* root)
+        {
+            *root = json::object();
+            stack_.push_back(root);
+        }
+
+        void OnInt32(const CodecField& field, int32_t val) { Slot(field) = val; }
+        void OnUInt32(const CodecField& field, uint32_t val) { Slot(field) = val; }
+        void OnFloat(const CodecField& field, float val) { Slot(field) = val; }
+        void OnDouble(const CodecField& field, double val) { Slot(field) = val; }
+        void OnString(const CodecField& field, const char* str, size_t len)
+        {
+            Slot(field) = std::string(str, len);
+        }
+        void BeginMessage(const CodecField& field, const CodecMessage&)
+        {
+            json& slot = Slot(field);
+            slot = json::object();
+            stack_.push_back(&slot);
+        }
+        void EndMessage(const CodecField&, const CodecMessage&)
+        {
+            stack_.pop_back();
+        }
+
+    private:
+        json& Slot(const CodecField& field)
+        {
+            json& top = *stack_.back();
+            if (field.opt_ != kRepeated)
+            {
+                return top[field.name_];
+            }
+            json& arr = top[field.name_];
+            if (!arr.is_array())
+            {
+                arr = json::array();
+            }
+            arr.push_back(json());
+            return arr.back();
+        }
+
+        std::vector<json*> stack_;
+    };
+
+    bool Codec::Error(const std::string& msg)
+    {
+        error_ = "error: " + msg;
+        return false;
+    }
+
+    void Codec::Clear()
+    {
+        messages_.clear();
+        for (auto& routes : routes_)
+        {
+            routes.clear();
+        }
+        error_.clear();
+    }
+
+    bool Codec::Load(const Parser& parser)
+    {
+        FlatSchema schema;
+        if (!schema.Build(parser))
+        {
+            Clear();
+            error_ = schema.error_;
+            return false;
+        }
+        return Load(schema);
+    }
+
+    bool Codec::Load(const FlatSchema& schema)
+    {
+        Clear();
+        // Table ids are the schema message ids.
+        messages_.resize(schema.messages_size());
+        for (size_t id = 0; id < schema.messages_size(); ++id)
+        {
+            if (!CompileMessage(schema, static_cast<int32_t>(id)))
+            {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < schema.routes_size(); ++i)
+        {
+            const FlatRoute& route = schema.route(i);
+            std::string name = schema.str(route.router_);
+            routes_[route.is_push_ ? kPush : kRequest][name] = route.request_;
+            if (route.response_ >= 0)
+            {
+                routes_[kResponse][name] = route.response_;
+            }
+        }
+        return true;
+    }
+
+    bool Codec::Load(const reflection::Schema& schema)
+    {
+        Clear();
+        auto objects = schema.objects();
+        messages_.resize(objects->size());
+        for (uoffset_t id = 0; id < objects->size(); ++id)
+        {
+            if (!CompileMessage(schema, static_cast<int32_t>(id)))
+            {
+                return false;
+            }
+        }
+        const char* const tables[] = { "routes", "pushes" };
+        for (const char* table : tables)
+        {
+            const reflection::Enum* routes = schema.enums()->LookupByKey(table);
+            if (!routes)
+            {
+                return Error(std::string("binary schema has no ") + table + " table");
+            }
+            for (auto value : *routes->values())
+            {
+                int32_t id = value->object() ? LookupObject(schema,
+                    value->object()->name()->c_str()) : -1;
+                if (id < 0)
+                {
+                    return Error("route " + value->name()->str() + " has no message");
+                }
+                bool push = table == tables[1];
+                routes_[push ? kPush : kRequest][value->name()->str()] = id;
+                // A route's value is the object of its response, -1 for a
+                // notify.
+                if (!push && value->value() >= 0)
+                {
+                    if (value->value() >= static_cast<int64_t>(objects->size()))
+                    {
+                        return Error("route " + value->name()->str() + " has an unknown response");
+                    }
+                    routes_[kResponse][value->name()->str()] = static_cast<int32_t>(value->value());
+                }
+            }
+        }
+        return true;
+    }
+
+    bool Codec::CompileField(const CodecMessage& msg, CodecField* field)
+    {
+        if (field->index_ <= 0 || field->index_ > (0x1FFFFFFF))
+        {
+            return Error("invalid field index " + NumToString(field->index_) + " in " + msg.name_);
+        }
+        field->wire_ = MaptoWireType(field->type_);
+        field->packed_ = field->opt_ == kRepeated && field->type_ < kstring;
+        field->tag_ = (static_cast<uint32_t>(field->index_) << 3) | field->wire_;
+        field->tag_size_ = static_cast<uint8_t>(EncodeVarint(field->tag_, field->tag_bytes_));
+        return true;
+    }
+
+    // Expects the fields ordered by index_ without duplicates.
+    void Codec::BuildSlots(CodecMessage* msg)
+    {
+        if (!msg->fields_.empty() && msg->fields_.back().index_ < kMaxSlotIndex)
+        {
+            msg->slots_.assign(msg->fields_.back().index_ + 1, -1);
+            for (size_t i = 0; i < msg->fields_.size(); ++i)
+            {
+                msg->slots_[msg->fields_[i].index_] = static_cast<int16_t>(i);
+            }
+        }
+    }
+
+    bool Codec::CompileMessage(const FlatSchema& schema, int32_t id)
+    {
+        const FlatMessage& flat = schema.message(id);
+        CodecMessage& msg = messages_[id];
+        msg.name_ = schema.str(flat.name_);
+        msg.fields_.reserve(flat.fields_size_);
+        for (const auto& ff : schema.fields(flat))
+        {
+            CodecField field;
+            field.index_ = ff.index_;
+            field.opt_ = ff.opt_;
+            field.type_ = ff.type_;
+            field.message_ = ff.message_;
+            field.name_ = schema.str(ff.name_);
+            if (!CompileField(msg, &field))
+            {
+                return false;
+            }
+            msg.fields_.push_back(field);
+        }
+
+        // The parser keeps fields ordered by index and rejects duplicates.
+        BuildSlots(&msg);
+        return true;
+    }
+
+    bool Codec::CompileMessage(const reflection::Schema& schema, int32_t id)
+    {
+        auto objects = schema.objects();
+        const reflection::Object* object = objects->Get(id);
+        CodecMessage& msg = messages_[id];
+        msg.name_ = object->name()->str();
+        msg.fields_.reserve(object->fields()->size());
+        for (auto ff : *object->fields())
+        {
+            CodecField field;
+            field.index_ = ff->id();
+            field.opt_ = ff->type()->base_type() == reflection::Vector ? kRepeated
+                : ff->required() ? kRequired : kOptional;
+            field.message_ = -1;
+            field.name_ = ff->name()->str();
+            if (!GetFieldType(*ff, &field.type_))
+            {
+                return Error("field " + field.name_ + " in " + msg.name_ + " has an unknown type");
+            }
+            if (field.type_ == kMessage)
+            {
+                field.message_ = ff->type()->index();
+                if (field.message_ < 0 || static_cast<uoffset_t>(field.message_) >= objects->size())
+                {
+                    return Error("field " + field.name_ + " in " + msg.name_ +
+                        " refers to an unknown message");
+                }
+            }
+            if (!CompileField(msg, &field))
+            {
+                return false;
+            }
+            msg.fields_.push_back(field);
+        }
+
+        // Binary schema fields are sorted by name.
+        std::sort(msg.fields_.begin(), msg.fields_.end(),
+            [](const CodecField& l, const CodecField& r) -> bool {
+            return l.index_ < r.index_;
+        });
+        for (size_t i = 1; i < msg.fields_.size(); ++i)
+        {
+            if (msg.fields_[i - 1].index_ == msg.fields_[i].index_)
+            {
+                return Error("duplicate field index " + NumToString(msg.fields_[i].index_) +
+                    " in " + msg.name_);
+            }
+        }
+        BuildSlots(&msg);
+        return true;
+    }
+
+    int32_t Codec::LookupRoute(const std::string& route, RouteDirection dir) const
+    {
+        auto it = routes_[dir].find(route);
+        return it != routes_[dir].end() ? it->second : -1;
+    }
+
+    static const char* DirectionName(RouteDirection dir)
+    {
+        switch (dir)
+        {
+        case kRequest:
+            return "request";
+        case kResponse:
+            return "response";
+        default:
+            return "push";
+        }
+    }
+
+    const CodecField* Codec::LookupField(const CodecMessage& msg, int32_t index) const
+    {
+        if (!msg.slots_.empty() || msg.fields_.empty())
+        {
+            if (index < 0 || static_cast<size_t>(index) >= msg.slots_.size())
+            {
+                return nullptr;
+            }
+            int16_t slot = msg.slots_[index];
+            return slot >= 0 ? &msg.fields_[slot] : nullptr;
+        }
+        auto it = std::lower_bound(msg.fields_.begin(), msg.fields_.end(), index,
+            [](const CodecField& l, int32_t r) -> bool {
+            return l.index_ < r;
+        });
+        return it != msg.fields_.end() && it->index_ == index ? &*it : nullptr;
+    }
+
+    bool Codec::Encode(const std::string& route, RouteDirection dir, const json& msg,
+        std::string* out)
+    {
+        int32_t id = LookupRoute(route, dir);
+        if (id < 0)
+        {
+            return Error(std::string("no ") + DirectionName(dir) + " on route " + route);
+        }
+        return Encode(id, msg, out);
+    }
+
+    bool Codec::Encode(int32_t id, const json& msg, std::string* out)
+    {
+        out->clear();
+        return EncodeMessage(id, msg, out);
+    }
+
+    bool Codec::EncodeMessage(int32_t id, const json& msg, std::string* out)
+    {
+        const CodecMessage& cm = messages_[id];
+        if (!msg.is_object())
+        {
+            return Error("message " + cm.name_ + " must be an object");
+        }
+        for (const auto& field : cm.fields_)
+        {
+            auto it = msg.find(field.name_);
+            if (it == msg.end() || it->is_null())
+            {
+                if (field.opt_ == kRequired)
+                {
+                    return Error("missing required field " + field.name_ + " in " + cm.name_);
+                }
+                continue;
+            }
+            const char* tag = reinterpret_cast<const char*>(field.tag_bytes_);
+            if (field.opt_ != kRepeated)
+            {
+                out->append(tag, field.tag_size_);
+                if (!EncodeValue(field, *it, out))
+                {
+                    return false;
+                }
+                continue;
+            }
+            if (!it->is_array())
+            {
+                return Error("repeated field " + field.name_ + " must be an array");
+            }
+            if (it->empty())
+            {
+                continue;
+            }
+            if (field.packed_)
+            {
+                out->append(tag, field.tag_size_);
+                WriteVarint(static_cast<uint32_t>(it->size()), out);
+            }
+            for (const auto& elem : *it)
+            {
+                if (!field.packed_)
+                {
+                    out->append(tag, field.tag_size_);
+                }
+                if (!EncodeValue(field, elem, out))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool Codec::EncodeValue(const CodecField& field, const json& val, std::string* out)
+    {
+        if (field.type_ == kstring)
+        {
+            if (!val.is_string())
+            {
+                return Error("field " + field.name_ + " must be a string");
+            }
+            const std::string& str = val.get_ref<const std::string&>();
+            WriteVarint(static_cast<uint32_t>(str.size()), out);
+            out->append(str);
+            return true;
+        }
+        if (field.type_ == kMessage)
+        {
+            // Encode in place, then insert the length prefix in front.
+            size_t start = out->size();
+            if (!EncodeMessage(field.message_, val, out))
+            {
+                return false;
+            }
+            uint8_t buf[5];
+            size_t n = EncodeVarint(static_cast<uint32_t>(out->size() - start), buf);
+            out->insert(start, reinterpret_cast<const char*>(buf), n);
+            return true;
+        }
+        if (!val.is_number())
+        {
+            return Error("field " + field.name_ + " must be a number");
+        }
+        switch (field.type_)
+        {
+        case kInt32:
+        case ksInt32:
+            WriteVarint(ZigZag(static_cast<int32_t>(val.get<int64_t>())), out);
+            break;
+        case kuInt32:
+            WriteVarint(static_cast<uint32_t>(val.get<int64_t>()), out);
+            break;
+        case kfloat:
+        {
+            float f = val.get<float>();
+            uint32_t u;
+            memcpy(&u, &f, sizeof(u));
+            WriteFixed32(u, out);
+        }
+        break;
+        case kdouble:
+        {
+            double d = val.get<double>();
+            uint64_t u;
+            memcpy(&u, &d, sizeof(u));
+            WriteFixed32(static_cast<uint32_t>(u), out);
+            WriteFixed32(static_cast<uint32_t>(u >> 32), out);
+        }
+        break;
+        default:
+            return Error("field " + field.name_ + " has no scalar type");
+        }
+        return true;
+    }
+
+    bool Codec::Decode(const std::string& route, RouteDirection dir, const uint8_t* buf,
+        size_t len, json* out)
+    {
+        int32_t id = LookupRoute(route, dir);
+        if (id < 0)
+        {
+            return Error(std::string("no ") + DirectionName(dir) + " on route " + route);
+        }
+        return Decode(id, buf, len, out);
+    }
+
+    bool Codec::Decode(int32_t id, const uint8_t* buf, size_t len, json* out)
+    {
+        JsonBuilder builder(out);
+        return DecodeMessage(id, buf, buf + len, &builder, 0);
+    }
+
+    bool Codec::Decode(const std::string& route, RouteDirection dir, const uint8_t* buf,
+        size_t len, CodecVisitor* visitor)
+    {
+        int32_t id = LookupRoute(route, dir);
+        if (id < 0)
+        {
+            return Error(std::string("no ") + DirectionName(dir) + " on route " + route);
+        }
+        return Decode(id, buf, len, visitor);
+    }
+
+    bool Codec::Decode(int32_t id, const uint8_t* buf, size_t len, CodecVisitor* visitor)
+    {
+        return DecodeMessage(id, buf, buf + len, visitor, 0);
+    }
+
+    bool Codec::DecodeMessage(int32_t id, const uint8_t* p, const uint8_t* end,
+        CodecVisitor* visitor, int depth)
+    {
+        if (depth > kMaxDepth)
+        {
+            return Error("message nesting too deep");
+        }
+        const CodecMessage& cm = messages_[id];
+        while (p < end)
+        {
+            uint32_t tag;
+            if (!ReadVarint(p, end, &tag))
+            {
+                return Error("truncated tag in " + cm.name_);
+            }
+            WireType wire = static_cast<WireType>(tag & 7);
+            const CodecField* field = LookupField(cm, static_cast<int32_t>(tag >> 3));
+            if (!field || field->wire_ != wire)
+            {
+                // Unknown or mismatched field, skip it by wire type.
+                uint32_t skip = 0;
+                switch (wire)
+                {
+                case kWireVarint:
+                    if (!ReadVarint(p, end, &skip))
+                    {
+                        return Error("truncated varint in " + cm.name_);
+                    }
+                    skip = 0;
+                    break;
+                case kWireFixed64:
+                    skip = 8;
+                    break;
+                case kWireFixed32:
+                    skip = 4;
+                    break;
+                case kWireLengthDelimited:
+                    if (!ReadVarint(p, end, &skip))
+                    {
+                        return Error("truncated length in " + cm.name_);
+                    }
+                    break;
+                default:
+                    return Error("unknown wire type in " + cm.name_);
+                }
+                if (skip > static_cast<size_t>(end - p))
+                {
+                    return Error("truncated field in " + cm.name_);
+                }
+                p += skip;
+                continue;
+            }
+
+            uint32_t count = 1;
+            if (field->packed_ && !ReadVarint(p, end, &count))
+            {
+                return Error("truncated count of " + field->name_);
+            }
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                uint32_t v = 0;
+                switch (wire)
+                {
+                case kWireVarint:
+                    if (!ReadVarint(p, end, &v))
+                    {
+                        return Error("truncated varint of " + field->name_);
+                    }
+                    if (field->type_ == kuInt32)
+                    {
+                        visitor->OnUInt32(*field, v);
+                    }
+                    else
+                    {
+                        visitor->OnInt32(*field, UnZigZag(v));
+                    }
+                    break;
+                case kWireFixed32:
+                {
+                    if (end - p < 4)
+                    {
+                        return Error("truncated float of " + field->name_);
+                    }
+                    v = ReadFixed32(p);
+                    p += 4;
+                    float f;
+                    memcpy(&f, &v, sizeof(f));
+                    visitor->OnFloat(*field, f);
+                }
+                break;
+                case kWireFixed64:
+                {
+                    if (end - p < 8)
+                    {
+                        return Error("truncated double of " + field->name_);
+                    }
+                    uint64_t u = ReadFixed32(p) |
+                        (static_cast<uint64_t>(ReadFixed32(p + 4)) << 32);
+                    p += 8;
+                    double d;
+                    memcpy(&d, &u, sizeof(d));
+                    visitor->OnDouble(*field, d);
+                }
+                break;
+                default:
+                {
+                    if (!ReadVarint(p, end, &v) || v > static_cast<size_t>(end - p))
+                    {
+                        return Error("truncated value of " + field->name_);
+                    }
+                    if (field->type_ == kstring)
+                    {
+                        visitor->OnString(*field, reinterpret_cast<const char*>(p), v);
+                    }
+                    else
+                    {
+                        const CodecMessage& child = messages_[field->message_];
+                        visitor->BeginMessage(*field, child);
+                        if (!DecodeMessage(field->message_, p, p + v, visitor, depth + 1))
+                        {
+                            return false;
+                        }
+                        visitor->EndMessage(*field, child);
+                    }
+                    p += v;
+                }
+                break;
+                }
+            }
+        }
+        return true;
+    }
+
+}  // namespace pomeloc
@@ -0,0 +1,159 @@
+#include <algorithm>
+
+#include "pomeloc/compiler.h"
+
+namespace pomeloc {
+
+    bool MergeFragments(std::vector<std::vector<RootStruct>>& fragments,
+        const std::vector<std::string>& names, std::vector<RootStruct>* routes,
+        std::string* error)
+    {
+        if (fragments.size() == 1 && routes->empty())
+        {
+            // A single file is sorted and checked by the parser already.
+            *routes = std::move(fragments[0]);
+            return true;
+        }
+
+        // (fragment, route) pairs, every fragment is sorted on its own.
+        std::vector<std::pair<size_t, size_t>> order;
+        for (size_t i = 0; i < fragments.size(); ++i)
+        {
+            for (size_t j = 0; j < fragments[i].size(); ++j)
+            {
+                order.push_back(std::make_pair(i, j));
+            }
+        }
+        std::stable_sort(order.begin(), order.end(),
+            [&fragments](const std::pair<size_t, size_t>& l,
+                const std::pair<size_t, size_t>& r) -> bool {
+            return fragments[l.first][l.second].router_ < fragments[r.first][r.second].router_;
+        });
+        for (size_t i = 1; i < order.size(); ++i)
+        {
+            const RootStruct& prev = fragments[order[i - 1].first][order[i - 1].second];
+            const RootStruct& cur = fragments[order[i].first][order[i].second];
+            if (prev.router_ == cur.router_)
+            {
+                *error = "error: duplicate route " + cur.router_ + " in " +
+                    names[order[i - 1].first] + " and " + names[order[i].first];
+                return false;
+            }
+        }
+
+        routes->reserve(routes->size() + order.size());
+        for (const auto& item : order)
+        {
+            routes->push_back(std::move(fragments[item.first][item.second]));
+        }
+        return true;
+    }
+
+    void MergeServerRoutes(std::vector<RootStruct>& server, Parser* client)
+    {
+        for (auto& item : server)
+        {
+            if (item.is_event_)
+            {
+                client->event_structs_.push_back(std::move(item));
+            }
+            else
+            {
+                MetaStruct& ms = client->response_maps_[item.router_];
+                ms = std::move(static_cast<MetaStruct&>(item));
+                ms.name_ = item.method_ + "_result";
+            }
+        }
+        server.clear();
+    }
+
+    Compiler::Compiler(const IDLOptions& options)
+        : opts(options)
+    {
+    }
+
+    bool Compiler::SetClientProtos(const std::string& name, const char* json, size_t length)
+    {
+        return SetProtos(client_, name, json, length);
+    }
+
+    bool Compiler::SetServerProtos(const std::string& name, const char* json, size_t length)
+    {
+        return SetProtos(server_, name, json, length);
+    }
+
+    bool Compiler::SetProtos(Fragments& side, const std::string& name, const char* json,
+        size_t length)
+    {
+        error_.clear();
+        Parser parser(opts);
+        if (!parser.Parse(json, length, name.c_str()))
+        {
+            error_ = parser.error_;
+            return false;
+        }
+        side[name] = std::move(parser.structs_);
+        return true;
+    }
+
+    void Compiler::RemoveProtos(const std::string& name)
+    {
+        client_.erase(name);
+        server_.erase(name);
+    }
+
+    void Compiler::Clear()
+    {
+        client_.clear();
+        server_.clear();
+        error_.clear();
+    }
+
+    // The fragments stay resident, so every compile merges copies.
+    bool Compiler::MergeSide(const Fragments& side, std::vector<RootStruct>* routes)
+    {
+        std::vector<std::vector<RootStruct>> fragments;
+        std::vector<std::string> names;
+        fragments.reserve(side.size());
+        for (const auto& item : side)
+        {
+            names.push_back(item.first);
+            fragments.push_back(item.second);
+        }
+        return MergeFragments(fragments, names, routes, &error_);
+    }
+
+    bool Compiler::Generate(IDLOptions::Language lang, const std::string& file_name,
+        std::vector<GeneratedFile>* files)
+    {
+        error_.clear();
+        Parser parser(opts);
+        parser.opts.lang = lang;
+        std::vector<RootStruct> server;
+        if (!MergeSide(client_, &parser.structs_) || !MergeSide(server_, &server))
+        {
+            return false;
+        }
+        MergeServerRoutes(server, &parser);
+
+        parser.outputs_ = files;
+        bool ok = false;
+        switch (lang)
+        {
+        case IDLOptions::kCSharp:
+            ok = GenerateGeneral(parser, "", file_name);
+            break;
+        case IDLOptions::kCpp:
+            ok = GenerateCpp(parser, "", file_name);
+            break;
+        default:
+            break;
+        }
+        if (!ok)
+        {
+            error_ = "error: unable to generate code for " + file_name;
+        }
+        return ok;
+    }
+
+}  // namespace pomeloc
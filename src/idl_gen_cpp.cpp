@@ -0,0 +1,497 @@
+#include "pomeloc/pomeloc.h"
+#include "pomeloc/idl.h"
+#include "pomeloc/schema.h"
+#include "pomeloc/util.h"
+#include "pomeloc/stats.h"
+#include "pomeloc/code_writer.h"
+
+namespace pomeloc {
+
+const char* const kTypeCpp[] = {
+    "int32_t",
+    "uint32_t",
+    "int32_t",
+    "float",
+    "double",
+    "std::string"
+};
+
+const char* const kTypeCppDefault[] = {
+    " = 0",
+    " = 0",
+    " = 0",
+    " = 0.0f",
+    " = 0.0",
+    "",
+};
+
+// pomelo-protobuf wire types, indexed by kType. Messages are length-delimited.
+const uint32_t kWireTypeCpp[] = {
+    0, // int32
+    0, // uInt32
+    0, // sInt32
+    5, // float
+    1, // double
+    2, // string
+};
+
+inline const char* MaptoCppType(const FlatSchema& schema, const FlatField& mv)
+{
+    if (mv.type_ >= 0 && mv.type_ < kTypeNone)
+    {
+        return kTypeCpp[mv.type_];
+    }
+    return schema.str(schema.message(mv.message_).name_);
+}
+
+inline uint32_t MaptoCppTag(const FlatField& mv)
+{
+    uint32_t wire = mv.type_ >= 0 && mv.type_ < kTypeNone ? kWireTypeCpp[mv.type_] : 2;
+    return (static_cast<uint32_t>(mv.index_) << 3) | wire;
+}
+
+inline std::string CppTagSize(const FlatField& mv)
+{
+    uint32_t tag = MaptoCppTag(mv);
+    uint32_t n = 1;
+    while (tag > 0x7F)
+    {
+        tag >>= 7;
+        ++n;
+    }
+    return NumToString(n);
+}
+
+// pomelo-protobuf packs repeated numeric fields as tag + count + values.
+inline bool IsPackedCpp(const FlatField& mv)
+{
+    return mv.opt_ == kRepeated && mv.type_ >= 0 && mv.type_ < kstring;
+}
+
+// Runtime helpers shared by every generated header.
+static void GenCppRuntime(CodeWriter& code)
+{
+    code += "namespace pomeloc_rt{";
+    code += "struct Writer{uint8_t* p;};";
+    code += "struct Reader{const uint8_t* p;const uint8_t* end;bool ok;};";
+    code += "inline uint32_t VarintSize(uint32_t v){uint32_t n = 1;while(v > 0x7F){v >>= 7;++n;}return n;}";
+    code += "inline uint32_t ZigZag(int32_t v){return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);}";
+    code += "inline int32_t UnZigZag(uint32_t v){return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);}";
+    code += "inline void PutVarint(Writer& w, uint32_t v){while(v > 0x7F){*w.p++ = static_cast<uint8_t>(v | 0x80);v >>= 7;}*w.p++ = static_cast<uint8_t>(v);}";
+    code += "inline void PutFixed32(Writer& w, uint32_t v){w.p[0] = static_cast<uint8_t>(v);w.p[1] = static_cast<uint8_t>(v >> 8);w.p[2] = static_cast<uint8_t>(v >> 16);w.p[3] = static_cast<uint8_t>(v >> 24);w.p += 4;}";
+    code += "inline void PutFloat(Writer& w, float v){uint32_t u;memcpy(&u, &v, sizeof(u));PutFixed32(w, u);}";
+    code += "inline void PutDouble(Writer& w, double v){uint64_t u;memcpy(&u, &v, sizeof(u));PutFixed32(w, static_cast<uint32_t>(u));PutFixed32(w, static_cast<uint32_t>(u >> 32));}";
+    code += "inline void PutString(Writer& w, const std::string& v){PutVarint(w, static_cast<uint32_t>(v.size()));if(!v.empty()){memcpy(w.p, v.data(), v.size());}w.p += v.size();}";
+    code += "inline uint32_t StringSize(const std::string& v){return VarintSize(static_cast<uint32_t>(v.size())) + static_cast<uint32_t>(v.size());}";
+    code += "inline uint32_t MessageSize(uint32_t n){return VarintSize(n) + n;}";
+    code += "inline uint32_t GetVarint(Reader& r){uint32_t v = 0;int shift = 0;while(r.p < r.end){uint8_t b = *r.p++;if(shift < 32){v |= static_cast<uint32_t>(b & 0x7F) << shift;}if(!(b & 0x80)){return v;}shift += 7;if(shift >= 70){break;}}r.ok = false;return 0;}";
+    code += "inline uint32_t GetFixed32(Reader& r){if(r.end - r.p < 4){r.ok = false;return 0;}uint32_t v = static_cast<uint32_t>(r.p[0]) | (static_cast<uint32_t>(r.p[1]) << 8) | (static_cast<uint32_t>(r.p[2]) << 16) | (static_cast<uint32_t>(r.p[3]) << 24);r.p += 4;return v;}";
+    code += "inline float GetFloat(Reader& r){uint32_t u = GetFixed32(r);float v;memcpy(&v, &u, sizeof(v));return v;}";
+    code += "inline double GetDouble(Reader& r){uint64_t u = GetFixed32(r);u |= static_cast<uint64_t>(GetFixed32(r)) << 32;double v;memcpy(&v, &u, sizeof(v));return v;}";
+    // A length-delimited field as a sub reader, the parent skips past it.
+    code += "inline bool GetSub(Reader& r, Reader& sub){uint32_t len = GetVarint(r);if(!r.ok || len > static_cast<size_t>(r.end - r.p)){r.ok = false;return false;}sub.p = r.p;sub.end = r.p + len;sub.ok = true;r.p += len;return true;}";
+    code += "inline void GetString(Reader& r, std::string& v){Reader sub;if(GetSub(r, sub)){v.assign(reinterpret_cast<const char*>(sub.p), sub.end - sub.p);}}";
+    code += "inline void Skip(Reader& r, uint32_t wire){Reader sub;switch(wire){case 0:GetVarint(r);break;case 1:GetFixed32(r);GetFixed32(r);break;case 2:GetSub(r, sub);break;case 5:GetFixed32(r);break;default:r.ok = false;break;}}";
+    code += "}";
+}
+
+static std::string GenCppSizeValue(const FlatField& mv, const std::string& value)
+{
+    switch (mv.type_)
+    {
+    case kInt32:
+    case ksInt32:
+        return "pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(" + value + "))";
+    case kuInt32:
+        return "pomeloc_rt::VarintSize(" + value + ")";
+    case kfloat:
+        return "4";
+    case kdouble:
+        return "8";
+    case kstring:
+        return "pomeloc_rt::StringSize(" + value + ")";
+    default:
+        return "pomeloc_rt::MessageSize(" + value + ".ByteSize())";
+    }
+}
+
+static std::string GenCppWriteValue(const FlatField& mv, const std::string& value)
+{
+    switch (mv.type_)
+    {
+    case kInt32:
+    case ksInt32:
+        return "pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(" + value + "));";
+    case kuInt32:
+        return "pomeloc_rt::PutVarint(w, " + value + ");";
+    case kfloat:
+        return "pomeloc_rt::PutFloat(w, " + value + ");";
+    case kdouble:
+        return "pomeloc_rt::PutDouble(w, " + value + ");";
+    case kstring:
+        return "pomeloc_rt::PutString(w, " + value + ");";
+    default:
+        return "pomeloc_rt::PutVarint(w, " + value + ".cached_size_);" + value + ".Write(w);";
+    }
+}
+
+static std::string GenCppReadValue(const FlatField& mv, const std::string& target)
+{
+    switch (mv.type_)
+    {
+    case kInt32:
+    case ksInt32:
+        return target + " = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));";
+    case kuInt32:
+        return target + " = pomeloc_rt::GetVarint(r);";
+    case kfloat:
+        return target + " = pomeloc_rt::GetFloat(r);";
+    case kdouble:
+        return target + " = pomeloc_rt::GetDouble(r);";
+    case kstring:
+        return "pomeloc_rt::GetString(r, " + target + ");";
+    default:
+        return "{pomeloc_rt::Reader sub;if(!pomeloc_rt::GetSub(r, sub) || !" + target +
+            ".Read(sub)){return false;}}";
+    }
+}
+
+static void GenCppFields(const FlatSchema& schema, const FlatMessage& msg, CodeWriter& code)
+{
+    for (const auto& mv : schema.fields(msg))
+    {
+        std::string name = schema.str(mv.name_);
+        if (mv.opt_ == kRepeated)
+        {
+            code += "std::vector<";
+            code += MaptoCppType(schema, mv);
+            code += "> ";
+            code += name;
+            code += ";";
+            continue;
+        }
+        code += MaptoCppType(schema, mv);
+        code += " ";
+        code += name;
+        if (mv.type_ >= 0 && mv.type_ < kTypeNone)
+        {
+            code += kTypeCppDefault[mv.type_];
+        }
+        code += ";";
+        if (mv.type_ == kMessage && mv.opt_ == kOptional)
+        {
+            code += "bool has_";
+            code += name;
+            code += " = false;";
+        }
+    }
+}
+
+static void GenCppByteSize(const FlatSchema& schema, const FlatMessage& msg, CodeWriter& code)
+{
+    code += "uint32_t ByteSize() const{uint32_t n = 0;";
+    for (const auto& mv : schema.fields(msg))
+    {
+        std::string name = schema.str(mv.name_);
+        if (IsPackedCpp(mv))
+        {
+            code += "if(!";
+            code += name;
+            code += ".empty()){n += ";
+            code += CppTagSize(mv);
+            code += " + pomeloc_rt::VarintSize(static_cast<uint32_t>(";
+            code += name;
+            code += ".size()));";
+            if (mv.type_ == kfloat || mv.type_ == kdouble)
+            {
+                code += "n += ";
+                code += GenCppSizeValue(mv, "");
+                code += " * static_cast<uint32_t>(";
+                code += name;
+                code += ".size());";
+            }
+            else
+            {
+                code += "for(const auto& e : ";
+                code += name;
+                code += "){n += ";
+                code += GenCppSizeValue(mv, "e");
+                code += ";}";
+            }
+            code += "}";
+        }
+        else if (mv.opt_ == kRepeated)
+        {
+            code += "for(const auto& e : ";
+            code += name;
+            code += "){n += ";
+            code += CppTagSize(mv);
+            code += " + ";
+            code += GenCppSizeValue(mv, "e");
+            code += ";}";
+        }
+        else
+        {
+            std::string stmt = "n += " + CppTagSize(mv) + " + " +
+                GenCppSizeValue(mv, name) + ";";
+            if (mv.type_ == kMessage && mv.opt_ == kOptional)
+            {
+                code += "if(has_";
+                code += name;
+                code += "){";
+                code += stmt;
+                code += "}";
+            }
+            else
+            {
+                code += stmt;
+            }
+        }
+    }
+    code += "cached_size_ = n;return n;}";
+}
+
+// Write() takes nested lengths from cached_size_, so it must follow a
+// ByteSize() of the same message, as Encode() does.
+static void GenCppWrite(const FlatSchema& schema, const FlatMessage& msg, CodeWriter& code)
+{
+    code += "void Write(pomeloc_rt::Writer& w) const{";
+    for (const auto& mv : schema.fields(msg))
+    {
+        std::string name = schema.str(mv.name_);
+        std::string tag = "pomeloc_rt::PutVarint(w, " + NumToString(MaptoCppTag(mv)) + ");";
+        if (IsPackedCpp(mv))
+        {
+            code += "if(!";
+            code += name;
+            code += ".empty()){";
+            code += tag;
+            code += "pomeloc_rt::PutVarint(w, static_cast<uint32_t>(";
+            code += name;
+            code += ".size()));for(const auto& e : ";
+            code += name;
+            code += "){";
+            code += GenCppWriteValue(mv, "e");
+            code += "}}";
+        }
+        else if (mv.opt_ == kRepeated)
+        {
+            code += "for(const auto& e : ";
+            code += name;
+            code += "){";
+            code += tag;
+            code += GenCppWriteValue(mv, "e");
+            code += "}";
+        }
+        else if (mv.type_ == kMessage && mv.opt_ == kOptional)
+        {
+            code += "if(has_";
+            code += name;
+            code += "){";
+            code += tag;
+            code += GenCppWriteValue(mv, name);
+            code += "}";
+        }
+        else
+        {
+            code += tag;
+            code += GenCppWriteValue(mv, name);
+        }
+    }
+    code += "}";
+}
+
+static void GenCppRead(const FlatSchema& schema, const FlatMessage& msg, CodeWriter& code)
+{
+    code += "bool Read(pomeloc_rt::Reader& r){";
+    code += "while(r.ok && r.p < r.end){";
+    code += "uint32_t tag = pomeloc_rt::GetVarint(r);";
+    code += "switch(tag){";
+    for (const auto& mv : schema.fields(msg))
+    {
+        std::string name = schema.str(mv.name_);
+        code += "case ";
+        code += NumToString(MaptoCppTag(mv));
+        code += ":";
+        if (IsPackedCpp(mv))
+        {
+            // every packed value takes at least one byte. A field may come
+            // more than once in a message, each run appends.
+            code += "{uint32_t count = pomeloc_rt::GetVarint(r);";
+            code += "if(!r.ok || count > static_cast<size_t>(r.end - r.p)){return false;}";
+            code += "size_t base = ";
+            code += name;
+            code += ".size();";
+            code += name;
+            code += ".resize(base + count);for(size_t i = base; i < base + count; ++i){";
+            code += GenCppReadValue(mv, name + "[i]");
+            code += "}}";
+        }
+        else if (mv.opt_ == kRepeated)
+        {
+            code += name;
+            code += ".emplace_back();";
+            code += GenCppReadValue(mv, name + ".back()");
+        }
+        else
+        {
+            code += GenCppReadValue(mv, name);
+            if (mv.type_ == kMessage && mv.opt_ == kOptional)
+            {
+                code += "has_";
+                code += name;
+                code += " = true;";
+            }
+        }
+        code += "break;";
+    }
+    code += "default:pomeloc_rt::Skip(r, tag & 7);break;";
+    code += "}";
+    code += "}";
+    code += "return r.ok;}";
+}
+
+static void GenCppStruct(const FlatSchema& schema, int32_t id, const std::string& name,
+    const std::string& extra, CodeWriter& code)
+{
+    const FlatMessage& msg = schema.message(id);
+    code += "struct ";
+    code += name;
+    code += "{";
+    code += extra;
+    for (uint32_t i = 0; i < msg.nested_size_; ++i)
+    {
+        int32_t nested = static_cast<int32_t>(msg.nested_begin_ + i);
+        GenCppStruct(schema, nested, schema.str(schema.message(nested).name_), "", code);
+    }
+    GenCppFields(schema, msg, code);
+    // ByteSize() sizes every nested message once and keeps the result, so
+    // Write() after it takes the length prefixes from cached_size_ instead
+    // of sizing the subtree again.
+    code += "mutable uint32_t cached_size_ = 0;";
+    GenCppByteSize(schema, msg, code);
+    GenCppWrite(schema, msg, code);
+    GenCppRead(schema, msg, code);
+
+    // Entry points over a caller-provided buffer.
+    code += "bool Encode(uint8_t* buf, size_t cap, size_t* len) const{";
+    code += "uint32_t n = ByteSize();if(n > cap){return false;}";
+    code += "pomeloc_rt::Writer w = {buf};Write(w);*len = n;return true;}";
+    code += "bool Decode(const uint8_t* buf, size_t len){";
+    code += "*this = ";
+    code += name;
+    code += "();pomeloc_rt::Reader r = {buf, buf + len, true};return Read(r);}";
+    code += "};";
+}
+
+// route() and, when dictionary codes are assigned, route_id().
+static std::string GenCppRoute(const RouteIds* ids, const std::string& route)
+{
+    std::string code = "static const char* route(){return \"" + route + "\";}";
+    if (ids)
+    {
+        auto it = ids->find(route);
+        if (it != ids->end())
+        {
+            code += "static uint16_t route_id(){return " + NumToString(it->second) + ";}";
+        }
+    }
+    return code;
+}
+
+bool GenerateCpp(const Parser& parser,
+                 const std::string &path,
+                 const std::string &file_name)
+{
+    FlatSchema schema;
+    if (!schema.Build(parser))
+    {
+        return false;
+    }
+    RouteIds ids;
+    const RouteIds* route_ids = nullptr;
+    if (parser.opts.route_ids)
+    {
+        if (!AssignRouteIds(parser, &ids))
+        {
+            return false;
+        }
+        route_ids = &ids;
+    }
+
+    std::string guard = "POMELOC_GENERATED_" + MakeCamel(file_name, true) + "_H_";
+    for (auto& ch : guard)
+    {
+        ch = isalnum(static_cast<unsigned char>(ch)) ? static_cast<char>(toupper(ch)) : '_';
+    }
+
+    // The codecs of one field take roughly this many bytes.
+    CodeWriter declcode(8192 + schema.fields_size() * 1024 + schema.messages_size() * 1024);
+    declcode.AppendRaw("// automatically generated by pomeloc, do not modify\n");
+    declcode.AppendRaw("#ifndef " + guard + "\n");
+    declcode.AppendRaw("#define " + guard + "\n\n");
+    declcode.AppendRaw("#include <cstdint>\n#include <cstring>\n#include <string>\n#include <vector>\n\n");
+    declcode.AppendRaw("#ifndef POMELOC_CPP_RUNTIME_\n#define POMELOC_CPP_RUNTIME_\n");
+    GenCppRuntime(declcode);
+    declcode.AppendRaw("#endif  // POMELOC_CPP_RUNTIME_\n");
+
+    if (!parser.opts.custom_ns.empty())
+    {
+        declcode += "namespace ";
+        declcode += parser.opts.custom_ns;
+        declcode += "{";
+    }
+    for (size_t i = 0; i < schema.routes_size(); ++i)
+    {
+        const FlatRoute& route = schema.route(i);
+        if (route.is_event_)
+        {
+            continue;
+        }
+        declcode += "namespace ";
+        declcode += schema.str(route.ns_);
+        declcode += "{namespace ";
+        declcode += schema.str(route.class_);
+        declcode += "{";
+        std::string extra = GenCppRoute(route_ids, schema.str(route.router_));
+        if (route.response_ >= 0)
+        {
+            std::string response = schema.str(schema.message(route.response_).name_);
+            extra += "typedef ";
+            extra += response;
+            extra += " response;";
+            // declared first so the request can name its response type
+            GenCppStruct(schema, route.response_, response,
+                GenCppRoute(route_ids, schema.str(route.router_)), declcode);
+        }
+        else
+        {
+            extra += "typedef void response;";
+        }
+        GenCppStruct(schema, route.request_, schema.str(route.method_), extra, declcode);
+        declcode += "}}";
+    }
+    declcode += "namespace ServerEvent{";
+    for (size_t i = 0; i < schema.routes_size(); ++i)
+    {
+        const FlatRoute& route = schema.route(i);
+        if (route.is_event_)
+        {
+            GenCppStruct(schema, route.request_, std::string(schema.str(route.method_)) + "_event",
+                GenCppRoute(route_ids, schema.str(route.router_)), declcode);
+        }
+    }
+    declcode += "}";
+    if (!parser.opts.custom_ns.empty())
+    {
+        declcode += "}";
+    }
+
+    declcode.AppendRaw("#endif  // " + guard + "\n");
+    const std::string& code = declcode.str();
+    if (parser.stats_) parser.stats_->AddBytes(kPhaseEmit, code.size());
+
+    return SaveGeneratedFile(parser, path + file_name + ".h", code);
+}
+
+}  // namespace pomeloc
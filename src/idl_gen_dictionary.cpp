@@ -0,0 +1,168 @@
+#include "pomeloc/pomeloc.h"
+#include "pomeloc/idl.h"
+#include "pomeloc/util.h"
+#include "pomeloc/stats.h"
+#include <algorithm>
+#include <set>
+
+namespace pomeloc {
+
+// The handler routes are "<server>.<handler>.<method>", pushes and other
+// single word routes are not numbered by the server.
+static void SortedRoutes(const std::vector<RootStruct>& routes, bool handlers,
+    std::vector<const std::string*>* out)
+{
+    out->clear();
+    for (const auto& rs : routes)
+    {
+        if (rs.is_event_ != handlers)
+        {
+            out->push_back(&rs.router_);
+        }
+    }
+    std::sort(out->begin(), out->end(),
+        [](const std::string* l, const std::string* r) -> bool { return *l < *r; });
+}
+
+// Numbers the routes on from *next, a route seen before keeps its code.
+static bool NumberRoutes(const std::vector<const std::string*>& routes, uint32_t* next,
+    RouteIds* ids)
+{
+    for (const std::string* route : routes)
+    {
+        if (*next > 0xFFFF) return false;
+        if (ids->insert(std::make_pair(*route, static_cast<uint16_t>(*next))).second)
+        {
+            ++*next;
+        }
+    }
+    return true;
+}
+
+// Every route of a handler manifest or dictionary must be known, a route
+// the server does not number would shift or break every code after it.
+static bool CheckListed(const std::vector<const std::string*>& routes, const RouteIds& ids,
+    std::string* error)
+{
+    for (const std::string* route : routes)
+    {
+        if (!ids.count(*route))
+        {
+            if (error) *error = "route " + *route + " is not in the server routes";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AssignRouteIds(const Parser &parser, RouteIds *ids, std::string *error)
+{
+    ids->clear();
+    std::vector<const std::string*> routes;
+    uint32_t next = 1;
+    SortedRoutes(parser.structs_, true, &routes);
+    const ServerRoutes* server = parser.opts.server_routes.get();
+    if (server)
+    {
+        *ids = server->ids;
+        if (!CheckListed(routes, *ids, error)) return false;
+        for (const auto& id : *ids) next = std::max<uint32_t>(next, id.second + 1u);
+    }
+    else if (!NumberRoutes(routes, &next, ids))
+    {
+        if (error) *error = "more routes than 16 bit route codes";
+        return false;
+    }
+    SortedRoutes(parser.event_structs_, false, &routes);
+    if (server && server->complete) return CheckListed(routes, *ids, error);
+    if (!NumberRoutes(routes, &next, ids))
+    {
+        if (error) *error = "more routes than 16 bit route codes";
+        return false;
+    }
+    return true;
+}
+
+bool ParseServerRoutes(const std::string &text, ServerRoutes *routes, std::string *error)
+{
+    routes->ids.clear();
+    json root;
+    try
+    {
+        root = json::parse(text);
+    }
+    catch (const std::exception& e)
+    {
+        *error = e.what();
+        return false;
+    }
+    if (root.is_array())
+    {
+        // Numbered like the server numbers its handlers.
+        std::vector<std::string> handlers;
+        for (const auto& route : root)
+        {
+            if (!route.is_string())
+            {
+                *error = "routes must be strings: " + route.dump();
+                return false;
+            }
+            handlers.push_back(route.get<std::string>());
+        }
+        std::sort(handlers.begin(), handlers.end());
+        handlers.erase(std::unique(handlers.begin(), handlers.end()), handlers.end());
+        if (handlers.size() > 0xFFFF)
+        {
+            *error = "more routes than 16 bit route codes";
+            return false;
+        }
+        for (size_t i = 0; i < handlers.size(); ++i)
+        {
+            routes->ids[handlers[i]] = static_cast<uint16_t>(i + 1);
+        }
+        routes->complete = false;
+        return true;
+    }
+    if (!root.is_object())
+    {
+        *error = "expected a json array of handler routes or an object of route codes";
+        return false;
+    }
+    std::set<uint64_t> codes;
+    for (auto it = root.begin(); it != root.end(); ++it)
+    {
+        const json& value = it.value();
+        uint64_t code = value.is_number_unsigned() ? value.get<uint64_t>() : 0;
+        if (code < 1 || code > 0xFFFF || !codes.insert(code).second)
+        {
+            *error = "invalid code for route " + it.key() + ": " + value.dump();
+            return false;
+        }
+        routes->ids[it.key()] = static_cast<uint16_t>(code);
+    }
+    routes->complete = true;
+    return true;
+}
+
+bool GenerateRouteDictionary(const Parser &parser,
+                             const std::string &path,
+                             const std::string &file_name)
+{
+    (void)file_name;
+    RouteIds ids;
+    if (!AssignRouteIds(parser, &ids)) return false;
+
+    std::vector<const std::string*> pushes;
+    SortedRoutes(parser.event_structs_, false, &pushes);
+    std::string code = "[";
+    for (size_t i = 0; i < pushes.size(); ++i)
+    {
+        code += i ? ",\n  " : "\n  ";
+        code += json(*pushes[i]).dump();
+    }
+    code += pushes.empty() ? "]\n" : "\n]\n";
+    if (parser.stats_) parser.stats_->AddBytes(kPhaseEmit, code.size());
+    return SaveGeneratedFile(parser, path + "dictionary.json", code);
+}
+
+}  // namespace pomeloc
@@ -1,6 +1,9 @@
 #include "pomeloc/pomeloc.h"
 #include "pomeloc/idl.h"
+#include "pomeloc/schema.h"
 #include "pomeloc/util.h"
+#include "pomeloc/stats.h"
+#include "pomeloc/code_writer.h"
 #include <algorithm>
 
 namespace pomeloc {
@@ -105,6 +108,33 @@ LanguageParameters language_parameters[] = {
       "///",
       nullptr,
     },
+  },
+  {
+    IDLOptions::kCpp,
+    false,
+    ".h",
+    "std::string",
+    "bool ",
+    "\n{\n",
+    " const ",
+    "final ",
+    "enum ",
+    ",\n",
+    "",
+    "() const",
+    " : ",
+    "::",
+    "\n{",
+    "\n}\n",
+    "",
+    "",
+    "",
+    "#include <cstdint>\n#include <cstring>\n#include <string>\n#include <vector>\n",
+    {
+      nullptr,
+      "///",
+      nullptr,
+    },
   }
 };
 
@@ -117,15 +147,50 @@ static_assert(sizeof(language_parameters) / sizeof(LanguageParameters) ==
 static bool SaveClass(const LanguageParameters &lang, const Parser &parser,
     const std::string &defname, const std::string &classcode,
     const std::string &path, bool needs_includes, bool onefile) {
+    (void)onefile;
     if (!classcode.length()) return true;
 
-    EnsureDirExists(path);
-
     std::string code = "";// "// automatically generated, do not modify\n\n";
     if (needs_includes) code += lang.includes;
     code += classcode;
-    auto filename = path + defname + lang.file_extension;
-    return SaveFile(filename.c_str(), code, false);
+    return SaveGeneratedFile(parser, path + defname + lang.file_extension, code);
+}
+
+// Opens the custom namespace of a generated file.
+static void BeginNamespacedClass(const Parser &parser, CodeWriter &code)
+{
+    if (!parser.opts.custom_ns.empty())
+    {
+        code += "namespace ";
+        code += parser.opts.custom_ns;
+        code += "{";
+    }
+}
+
+// Closes the custom namespace and saves the code as one file.
+static bool SaveNamespacedClass(const LanguageParameters &lang, const Parser &parser,
+    const std::string &defname, CodeWriter &code, const std::string &path)
+{
+    if (!parser.opts.custom_ns.empty())
+    {
+        code += "}";
+    }
+    const std::string &text = code.Finish();
+    if (parser.stats_) parser.stats_->AddBytes(kPhaseEmit, text.size());
+    return SaveClass(lang, parser, defname, text, path, true, parser.opts.one_file);
+}
+
+// Rough size of the C# emitted for a message, only used to reserve the
+// writer up front.
+static size_t EstimateCodeSize(const Parser &parser, const FlatSchema& schema, int32_t id)
+{
+    const FlatMessage& msg = schema.message(id);
+    size_t size = 512 + msg.fields_size_ * (parser.opts.binary_codec ? 1536 : 512);
+    for (uint32_t i = 0; i < msg.nested_size_; ++i)
+    {
+        size += EstimateCodeSize(parser, schema, static_cast<int32_t>(msg.nested_begin_ + i));
+    }
+    return size;
 }
 
 const char* const kTypeCsharp[] = {
@@ -155,36 +220,63 @@ inline const char* MaptoTypeDefaultString(kType t)
     return "null";
 }
 
-inline const char* MaptoTypeString(const MetaVariable& mv)
+inline const char* MaptoTypeString(const FlatSchema& schema, const FlatField& mv)
 {
     if (mv.type_ >= 0 && mv.type_ < kTypeNone)
     {
         return kTypeCsharp[mv.type_];
     }
-    return mv.typename_.c_str();
+    return schema.str(schema.message(mv.message_).name_);
+}
+
+// With --value-structs a nested message of plain numbers and strings is a
+// C# struct: never null, and an array of them is one block of memory.
+static bool IsValueStruct(const Parser &parser, const FlatSchema& schema, const FlatMessage& msg)
+{
+    if (!parser.opts.value_structs || msg.nested_size_)
+    {
+        return false;
+    }
+    for (const auto& item : schema.fields(msg))
+    {
+        if (item.opt_ == kRepeated || item.type_ == kMessage)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether the message field mv is a value struct.
+static bool IsValueField(const Parser &parser, const FlatSchema& schema, const FlatField& mv)
+{
+    return mv.type_ == kMessage && IsValueStruct(parser, schema, schema.message(mv.message_));
 }
 
 static void GenMetaVariable(const LanguageParameters &lang, const Parser &parser,
-    const MetaVariable& mv, std::string& code)
+    const FlatSchema& schema, const FlatField& mv, CodeWriter& code)
 {
+    (void)lang;
+    (void)parser;
+    std::string name = schema.str(mv.name_);
     code += "public ";
     switch (mv.opt_)
     {
     case kRequired:
     case kOptional:
         {
-            code += MaptoTypeString(mv);
+            code += MaptoTypeString(schema, mv);
             code += " ";
-            code += mv.name_;
+            code += name;
             code += ";";
         }
         break;
 
     case kRepeated:
         {
-            code += MaptoTypeString(mv);
+            code += MaptoTypeString(schema, mv);
             code += "[] ";
-            code += mv.name_;
+            code += name;
             code += ";";
         }
         break;
@@ -193,9 +285,8 @@ static void GenMetaVariable(const LanguageParameters &lang, const Parser &parser
     }
 }
 
-static std::string GenMethodToJsonBodyArray(const std::string& name, kType t)
+static void GenMethodToJsonBodyArray(const std::string& name, kType t, CodeWriter& body)
 {
-    std::string body;
     if (t == kMessage)
     {
         body += "if(";
@@ -227,119 +318,120 @@ static std::string GenMethodToJsonBodyArray(const std::string& name, kType t)
         body += "[i]);";
         body += "}";
     }
-    
-    return body;
 }
 
-static std::string GenMethodFromJsonBodyArray(const MetaVariable& mv, const char* varname, const char* ns = nullptr)
+// Pooled objects refill the array of their previous use when the length
+// matches, and take nested messages from the pools. Value structs are
+// filled in place.
+static void GenMethodFromJsonBodyArray(const FlatSchema& schema, const FlatField& mv,
+    const char* varname, CodeWriter& body, const char* ns = nullptr, bool pooled = false,
+    bool value_struct = false)
 {
-    std::string body;
-    if (mv.type_ == kMessage)
+    std::string name = schema.str(mv.name_);
+    std::string type = MaptoTypeString(schema, mv);
+    if (ns && mv.type_ == kMessage)
     {
-        body += "if(ret.ContainsKey(\"";
-        body += mv.name_;
-        body += "\") && ret[\"";
-        body += mv.name_;
-        body += "\"].IsArray && ret[\"";
-        body += mv.name_;
-        body += "\"].Count > 0){";
+        type = std::string(ns) + "." + type;
+    }
+    std::string field = std::string(varname) + "." + name;
+    std::string value = "ret[\"" + name + "\"]";
+    body += "if(ret.ContainsKey(\"";
+    body += name;
+    body += "\") && ";
+    body += value;
+    body += ".IsArray && ";
+    body += value;
+    body += ".Count > 0){";
+    body += field;
+    if (pooled)
+    {
+        body += " = ProtoPool.Reuse(";
+        body += field;
+        body += ", ref ";
         body += varname;
-        body += ".";
-        body += mv.name_;
+        body += ".spare_";
+        body += name;
+        body += ", ";
+        body += value;
+        body += ".Count);";
+    }
+    else
+    {
         body += " = new ";
-        if (ns)
-        {
-            body += ns;
-            body += ".";
-        }
-        body += MaptoTypeString(mv);
-        body += "[ret[\"";
-        body += mv.name_;
-        body += "\"].Count];";
-        body += "for(int i=0;i<ret[\"";
-        body += mv.name_;
-        body += "\"].Count;++i){";
-        body += varname;
-        body += ".";
-        body += mv.name_;
-        body += "[i] = new ";
-        if (ns)
+        body += type;
+        body += "[";
+        body += value;
+        body += ".Count];";
+    }
+    body += "for(int i=0;i<";
+    body += value;
+    body += ".Count;++i){";
+    if (mv.type_ == kMessage)
+    {
+        if (pooled && !value_struct)
         {
-            body += ns;
-            body += ".";
+            body += type;
+            body += ".Release(";
+            body += field;
+            body += "[i]);";
+            body += field;
+            body += "[i] = ";
+            body += type;
+            body += ".Get();";
         }
-        body += MaptoTypeString(mv);
-        body += "();";
-        body += varname;
-        body += ".";
-        body += mv.name_;
-        body += "[i].FromJson(ret[\"";
-        body += mv.name_;
-        body += "\"][i]);";
-        body += "}}";
+        else
+        {
+            body += field;
+            body += "[i] = new ";
+            body += type;
+            body += "();";
+        }
+        body += field;
+        body += "[i].FromJson(";
+        body += value;
+        body += "[i]);";
     }
     else
     {
-        body += "if(ret.ContainsKey(\"";
-        body += mv.name_;
-        body += "\") && ret[\"";
-        body += mv.name_;
-        body += "\"].IsArray && ret[\"";
-        body += mv.name_;
-        body += "\"].Count > 0){";
-        body += varname;
-        body += ".";
-        body += mv.name_;
-        body += " = new ";
-        body += MaptoTypeString(mv);
-        body += "[ret[\"";
-        body += mv.name_;
-        body += "\"].Count];";
-        body += "for(int i=0;i<ret[\"";
-        body += mv.name_;
-        body += "\"].Count;++i){";
-        body += varname;
-        body += ".";
-        body += mv.name_;
+        body += field;
         body += "[i]=(";
-        body += MaptoTypeString(mv);
-        body += ")ret[\"";
-        body += mv.name_;
-        body += "\"][i];";
-        body += "}}";
+        body += type;
+        body += ")";
+        body += value;
+        body += "[i];";
     }
-
-    return body;
+    body += "}}";
 }
 
-static std::string GenMethodToJsonBody(const LanguageParameters &lang, const Parser &parser,
-    const std::vector<MetaVariable>& vars)
+static void GenMethodToJsonBody(const LanguageParameters &lang, const Parser &parser,
+    const FlatSchema& schema, const FlatMessage& msg, CodeWriter& body)
 {
-    std::string body;
-    for (const auto& item : vars)
+    (void)lang;
+    for (const auto& item : schema.fields(msg))
     {
+        std::string name = schema.str(item.name_);
         if (item.type_ == kMessage)
         {
             if (item.opt_ == kRepeated)
             {
-                body += GenMethodToJsonBodyArray(item.name_, item.type_);
+                GenMethodToJsonBodyArray(name, item.type_, body);
             }
-            else if (item.opt_ == kOptional)
+            else if (item.opt_ == kOptional && !IsValueField(parser, schema, item))
             {
                 body += "if(";
-                body += item.name_;
+                body += name;
                 body += " != null){data[\"";
-                body += item.name_;
+                body += name;
                 body += "\"]=";
-                body += item.name_;
+                body += name;
                 body += ".ToJson();}";
             }
             else
             {
                 body += "data[\"";
-                body += item.name_;
+                body += name;
                 body += "\"]=";
-                body += item.name_;
+                body += name;
                 body += ".ToJson();";
             }
         }
@@ -347,54 +439,67 @@ static std::string GenMethodToJsonBody(const LanguageParameters &lang, const Par
         {
             if (item.opt_ == kRepeated)
             {
-                body += GenMethodToJsonBodyArray(item.name_, item.type_);
+                GenMethodToJsonBodyArray(name, item.type_, body);
             }
             else
             {
                 body += "data[\"";
-                body += item.name_;
+                body += name;
                 body += "\"] = ";
-                body += item.name_;
+                body += name;
                 body += ";";
             }
         }
     }
-    return body;
 }
 
-static std::string GenMethodFromJsonBody(const LanguageParameters &lang, const Parser &parser,
-    const std::vector<MetaVariable>& vars, const char* varname, const char* ns = nullptr)
+static void GenMethodFromJsonBody(const LanguageParameters &lang, const Parser &parser,
+    const FlatSchema& schema, const FlatMessage& msg, const char* varname, CodeWriter& body,
+    const char* ns = nullptr)
 {
-    std::string body;
-    for (const auto& item : vars)
+    (void)lang;
+    for (const auto& item : schema.fields(msg))
     {
+        std::string name = schema.str(item.name_);
+        bool value = IsValueField(parser, schema, item);
+        bool pooled = parser.opts.pooled && !value;
         if (item.type_ == kMessage)
         {
             if (item.opt_ == kRepeated)
             {
-                body += GenMethodFromJsonBodyArray(item, varname, ns);
+                GenMethodFromJsonBodyArray(schema, item, varname, body, ns, parser.opts.pooled,
+                    value);
             }
             else
             {
+                std::string type = MaptoTypeString(schema, item);
+                if (ns)
+                {
+                    type = std::string(ns) + "." + type;
+                }
                 body += "if(ret.ContainsKey(\"";
-                body += item.name_;
+                body += name;
                 body += "\")){";
-                body += varname;
-                body += ".";
-                body += item.name_;
-                body += " = new ";
-                if (ns)
+                if (pooled)
                 {
-                    body += ns;
+                    body += type;
+                    body += ".Release(";
+                    body += varname;
                     body += ".";
+                    body += name;
+                    body += ");";
                 }
-                body += MaptoTypeString(item);
-                body += "();";
                 body += varname;
                 body += ".";
-                body += item.name_;
+                body += name;
+                body += pooled ? " = " : " = new ";
+                body += type;
+                body += pooled ? ".Get();" : "();";
+                body += varname;
+                body += ".";
+                body += name;
                 body += ".FromJson(ret[\"";
-                body += item.name_;
+                body += name;
                 body += "\"]);}";
             }
         }
@@ -402,108 +507,986 @@ static std::string GenMethodFromJsonBody(const LanguageParameters &lang, const P
         {
             if (item.opt_ == kRepeated)
             {
-                body += GenMethodFromJsonBodyArray(item, varname);
+                GenMethodFromJsonBodyArray(schema, item, varname, body, nullptr,
+                    parser.opts.pooled);
             }
             else
             {
                 body += varname;
                 body += ".";
-                body += item.name_;
+                body += name;
                 body += "= ret.ContainsKey(\"";
-                body += item.name_;
+                body += name;
                 body += "\")?(";
-                body += MaptoTypeString(item);
+                body += MaptoTypeString(schema, item);
                 body += ")ret[\"";
-                body += item.name_;
+                body += name;
                 body += "\"]:";
                 body += MaptoTypeDefaultString(item.type_);
                 body += ";";
             }
         }
     }
-    return body;
+}
+
+// Streams the fields into a LitJson JsonWriter w, with the same fields
+// and null handling as the JsonData built by GenMethodToJsonBody.
+static void GenMethodWriteJsonBody(const Parser &parser, const FlatSchema& schema,
+    const FlatMessage& msg, CodeWriter& body)
+{
+    for (const auto& item : schema.fields(msg))
+    {
+        std::string name = schema.str(item.name_);
+        std::string key = "w.WritePropertyName(\"" + name + "\");";
+        if (item.opt_ == kRepeated)
+        {
+            body += "if(";
+            body += name;
+            body += " != null){";
+            body += key;
+            body += "w.WriteArrayStart();";
+            body += "for(int i=0;i<";
+            body += name;
+            body += ".Length;++i){";
+            if (item.type_ == kMessage)
+            {
+                body += name;
+                body += "[i].WriteJson(w);";
+            }
+            else
+            {
+                body += "w.Write(";
+                body += name;
+                body += "[i]);";
+            }
+            body += "}";
+            body += "w.WriteArrayEnd();}";
+        }
+        else if (item.type_ == kMessage)
+        {
+            bool nullable = item.opt_ == kOptional && !IsValueField(parser, schema, item);
+            if (nullable)
+            {
+                body += "if(";
+                body += name;
+                body += " != null){";
+            }
+            body += key;
+            body += name;
+            body += ".WriteJson(w);";
+            if (nullable)
+            {
+                body += "}";
+            }
+        }
+        else
+        {
+            body += key;
+            body += "w.Write(";
+            body += name;
+            body += ");";
+        }
+    }
+}
+
+static void GenMethodWriteJson(const Parser &parser, const FlatSchema& schema,
+    const FlatMessage& msg, CodeWriter& code)
+{
+    code += "public void WriteJson(JsonWriter w){w.WriteObjectStart();";
+    GenMethodWriteJsonBody(parser, schema, msg, code);
+    code += "w.WriteObjectEnd();}";
+}
+
+// Reads the JSON value at the current token of r into target. A message
+// is only created for an object, anything else is skipped.
+static void GenReadJsonValue(const FlatSchema& schema, const FlatField& mv,
+    const std::string& target, bool pooled, CodeWriter& code)
+{
+    switch (mv.type_)
+    {
+    case kMessage:
+        code += "if(r.Token == JsonToken.ObjectStart){";
+        if (pooled)
+        {
+            code += MaptoTypeString(schema, mv);
+            code += ".Release(";
+            code += target;
+            code += ");";
+        }
+        code += target;
+        code += pooled ? " = " : " = new ";
+        code += MaptoTypeString(schema, mv);
+        code += pooled ? ".Get();" : "();";
+        code += target;
+        code += ".ReadJson(r);}else{ProtoJson.Skip(r);}";
+        break;
+    case kfloat:
+        code += target;
+        code += " = (float)ProtoJson.ReadDouble(r);";
+        break;
+    case kdouble:
+        code += target;
+        code += " = ProtoJson.ReadDouble(r);";
+        break;
+    case kstring:
+        code += target;
+        code += " = ProtoJson.ReadString(r);";
+        break;
+    default:
+        code += target;
+        code += " = ProtoJson.ReadInt(r);";
+        break;
+    }
+}
+
+// --read-json: fills the message from a LitJson JsonReader standing on its
+// ObjectStart and leaves it on the matching ObjectEnd. Every member is one
+// switch on its name, fields missing from the JSON get the same values as
+// in FromJson. Arrays grow while reading like the non-packed Decode.
+static void GenMethodReadJson(const Parser &parser, const FlatSchema& schema,
+    const FlatMessage& msg, CodeWriter& code, bool reset)
+{
+    code += "public void ReadJson(JsonReader r){";
+    if (reset)
+    {
+        code += "Reset();";
+    }
+    for (const auto& item : schema.fields(msg))
+    {
+        std::string name = schema.str(item.name_);
+        if (item.opt_ != kRepeated && item.type_ != kMessage)
+        {
+            code += "this.";
+            code += name;
+            code += " = ";
+            code += MaptoTypeDefaultString(item.type_);
+            code += ";";
+        }
+    }
+    code += "while(r.Read() && r.Token == JsonToken.PropertyName){";
+    code += "string key = (string)r.Value;";
+    code += "r.Read();";
+    code += "switch(key){";
+    for (const auto& item : schema.fields(msg))
+    {
+        std::string name = schema.str(item.name_);
+        bool pooled = parser.opts.pooled && !IsValueField(parser, schema, item);
+        std::string field = "this." + name;
+        code += "case \"";
+        code += name;
+        code += "\":";
+        if (item.opt_ != kRepeated)
+        {
+            GenReadJsonValue(schema, item, field, pooled, code);
+            code += "break;";
+            continue;
+        }
+        code += "if(r.Token != JsonToken.ArrayStart){ProtoJson.Skip(r);break;}";
+        code += "{int n = 0;";
+        code += "while(r.Read() && r.Token != JsonToken.ArrayEnd){";
+        code += "if(";
+        code += field;
+        code += " == null || n == ";
+        code += field;
+        code += ".Length){System.Array.Resize(ref ";
+        code += field;
+        code += ", n == 0 ? 4 : n * 2);}";
+        if (item.type_ == kMessage)
+        {
+            // Elements always take a slot so indices follow the JSON.
+            std::string elem = field + "[n]";
+            if (pooled)
+            {
+                code += MaptoTypeString(schema, item);
+                code += ".Release(";
+                code += elem;
+                code += ");";
+            }
+            code += elem;
+            code += pooled ? " = " : " = new ";
+            code += MaptoTypeString(schema, item);
+            code += pooled ? ".Get();" : "();";
+            code += "if(r.Token == JsonToken.ObjectStart){";
+            code += elem;
+            code += ".ReadJson(r);}else{ProtoJson.Skip(r);}";
+        }
+        else
+        {
+            GenReadJsonValue(schema, item, field + "[n]", false, code);
+        }
+        code += "++n;}";
+        code += "if(n > 0 && n != ";
+        code += field;
+        code += ".Length){System.Array.Resize(ref ";
+        code += field;
+        code += ", n);}}";
+        code += "break;";
+    }
+    code += "default:ProtoJson.Skip(r);break;";
+    code += "}";
+    code += "}";
+    code += "}";
 }
 
 static void GenMethodToJson(const LanguageParameters &lang, const Parser &parser,
-    const MetaStruct& ms, std::string& code)
+    const FlatSchema& schema, const FlatMessage& msg, CodeWriter& code)
 {
     code += "public JsonData ToJson(){JsonData data = new JsonData();";
-    code += GenMethodToJsonBody(lang, parser, ms.vars_);
+    GenMethodToJsonBody(lang, parser, schema, msg, code);
     code += "return data;}";
 }
 
 static void GenMethodFromJson(const LanguageParameters &lang, const Parser &parser,
-    const MetaStruct& ms, std::string& code)
+    const FlatSchema& schema, const FlatMessage& msg, CodeWriter& code, bool reset)
 {
     code += "public void FromJson(JsonData ret){";
-    code += GenMethodFromJsonBody(lang, parser, ms.vars_, "this");
+    if (reset)
+    {
+        code += "Reset();";
+    }
+    GenMethodFromJsonBody(lang, parser, schema, msg, "this", code);
+    code += "}";
+}
+
+// pomelo-protobuf wire types, indexed by kType. Messages are length-delimited.
+const int kWireType[] = {
+    0, // int32
+    0, // uInt32
+    0, // sInt32
+    5, // float
+    1, // double
+    2, // string
+};
+
+inline int MaptoWireType(kType t)
+{
+    if (t >= 0 && t < kTypeNone)
+    {
+        return kWireType[t];
+    }
+    return 2;
+}
+
+// pomelo-protobuf packs repeated numeric fields as tag + count + values,
+// everything else is written as one tagged entry per element.
+inline bool IsSimpleType(kType t)
+{
+    return t >= 0 && t < kstring;
+}
+
+// Name of the ProtoWriter/ProtoReader method for a scalar type.
+// pomelo zigzag-encodes int32 the same way as sInt32.
+inline const char* MaptoProtoMethod(kType t)
+{
+    switch (t)
+    {
+    case kInt32:
+    case ksInt32:
+        return "SInt32";
+    case kuInt32:
+        return "UInt32";
+    case kfloat:
+        return "Float";
+    case kdouble:
+        return "Double";
+    case kstring:
+        return "String";
+    default:
+        return "";
+    }
+}
+
+static std::string GenEncodeTag(const FlatField& mv)
+{
+    std::string code;
+    code += "w.WriteTag(";
+    code += NumToString(mv.index_);
+    code += ", ";
+    code += NumToString(MaptoWireType(mv.type_));
+    code += ");";
+    return code;
+}
+
+static std::string GenEncodeValue(const FlatField& mv, const std::string& value)
+{
+    std::string code;
+    if (mv.type_ == kMessage)
+    {
+        code += "{int m = w.BeginMessage();";
+        code += value;
+        code += ".Encode(w);w.EndMessage(m);}";
+    }
+    else
+    {
+        code += "w.Write";
+        code += MaptoProtoMethod(mv.type_);
+        code += mv.type_ == kuInt32 ? "((uint)" : "(";
+        code += value;
+        code += ");";
+    }
+    return code;
+}
+
+static std::string GenDecodeValue(const FlatSchema& schema, const FlatField& mv,
+    const std::string& target, bool pooled)
+{
+    std::string code;
+    if (mv.type_ == kMessage)
+    {
+        code += "{int len = (int)ProtoReader.ReadUInt32(buf, ref offset);";
+        if (pooled)
+        {
+            code += MaptoTypeString(schema, mv);
+            code += ".Release(";
+            code += target;
+            code += ");";
+        }
+        code += target;
+        code += pooled ? " = " : " = new ";
+        code += MaptoTypeString(schema, mv);
+        code += pooled ? ".Get();" : "();";
+        code += target;
+        code += ".Decode(buf, offset, len);offset += len;}";
+    }
+    else
+    {
+        code += target;
+        code += mv.type_ == kuInt32 ? " = (int)ProtoReader.Read" : " = ProtoReader.Read";
+        code += MaptoProtoMethod(mv.type_);
+        code += "(buf, ref offset);";
+    }
+    return code;
+}
+
+// Size of the varint tag of mv, known when generating.
+static std::string GenTagSize(const FlatField& mv)
+{
+    uint32_t tag = (static_cast<uint32_t>(mv.index_) << 3) | MaptoWireType(mv.type_);
+    int n = 1;
+    while (tag > 0x7F)
+    {
+        tag >>= 7;
+        ++n;
+    }
+    return NumToString(n);
+}
+
+static std::string GenSizeValue(const FlatField& mv, const std::string& value)
+{
+    switch (mv.type_)
+    {
+    case kInt32:
+    case ksInt32:
+        return "ProtoWriter.SInt32Size(" + value + ")";
+    case kuInt32:
+        return "ProtoWriter.VarintSize((uint)" + value + ")";
+    case kfloat:
+        return "4";
+    case kdouble:
+        return "8";
+    case kstring:
+        return "ProtoWriter.StringSize(" + value + ")";
+    default:
+        return "ProtoWriter.MessageSize(" + value + ".CalculateSize())";
+    }
+}
+
+// The exact number of bytes Encode writes, following the same skips for
+// null and empty fields.
+static void GenMethodCalculateSize(const Parser &parser, const FlatSchema& schema,
+    const FlatMessage& msg, CodeWriter& code)
+{
+    code += "public int CalculateSize(){int size = 0;";
+    for (const auto& item : schema.fields(msg))
+    {
+        std::string name = schema.str(item.name_);
+        bool value = IsValueField(parser, schema, item);
+        std::string field = "this." + name;
+        if (item.opt_ == kRepeated)
+        {
+            code += "if(";
+            code += field;
+            code += " != null && ";
+            code += field;
+            code += ".Length > 0){";
+            if (IsSimpleType(item.type_))
+            {
+                code += "size += ";
+                code += GenTagSize(item);
+                code += " + ProtoWriter.VarintSize((uint)";
+                code += field;
+                code += ".Length);";
+                if (item.type_ == kfloat || item.type_ == kdouble)
+                {
+                    code += "size += ";
+                    code += GenSizeValue(item, "");
+                    code += " * ";
+                    code += field;
+                    code += ".Length;";
+                }
+                else
+                {
+                    code += "for(int i=0;i<";
+                    code += field;
+                    code += ".Length;++i){size += ";
+                    code += GenSizeValue(item, field + "[i]");
+                    code += ";}";
+                }
+            }
+            else
+            {
+                code += "for(int i=0;i<";
+                code += field;
+                code += ".Length;++i){";
+                if (item.type_ == kMessage && !value)
+                {
+                    code += "if(";
+                    code += field;
+                    code += "[i] == null){continue;}";
+                }
+                code += "size += ";
+                code += GenTagSize(item);
+                code += " + ";
+                code += GenSizeValue(item, field + "[i]");
+                code += ";}";
+            }
+            code += "}";
+        }
+        else
+        {
+            bool nullable = (item.type_ == kMessage && !value) ||
+                (item.type_ == kstring && item.opt_ == kOptional);
+            if (nullable)
+            {
+                code += "if(";
+                code += field;
+                code += " != null){";
+            }
+            code += "size += ";
+            code += GenTagSize(item);
+            code += " + ";
+            code += GenSizeValue(item, field);
+            code += ";";
+            if (nullable)
+            {
+                code += "}";
+            }
+        }
+    }
+    code += "return size;}";
+}
+
+// Writes the fields of msg to the ProtoWriter w. The fields are read by
+// their bare names, so the same body serves the members of a message
+// class and the parameters of a route's request encoder.
+static void GenEncodeBody(const Parser &parser, const FlatSchema& schema, const FlatMessage& msg,
+    CodeWriter& code)
+{
+    for (const auto& item : schema.fields(msg))
+    {
+        std::string name = schema.str(item.name_);
+        bool value = IsValueField(parser, schema, item);
+        if (item.opt_ == kRepeated)
+        {
+            code += "if(";
+            code += name;
+            code += " != null && ";
+            code += name;
+            code += ".Length > 0){";
+            if (IsSimpleType(item.type_))
+            {
+                code += GenEncodeTag(item);
+                code += "w.WriteUInt32((uint)";
+                code += name;
+                code += ".Length);";
+                code += "for(int i=0;i<";
+                code += name;
+                code += ".Length;++i){";
+                code += GenEncodeValue(item, name + "[i]");
+                code += "}";
+            }
+            else
+            {
+                code += "for(int i=0;i<";
+                code += name;
+                code += ".Length;++i){";
+                if (item.type_ == kMessage && !value)
+                {
+                    code += "if(";
+                    code += name;
+                    code += "[i] == null){continue;}";
+                }
+                code += GenEncodeTag(item);
+                code += GenEncodeValue(item, name + "[i]");
+                code += "}";
+            }
+            code += "}";
+        }
+        else if ((item.type_ == kMessage && !value) ||
+            (item.type_ == kstring && item.opt_ == kOptional))
+        {
+            code += "if(";
+            code += name;
+            code += " != null){";
+            code += GenEncodeTag(item);
+            code += GenEncodeValue(item, name);
+            code += "}";
+        }
+        else
+        {
+            code += GenEncodeTag(item);
+            code += GenEncodeValue(item, name);
+        }
+    }
+}
+
+static void GenMethodEncode(const LanguageParameters &lang, const Parser &parser,
+    const FlatSchema& schema, const FlatMessage& msg, CodeWriter& code)
+{
+    (void)lang;
+    code += "public void Encode(ProtoWriter w){";
+    GenEncodeBody(parser, schema, msg, code);
+    code += "}";
+
+    code += "public void Encode(System.IO.Stream s){";
+    code += "ProtoWriter w = ProtoWriter.Shared;Encode(w);s.Write(w.buffer, 0, w.position);";
+    code += "}";
+    code += "public byte[] Encode(){";
+    code += "ProtoWriter w = ProtoWriter.Shared;Encode(w);return w.ToArray();";
+    code += "}";
+    code += "public int Encode(byte[] buf, int offset){";
+    code += "int size = CalculateSize();ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);Encode(w);w.Unwrap();return size;";
+    code += "}";
+}
+
+static void GenMethodDecode(const LanguageParameters &lang, const Parser &parser,
+    const FlatSchema& schema, const FlatMessage& msg, CodeWriter& code, bool reset)
+{
+    (void)lang;
+    code += "public void Decode(byte[] buf, int offset, int length){";
+    if (reset)
+    {
+        code += "Reset();";
+    }
+    code += "int end = offset + length;";
+    // Non-packed repeated fields grow their array while decoding and
+    // are trimmed to the received count afterwards.
+    for (const auto& item : schema.fields(msg))
+    {
+        std::string name = schema.str(item.name_);
+        if (item.opt_ == kRepeated && !IsSimpleType(item.type_))
+        {
+            code += "int n_";
+            code += name;
+            code += " = 0;";
+        }
+    }
+    code += "while(offset < end){";
+    code += "uint tag = ProtoReader.ReadUInt32(buf, ref offset);";
+    code += "switch((int)(tag >> 3)){";
+    for (const auto& item : schema.fields(msg))
+    {
+        std::string name = schema.str(item.name_);
+        bool pooled = parser.opts.pooled && !IsValueField(parser, schema, item);
+        code += "case ";
+        code += NumToString(item.index_);
+        code += ":";
+        if (item.opt_ != kRepeated)
+        {
+            code += GenDecodeValue(schema, item, "this." + name, pooled);
+        }
+        else if (IsSimpleType(item.type_))
+        {
+            // A field may arrive as several packed runs, later runs append.
+            code += "{int count = (int)ProtoReader.ReadUInt32(buf, ref offset);";
+            code += "int start = this.";
+            code += name;
+            code += " == null ? 0 : this.";
+            code += name;
+            code += ".Length;";
+            code += "if(start == 0){this.";
+            code += name;
+            if (parser.opts.pooled)
+            {
+                code += " = ProtoPool.Reuse(this.";
+                code += name;
+                code += ", ref this.spare_";
+                code += name;
+                code += ", count);";
+            }
+            else
+            {
+                code += " = new ";
+                code += MaptoTypeString(schema, item);
+                code += "[count];";
+            }
+            code += "}else{System.Array.Resize(ref this.";
+            code += name;
+            code += ", start + count);}";
+            code += "for(int i=start;i<start + count;++i){";
+            code += GenDecodeValue(schema, item, "this." + name + "[i]", pooled);
+            code += "}}";
+        }
+        else
+        {
+            std::string counter = "n_" + name;
+            code += "if(this.";
+            code += name;
+            code += " == null || ";
+            code += counter;
+            code += " == this.";
+            code += name;
+            code += ".Length){System.Array.Resize(ref this.";
+            code += name;
+            code += ", ";
+            code += counter;
+            code += " == 0 ? 4 : ";
+            code += counter;
+            code += " * 2);}";
+            code += GenDecodeValue(schema, item, "this." + name + "[" + counter + "]",
+                pooled);
+            code += "++";
+            code += counter;
+            code += ";";
+        }
+        code += "break;";
+    }
+    code += "default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));break;";
+    code += "}";
+    code += "}";
+    for (const auto& item : schema.fields(msg))
+    {
+        std::string name = schema.str(item.name_);
+        if (item.opt_ == kRepeated && !IsSimpleType(item.type_))
+        {
+            std::string counter = "n_" + name;
+            code += "if(";
+            code += counter;
+            code += " > 0 && ";
+            code += counter;
+            code += " != this.";
+            code += name;
+            code += ".Length){System.Array.Resize(ref this.";
+            code += name;
+            code += ", ";
+            code += counter;
+            code += ");}";
+        }
+    }
+    code += "}";
+}
+
+// Shared helpers used by the generated Encode/Decode methods.
+static void GenProtoRuntime(CodeWriter& code)
+{
+    code += "[System.Runtime.InteropServices.StructLayout(System.Runtime.InteropServices.LayoutKind.Explicit)]";
+    code += "public struct ProtoBits{";
+    code += "[System.Runtime.InteropServices.FieldOffset(0)]public float f;";
+    code += "[System.Runtime.InteropServices.FieldOffset(0)]public uint u;";
+    code += "}";
+
+    code += "public class ProtoWriter{";
+    code += "public byte[] buffer;";
+    code += "public int position;";
+    code += "[System.ThreadStatic]static ProtoWriter shared;";
+    code += "public static ProtoWriter Shared{get{if(shared == null){shared = new ProtoWriter(256);}shared.position = 0;return shared;}}";
+    code += "public ProtoWriter(int capacity){buffer = new byte[capacity > 0 ? capacity : 16];position = 0;}";
+    code += "public void Ensure(int n){if(position + n > buffer.Length){System.Array.Resize(ref buffer, System.Math.Max(buffer.Length * 2, position + n));}}";
+    code += "public static int VarintSize(uint v){int n = 1;while(v > 0x7F){v >>= 7;++n;}return n;}";
+    code += "public static int SInt32Size(int v){return VarintSize((uint)((v << 1) ^ (v >> 31)));}";
+    code += "public static int StringSize(string v){if(v == null){return 1;}int len = System.Text.Encoding.UTF8.GetByteCount(v);return VarintSize((uint)len) + len;}";
+    code += "public static int MessageSize(int len){return VarintSize((uint)len) + len;}";
+    // A caller buffer sized by CalculateSize() must never be regrown, so
+    // the varint near its end only asks for the bytes it needs.
+    code += "public void WriteUInt32(uint v){if(position + 5 > buffer.Length){Ensure(VarintSize(v));}while(v > 0x7F){buffer[position++] = (byte)(v | 0x80);v >>= 7;}buffer[position++] = (byte)v;}";
+    code += "public void WriteSInt32(int v){WriteUInt32((uint)((v << 1) ^ (v >> 31)));}";
+    code += "public void WriteTag(int index, int wireType){WriteUInt32((uint)((index << 3) | wireType));}";
+    code += "public void WriteFixed32(uint v){Ensure(4);buffer[position++] = (byte)v;buffer[position++] = (byte)(v >> 8);buffer[position++] = (byte)(v >> 16);buffer[position++] = (byte)(v >> 24);}";
+    code += "public void WriteFloat(float v){ProtoBits bits = new ProtoBits();bits.f = v;WriteFixed32(bits.u);}";
+    code += "public void WriteDouble(double v){ulong u = (ulong)System.BitConverter.DoubleToInt64Bits(v);WriteFixed32((uint)u);WriteFixed32((uint)(u >> 32));}";
+    code += "public void WriteString(string v){if(v == null){WriteUInt32(0);return;}int len = System.Text.Encoding.UTF8.GetByteCount(v);WriteUInt32((uint)len);Ensure(len);System.Text.Encoding.UTF8.GetBytes(v, 0, v.Length, buffer, position);position += len;}";
+    // Nested messages are written in place and shifted right once their
+    // length prefix is known.
+    code += "public int BeginMessage(){return position;}";
+    code += "public void EndMessage(int start){int len = position - start;int n = VarintSize((uint)len);Ensure(n);System.Buffer.BlockCopy(buffer, start, buffer, start + n, len);position = start;WriteUInt32((uint)len);position += len;}";
+    // Encode(byte[], int) writes through this instance straight into the
+    // caller's buffer, e.g. one rented from an ArrayPool.
+    code += "[System.ThreadStatic]static ProtoWriter wrapper;";
+    code += "public static ProtoWriter Wrap(byte[] buf, int offset, int size){if(buf == null || offset < 0 || buf.Length - offset < size){throw new System.ArgumentException(\"buffer too small\");}if(wrapper == null){wrapper = new ProtoWriter(1);}wrapper.buffer = buf;wrapper.position = offset;return wrapper;}";
+    code += "public void Unwrap(){buffer = null;position = 0;}";
+    code += "public byte[] ToArray(){byte[] ret = new byte[position];System.Buffer.BlockCopy(buffer, 0, ret, 0, position);return ret;}";
+    code += "}";
+
+    code += "public static class ProtoReader{";
+    code += "public static uint ReadUInt32(byte[] buf, ref int pos){uint v = 0;int shift = 0;byte b;do{b = buf[pos++];if(shift < 32){v |= (uint)(b & 0x7F) << shift;}shift += 7;}while((b & 0x80) != 0);return v;}";
+    code += "public static int ReadSInt32(byte[] buf, ref int pos){uint v = ReadUInt32(buf, ref pos);return (int)(v >> 1) ^ -(int)(v & 1);}";
+    code += "public static uint ReadFixed32(byte[] buf, ref int pos){uint v = (uint)(buf[pos] | (buf[pos + 1] << 8) | (buf[pos + 2] << 16) | (buf[pos + 3] << 24));pos += 4;return v;}";
+    code += "public static float ReadFloat(byte[] buf, ref int pos){ProtoBits bits = new ProtoBits();bits.u = ReadFixed32(buf, ref pos);return bits.f;}";
+    code += "public static double ReadDouble(byte[] buf, ref int pos){ulong lo = ReadFixed32(buf, ref pos);ulong hi = ReadFixed32(buf, ref pos);return System.BitConverter.Int64BitsToDouble((long)(lo | (hi << 32)));}";
+    code += "public static string ReadString(byte[] buf, ref int pos){int len = (int)ReadUInt32(buf, ref pos);string v = System.Text.Encoding.UTF8.GetString(buf, pos, len);pos += len;return v;}";
+    code += "public static void Skip(byte[] buf, ref int pos, int wireType){";
+    code += "switch(wireType){";
+    code += "case 0:ReadUInt32(buf, ref pos);break;";
+    code += "case 1:pos += 8;break;";
+    code += "case 2:{int len = (int)ReadUInt32(buf, ref pos);pos += len;}break;";
+    code += "case 5:pos += 4;break;";
+    code += "default:throw new System.FormatException(\"unknown wire type \" + wireType);";
+    code += "}";
+    code += "}";
+    code += "}";
+}
+
+// Helpers of the streaming JSON methods. The JsonWriter is reused by
+// every --stream-json request of a thread, End() encodes what was written
+// without going through a string. The --read-json readers convert the
+// value at the current token and skip values of an unexpected kind.
+static void GenJsonRuntime(const Parser &parser, CodeWriter& code)
+{
+    code += "public static class ProtoJson{";
+    if (parser.opts.stream_json)
+    {
+        code += "[System.ThreadStatic]static System.Text.StringBuilder text;";
+        code += "[System.ThreadStatic]static JsonWriter writer;";
+        code += "[System.ThreadStatic]static char[] chars;";
+        code += "public static JsonWriter Begin(){if(writer == null){text = new System.Text.StringBuilder(256);writer = new JsonWriter(text);}text.Length = 0;writer.Reset();return writer;}";
+        code += "public static byte[] End(){int n = text.Length;if(chars == null || chars.Length < n){chars = new char[System.Math.Max(n, 256)];}text.CopyTo(0, chars, 0, n);return System.Text.Encoding.UTF8.GetBytes(chars, 0, n);}";
+    }
+    if (parser.opts.read_json)
+    {
+        code += "public static void Skip(JsonReader r){int depth = 0;do{if(r.Token == JsonToken.ObjectStart || r.Token == JsonToken.ArrayStart){++depth;}else if(r.Token == JsonToken.ObjectEnd || r.Token == JsonToken.ArrayEnd){--depth;}}while(depth > 0 && r.Read());}";
+        code += "public static int ReadInt(JsonReader r){switch(r.Token){case JsonToken.Int:case JsonToken.Long:case JsonToken.Double:return (int)System.Convert.ToInt64(r.Value);default:Skip(r);return 0;}}";
+        code += "public static double ReadDouble(JsonReader r){switch(r.Token){case JsonToken.Int:case JsonToken.Long:case JsonToken.Double:return System.Convert.ToDouble(r.Value);default:Skip(r);return 0.0;}}";
+        code += "public static string ReadString(JsonReader r){if(r.Token == JsonToken.String){return (string)r.Value;}Skip(r);return null;}";
+    }
+    code += "}";
+}
+
+// Pools behind Get()/Release() of the --pooled message classes, and the
+// array reuse of their FromJson/Decode.
+static void GenPoolRuntime(CodeWriter& code)
+{
+    code += "public static class ProtoPool<T> where T : new(){";
+    code += "static readonly System.Collections.Generic.Stack<T> items = new System.Collections.Generic.Stack<T>();";
+    code += "public static T Get(){lock(items){if(items.Count > 0){return items.Pop();}}return new T();}";
+    code += "public static void Put(T v){lock(items){items.Push(v);}}";
+    code += "}";
+
+    // Arrays are sized to their element count, so one is only reused for
+    // the same count. The array it replaces is kept as the next spare.
+    code += "public static class ProtoPool{";
+    code += "public static T[] Reuse<T>(T[] current, ref T[] spare, int n){";
+    code += "if(current != null && current.Length == n){return current;}";
+    code += "T[] ret;";
+    code += "if(spare != null && spare.Length == n){ret = spare;spare = current;}";
+    code += "else{ret = new T[n];if(current != null){spare = current;}}";
+    code += "return ret;";
+    code += "}";
+    code += "}";
+}
+
+// Get()/Release() and Reset() of a pooled message. Reset() returns the
+// nested messages to their pools and leaves the object as if newly made,
+// repeated fields keep their array as a spare for the next use.
+static void GenPoolMembers(const Parser &parser, const FlatSchema& schema, const FlatMessage& msg,
+    const std::string& cls, CodeWriter& code)
+{
+    for (const auto& item : schema.fields(msg))
+    {
+        std::string name = schema.str(item.name_);
+        if (item.opt_ == kRepeated)
+        {
+            code += "private ";
+            code += MaptoTypeString(schema, item);
+            code += "[] spare_";
+            code += name;
+            code += ";";
+        }
+    }
+    code += "public static ";
+    code += cls;
+    code += " Get(){return ProtoPool<";
+    code += cls;
+    code += ">.Get();}";
+    code += "public static void Release(";
+    code += cls;
+    code += " v){if(v == null){return;}v.Reset();ProtoPool<";
+    code += cls;
+    code += ">.Put(v);}";
+
+    code += "public void Reset(){";
+    for (const auto& item : schema.fields(msg))
+    {
+        std::string name = schema.str(item.name_);
+        if (item.opt_ == kRepeated)
+        {
+            code += "if(";
+            code += name;
+            code += " != null){";
+            if (item.type_ == kMessage && !IsValueField(parser, schema, item))
+            {
+                code += "for(int i=0;i<";
+                code += name;
+                code += ".Length;++i){";
+                code += MaptoTypeString(schema, item);
+                code += ".Release(";
+                code += name;
+                code += "[i]);";
+                code += name;
+                code += "[i] = null;}";
+            }
+            code += "spare_";
+            code += name;
+            code += " = ";
+            code += name;
+            code += ";";
+            code += name;
+            code += " = null;}";
+        }
+        else if (IsValueField(parser, schema, item))
+        {
+            code += name;
+            code += " = default(";
+            code += MaptoTypeString(schema, item);
+            code += ");";
+        }
+        else if (item.type_ == kMessage)
+        {
+            code += MaptoTypeString(schema, item);
+            code += ".Release(";
+            code += name;
+            code += ");";
+            code += name;
+            code += " = null;";
+        }
+        else
+        {
+            code += name;
+            code += " = ";
+            code += item.type_ == kstring ? "null" : MaptoTypeDefaultString(item.type_);
+            code += ";";
+        }
+    }
     code += "}";
 }
 
 static void GenMetaStruct(const LanguageParameters &lang, const Parser &parser,
-    const MetaStruct& ms, std::string& code)
+    const FlatSchema& schema, int32_t id, const std::string& name, CodeWriter& code,
+    bool nested = false);
+
+// Emits the messages declared inside msg, their names prefixed with prefix.
+static void GenNestedStructs(const LanguageParameters &lang, const Parser &parser,
+    const FlatSchema& schema, const FlatMessage& msg, const std::string& prefix,
+    CodeWriter& code)
 {
-    code += "public class ";
-    code += ms.name_;
+    for (uint32_t i = 0; i < msg.nested_size_; ++i)
+    {
+        int32_t nested = static_cast<int32_t>(msg.nested_begin_ + i);
+        GenMetaStruct(lang, parser, schema, nested,
+            prefix + schema.str(schema.message(nested).name_), code, true);
+    }
+}
+
+// name overrides the message name, so root and event messages can be
+// emitted under their generated names.
+static void GenMetaStruct(const LanguageParameters &lang, const Parser &parser,
+    const FlatSchema& schema, int32_t id, const std::string& name, CodeWriter& code,
+    bool nested)
+{
+    const FlatMessage& msg = schema.message(id);
+    bool value = nested && IsValueStruct(parser, schema, msg);
+    code += value ? "public struct " : "public class ";
+    code += name;
     code += "{";
 
-    for (const auto& item : ms.structs_)
+    GenNestedStructs(lang, parser, schema, msg, "", code);
+
+    for (const auto& item : schema.fields(msg))
     {
-        GenMetaStruct(lang, parser, item.second, code);
+        GenMetaVariable(lang, parser, schema, item, code);
     }
 
-    for (const auto& item : ms.vars_)
+    // A pooled object may be decoded into again, so each decode starts
+    // from Reset() and fields missing from the payload do not keep the
+    // previous message's values or arrays.
+    bool reset = parser.opts.pooled && !value;
+    if (reset)
     {
-        GenMetaVariable(lang, parser, item, code);
+        GenPoolMembers(parser, schema, msg, name, code);
     }
 
     //generator JsonData Serialized Method
-    std::string mtojson, mfromjson;
-    GenMethodToJson(lang, parser, ms, mtojson);
-    GenMethodFromJson(lang, parser, ms, mfromjson);
+    GenMethodToJson(lang, parser, schema, msg, code);
+    GenMethodFromJson(lang, parser, schema, msg, code, reset);
+    if (parser.opts.stream_json)
+    {
+        GenMethodWriteJson(parser, schema, msg, code);
+    }
+    if (parser.opts.read_json)
+    {
+        GenMethodReadJson(parser, schema, msg, code, reset);
+    }
 
-    code += mtojson;
-    code += mfromjson;
+    if (parser.opts.binary_codec)
+    {
+        GenMethodCalculateSize(parser, schema, msg, code);
+        GenMethodEncode(lang, parser, schema, msg, code);
+        GenMethodDecode(lang, parser, schema, msg, code, reset);
+    }
     code += "}";
 }
 
+// The parameter list of a route's method. callback adds the response
+// callback; call, when given, gets the argument names in parameter order.
 static void GenFuncArguments(const LanguageParameters &lang, const Parser &parser,
-    const RootStruct& rs, std::string& code)
+    const FlatSchema& schema, const FlatRoute& route, std::string& code, bool callback = true,
+    std::string* call = nullptr)
 {
+    (void)lang;
     code += "(";
-    std::string reqArg, optArg;
-    for (const auto& item : rs.vars_)
+    std::string reqArg, optArg, reqName, optName;
+    for (const auto& item : schema.fields(schema.message(route.request_)))
     {
+        std::string name = schema.str(item.name_);
+        // messages of a route are emitted as <method>_<message>
+        std::string type = MaptoTypeString(schema, item);
+        if (item.type_ == kMessage)
+        {
+            type = std::string(schema.str(route.method_)) + "_" + type;
+        }
         switch (item.opt_)
         {
         case kRequired:
         {
-            reqArg += MaptoTypeString(item);
+            reqArg += type;
             reqArg += " ";
-            reqArg += item.name_;
+            reqArg += name;
             reqArg += ",";
+            reqName += ", " + name;
         }
         break;
         case kOptional:
         {
-            optArg += MaptoTypeString(item);
+            optArg += type;
             optArg += " ";
-            optArg += item.name_;
+            optArg += name;
             if (item.opt_ == kOptional)
             {
                 optArg += "=";
-                optArg += MaptoTypeDefaultString(item.type_);
+                optArg += IsValueField(parser, schema, item) ? "default(" + type + ")"
+                    : std::string(MaptoTypeDefaultString(item.type_));
             }
             optArg += ",";
+            optName += ", " + name;
         }
         break;
 
         case kRepeated:
         {
-            reqArg += MaptoTypeString(item);
+            reqArg += type;
             reqArg += "[] ";
-            reqArg += item.name_;
+            reqArg += name;
             reqArg += ",";
+            reqName += ", " + name;
         }
         break;
         default:
@@ -512,14 +1495,15 @@ static void GenFuncArguments(const LanguageParameters &lang, const Parser &parse
     }
     code += reqArg;
     code += optArg;
+    if (call)
     {
-        auto itResponse = parser.response_maps_.find(rs.router_);
-        if (itResponse != parser.response_maps_.end())
-        {
-            code += "System.Action<";
-            code += itResponse->second.name_;
-            code += "> cb,";
-        }
+        *call = reqName + optName;
+    }
+    if (callback && route.response_ >= 0)
+    {
+        code += "System.Action<";
+        code += schema.str(schema.message(route.response_).name_);
+        code += "> cb,";
     }
 
     if (code.at(code.size() - 1) == '(')
@@ -532,76 +1516,189 @@ static void GenFuncArguments(const LanguageParameters &lang, const Parser &parse
     }
 }
 
-static std::string SerializeJson(const MetaVariable& var)
+// The route argument of pc.request/notify/on: the dictionary code from the
+// Routes class of the enclosing class when codes are assigned, the route
+// string otherwise.
+static std::string GenRouteArg(const RouteIds* ids, const FlatSchema& schema,
+    const FlatRoute& route)
 {
-    std::string code;
+    if (ids && ids->count(schema.str(route.router_)))
+    {
+        return std::string("Routes.") + schema.str(route.method_);
+    }
+    return std::string("\"") + schema.str(route.router_) + "\"";
+}
 
-    return code;
+// public static class Routes{public const ushort <method> = <code>;...}
+static void GenRouteIds(const RouteIds* ids, const FlatSchema& schema,
+    const std::vector<const FlatRoute*>& routes, CodeWriter& code)
+{
+    if (!ids)
+    {
+        return;
+    }
+    code += "public static class Routes{";
+    for (const FlatRoute* route : routes)
+    {
+        auto it = ids->find(schema.str(route->router_));
+        if (it != ids->end())
+        {
+            code += "public const ushort ";
+            code += schema.str(route->method_);
+            code += " = ";
+            code += NumToString(it->second);
+            code += ";";
+        }
+    }
+    code += "}";
 }
 
-static std::string GenResponseCallBackBody(const LanguageParameters &lang, const Parser &parser,
-    const RootStruct& rs, const MetaStruct& ms)
+// With --binary every route gets an encoder of its arguments,
+// public static class Requests{public static void <method>(ProtoWriter w, ...)},
+// so requests are written straight to protobuf without a message object.
+static void GenRequestEncoders(const LanguageParameters &lang, const Parser &parser,
+    const FlatSchema& schema, const std::vector<const FlatRoute*>& routes, CodeWriter& code)
 {
-    std::string code;
-    code += ms.name_;
+    code += "public static class Requests{";
+    for (const FlatRoute* route : routes)
+    {
+        std::string arglist;
+        GenFuncArguments(lang, parser, schema, *route, arglist, false);
+        code += "public static void ";
+        code += schema.str(route->method_);
+        code += arglist.size() > 2 ? "(ProtoWriter w, " + arglist.substr(1) : "(ProtoWriter w)";
+        code += "{";
+        GenEncodeBody(parser, schema, schema.message(route->request_), code);
+        code += "}";
+    }
+    code += "}";
+}
+
+// Fills the result of a callback through FromJson, with --binary through
+// Decode of the received bytes or, with --read-json, from a reader over
+// the JSON text. A pooled result is only valid inside cb, it is recycled
+// right after.
+static void GenCallBackBody(const Parser &parser, const std::string& name, CodeWriter& code)
+{
+    bool pooled = parser.opts.pooled;
+    code += name;
+    code += pooled ? " result = " : " result = new ";
+    code += name;
+    code += pooled ? ".Get();" : "();";
+    if (parser.opts.binary_codec)
+    {
+        code += "result.Decode(ret, 0, ret.Length);";
+    }
+    else if (parser.opts.read_json)
+    {
+        code += "JsonReader r = new JsonReader(ret);";
+        code += "if(r.Read() && r.Token == JsonToken.ObjectStart){result.ReadJson(r);}";
+    }
+    else
+    {
+        code += "result.FromJson(ret);";
+    }
+    if (pooled)
+    {
+        code += "try{cb(result);}finally{";
+        code += name;
+        code += ".Release(result);}";
+    }
+    else
+    {
+        code += "cb(result);";
+    }
+}
+
+// With --binary callbacks get the protobuf bytes and with --read-json the
+// JSON text instead of a JsonData.
+inline const char* GenCallBackArg(const Parser &parser)
+{
+    if (parser.opts.binary_codec)
+    {
+        return ", delegate (byte[] ret){";
+    }
+    return parser.opts.read_json ? ", delegate (string ret){" : ", delegate (JsonData ret){";
+}
+
+static void GenResponseCallBackBody(const LanguageParameters &lang, const Parser &parser,
+    const FlatSchema& schema, const FlatMessage& msg, CodeWriter& code)
+{
+    const char* name = schema.str(msg.name_);
+    if (parser.opts.pooled || parser.opts.read_json || parser.opts.binary_codec)
+    {
+        GenCallBackBody(parser, name, code);
+        return;
+    }
+    code += name;
     code += " result = new ";
-    code += ms.name_;
+    code += name;
     code += "();";
-    code += GenMethodFromJsonBody(lang, parser, ms.vars_, "result", ms.name_.c_str());
+    GenMethodFromJsonBody(lang, parser, schema, msg, "result", code, name);
     code += "cb(result);";
-    return code;
 }
 
 static void GenEventFuncBody(const LanguageParameters &lang, const Parser &parser,
-    const RootStruct& rs, std::string& code, const MetaStruct& msevent)
+    const FlatSchema& schema, const FlatRoute& route, const RouteIds* ids, CodeWriter& code,
+    const std::string& name)
 {
+    (void)lang;
     code += "{";
 
-    code += "pc.on(\"";
-    code += rs.router_;
-    code += "\", delegate (JsonData ret){";
-    
-    code += msevent.name_;
+    code += "pc.on(";
+    code += GenRouteArg(ids, schema, route);
+    code += GenCallBackArg(parser);
+    if (parser.opts.pooled || parser.opts.read_json || parser.opts.binary_codec)
+    {
+        GenCallBackBody(parser, name, code);
+        code += "});";
+        code += "return true;";
+        code += "}";
+        return;
+    }
+
+    code += name;
     code += " result = new ";
-    code += msevent.name_;
+    code += name;
     code += "();";
-    for (const auto& var : msevent.vars_)
+    for (const auto& var : schema.fields(schema.message(route.request_)))
     {
+        std::string field = schema.str(var.name_);
         if (var.type_ == kMessage)
         {
             code += "if(ret.ContainsKey(\"";
-            code += var.name_;
+            code += field;
             code += "\")){";
             if (var.opt_ == kRepeated)
             {
                 code += "if(ret[\"";
-                code += var.name_;
+                code += field;
                 code += "\"].IsArray && ret[\"";
-                code += var.name_;
+                code += field;
                 code += "\"].Count > 0){";
                 code += "result.";
-                code += var.name_;
+                code += field;
                 code += " = new ";
-                code += msevent.name_;
+                code += name;
                 code += ".";
-                code += MaptoTypeString(var);
+                code += MaptoTypeString(schema, var);
                 code += "[ret[\"";
-                code += var.name_;
+                code += field;
                 code += "\"].Count];";
                 code += "for(int i=0;i<ret[\"";
-                code += var.name_;
+                code += field;
                 code += "\"].Count;++i){";
                 code += "result.";
-                code += var.name_;
+                code += field;
                 code += "[i] = new ";
-                code += msevent.name_;
+                code += name;
                 code += ".";
-                code += MaptoTypeString(var);
+                code += MaptoTypeString(schema, var);
                 code += "();result.";
-                code += var.name_;
+                code += field;
                 code += "[i].FromJson(";
                 code += "ret[\"";
-                code += var.name_;
+                code += field;
                 code += "\"][i]);";
                 code += "}";
                 code += "}";
@@ -609,17 +1706,17 @@ static void GenEventFuncBody(const LanguageParameters &lang, const Parser &parse
             else
             {
                 code += "result.";
-                code += var.name_;
+                code += field;
                 code += " = new ";
-                code += msevent.name_;
+                code += name;
                 code += ".";
-                code += MaptoTypeString(var);
+                code += MaptoTypeString(schema, var);
                 code += "();";
                 code += "result.";
-                code += var.name_;
+                code += field;
                 code += ".FromJson(";
                 code += "ret[\"";
-                code += var.name_;
+                code += field;
                 code += "\"]);";
             }
             
@@ -628,32 +1725,32 @@ static void GenEventFuncBody(const LanguageParameters &lang, const Parser &parse
         else
         {
             code += "if(ret.ContainsKey(\"";
-            code += var.name_;
+            code += field;
             code += "\")){";
 
             if (var.opt_ == kRepeated)
             {
                 code += "if(ret[\"";
-                code += var.name_;
+                code += field;
                 code += "\"].IsArray && ret[\"";
-                code += var.name_;
+                code += field;
                 code += "\"].Count > 0){";
                 code += "result.";
-                code += var.name_;
+                code += field;
                 code += " = new ";
-                code += MaptoTypeString(var);
+                code += MaptoTypeString(schema, var);
                 code += "[ret[\"";
-                code += var.name_;
+                code += field;
                 code += "\"].Count];";
                 code += "for(int i=0;i<ret[\"";
-                code += var.name_;
+                code += field;
                 code += "\"].Count;++i){";
                 code += "result.";
-                code += var.name_;
+                code += field;
                 code += "[i] = (";
-                code += MaptoTypeString(var);
+                code += MaptoTypeString(schema, var);
                 code += ")ret[\"";
-                code += var.name_;
+                code += field;
                 code += "\"][i];";
                 code += "}";
                 code += "}";
@@ -661,11 +1758,11 @@ static void GenEventFuncBody(const LanguageParameters &lang, const Parser &parse
             else
             {
                 code += "result.";
-                code += var.name_;
+                code += field;
                 code += " = (";
-                code += MaptoTypeString(var);
+                code += MaptoTypeString(schema, var);
                 code += ")ret[\"";
-                code += var.name_;
+                code += field;
                 code += "\"];";
             }
             code += "}";
@@ -680,28 +1777,57 @@ static void GenEventFuncBody(const LanguageParameters &lang, const Parser &parse
 }
 
 static void GenFuncBody(const LanguageParameters &lang, const Parser &parser,
-    const RootStruct& rs, std::string& code)
+    const FlatSchema& schema, const FlatRoute& route, const RouteIds* ids, CodeWriter& code)
 {
+    const FlatMessage& request = schema.message(route.request_);
     code += "{";
 
-    code += "JsonData data = new JsonData();";
-    code += GenMethodToJsonBody(lang, parser, rs.vars_);
+    // With --binary the arguments are encoded to protobuf and with
+    // --stream-json written straight to JSON text; either way the client
+    // gets bytes.
+    const char* body = "data";
+    if (parser.opts.binary_codec)
+    {
+        std::string arglist, call;
+        GenFuncArguments(lang, parser, schema, route, arglist, false, &call);
+        code += "ProtoWriter w = ProtoWriter.Shared;Requests.";
+        code += schema.str(route.method_);
+        code += "(w";
+        code += call;
+        code += ");";
+        body = "w.ToArray()";
+    }
+    else if (parser.opts.stream_json)
+    {
+        code += "JsonWriter w = ProtoJson.Begin();w.WriteObjectStart();";
+        GenMethodWriteJsonBody(parser, schema, request, code);
+        code += "w.WriteObjectEnd();";
+        body = "ProtoJson.End()";
+    }
+    else
+    {
+        code += "JsonData data = new JsonData();";
+        GenMethodToJsonBody(lang, parser, schema, request, code);
+    }
 
-    auto itResponse = parser.response_maps_.find(rs.router_);
-    if (itResponse != parser.response_maps_.end())
+    if (route.response_ >= 0)
     {
-        code += "pc.request(\"";
-        code += rs.router_;
-        code += "\", data, delegate (JsonData ret){";
-        code += GenResponseCallBackBody(lang, parser, rs, itResponse->second);
+        code += "pc.request(";
+        code += GenRouteArg(ids, schema, route);
+        code += ", ";
+        code += body;
+        code += GenCallBackArg(parser);
+        GenResponseCallBackBody(lang, parser, schema, schema.message(route.response_), code);
         code += "});";
         code += "return true;";
     }
     else
     {
-        code += "pc.notify(\"";
-        code += rs.router_;
-        code += "\", data);";
+        code += "pc.notify(";
+        code += GenRouteArg(ids, schema, route);
+        code += ", ";
+        code += body;
+        code += ");";
         code += "return true;";
     }
     
@@ -709,107 +1835,71 @@ static void GenFuncBody(const LanguageParameters &lang, const Parser &parser,
 }
 
 static void GenEventStruct(const LanguageParameters &lang, const Parser &parser,
-    const RootStruct& rs, std::string& code)
+    const FlatSchema& schema, const FlatRoute& route, const RouteIds* ids, CodeWriter& code)
 {
-    MetaStruct ms;
-    ms.name_ = rs.method_ + "_event";
-    ms.structs_ = rs.structs_;
-    ms.vars_ = rs.vars_;
-    GenMetaStruct(lang, parser, ms, code);
+    std::string name = std::string(schema.str(route.method_)) + "_event";
+    GenMetaStruct(lang, parser, schema, route.request_, name, code);
 
     code += "public static bool ";
-    code += rs.method_;
+    code += schema.str(route.method_);
     {
         code += "(System.Action<";
-        code += ms.name_;
+        code += name;
         code += "> cb)";
     }
-    std::string funcbody;
-    GenEventFuncBody(lang, parser, rs, funcbody, ms);
-    code += funcbody;
+    GenEventFuncBody(lang, parser, schema, route, ids, code, name);
 }
 
 static void GenRootStruct(const LanguageParameters &lang, const Parser &parser,
-    const RootStruct& rs, std::string& code) 
+    const FlatSchema& schema, const FlatRoute& route, const RouteIds* ids, CodeWriter& code)
 {
-    for (const auto& item : rs.structs_)
-    {
-        GenMetaStruct(lang, parser, item.second, code);
-    }
+    GenNestedStructs(lang, parser, schema, schema.message(route.request_),
+        std::string(schema.str(route.method_)) + "_", code);
 
+    if (route.response_ >= 0)
     {
-        auto itResponse = parser.response_maps_.find(rs.router_);
-        if (itResponse != parser.response_maps_.end())
-        {
-            GenMetaStruct(lang, parser, itResponse->second, code);
-        }
+        GenMetaStruct(lang, parser, schema, route.response_,
+            schema.str(schema.message(route.response_).name_), code);
     }
 
     code += "public static bool ";
-    code += rs.method_;
+    code += schema.str(route.method_);
     std::string arglist;
-    GenFuncArguments(lang, parser, rs, arglist);
+    GenFuncArguments(lang, parser, schema, route, arglist);
     code += arglist;
-    std::string funcbody;
-    GenFuncBody(lang, parser, rs, funcbody);
-    code += funcbody;
+    GenFuncBody(lang, parser, schema, route, ids, code);
 }
 
-std::string GenTabSpace(int n)
-{
-	std::string ret;
-	for (int i = 0; i < 4*n; i++)
-	{
-		ret += " ";
-	}
-	return ret;
-}
+typedef std::map<std::string, const FlatRoute*> G_BY_METHOD;
 
-void Format(const std::string &code, std::string& fmt)
+static void GenClass(const LanguageParameters &lang, const Parser &parser,
+    const FlatSchema& schema, const std::string &ns, const std::string &cls,
+    const G_BY_METHOD &methods, const RouteIds* ids, CodeWriter &code)
 {
-	int index = 0;
-    for (size_t i = 0; i < code.length(); ++i)
+    code += "namespace ";
+    code += ns;
+    code += "{";
+    code += "public class ";
+    code += cls;
+    code += "{";
+    code += "public static PomeloClient pc = null;";
+    std::vector<const FlatRoute*> routes;
+    for (const auto& method : methods)
     {
-        char ch = code.at(i);
-		if (ch == '{')
-		{
-			fmt += "\n";
-            fmt += GenTabSpace(index);
-			++index;
-            fmt += ch;
-            fmt += "\n";
-			fmt += GenTabSpace(index);
-            continue;
-		}
-		fmt += ch;
-		if (ch == ';')
-		{
-			fmt += "\n";
-            if (i + 1 < code.length() && code.at(i + 1) == '}')
-            {
-                fmt += GenTabSpace(index-1);
-            }
-            else
-            {
-                fmt += GenTabSpace(index);
-            }
-		}
-		if (ch == '}')
-		{
-			fmt += "\n";
-			--index;
-            if (i + 1 < code.length() && code.at(i + 1) == '}')
-            {
-                fmt += GenTabSpace(index - 1);
-            }
-            else
-            {
-                fmt += GenTabSpace(index);
-            }
-		}
-	}
+        routes.push_back(method.second);
+    }
+    GenRouteIds(ids, schema, routes, code);
+    if (parser.opts.binary_codec)
+    {
+        GenRequestEncoders(lang, parser, schema, routes, code);
+    }
 
-	assert(0 == index && "mismatch {} !!!");
+    for (const auto& method : methods)
+    {
+        GenRootStruct(lang, parser, schema, *method.second, ids, code);
+    }
+    code += "}";
+    code += "}";
 }
 
 bool GenerateGeneral(const Parser& parser,
@@ -819,92 +1909,196 @@ bool GenerateGeneral(const Parser& parser,
 
   assert(parser.opts.lang <= IDLOptions::kMAX);
   auto lang = language_parameters[parser.opts.lang];
-  std::string one_file_code;
+
+  // The generator walks the flattened schema, client routes and server
+  // pushes alike sorted by route name.
+  FlatSchema schema;
+  if (!schema.Build(parser))
+  {
+      return false;
+  }
 
   //group by ns, class ,method
-  using G_BY_METHOD = std::unordered_map<std::string, pomeloc::RootStruct>;
-  using G_BY_CLASS = std::unordered_map<std::string, G_BY_METHOD>;
-  using G_BY_NS = std::unordered_map<std::string, G_BY_CLASS>;
+  using G_BY_CLASS = std::map<std::string, G_BY_METHOD>;
+  using G_BY_NS = std::map<std::string, G_BY_CLASS>;
   G_BY_NS tmpgroup;
-  for (const auto& item : parser.structs_)
+  std::vector<const FlatRoute*> events;
+  for (size_t i = 0; i < schema.routes_size(); ++i)
   {
-	  auto it = tmpgroup.find(item.ns_);
-	  if (it != tmpgroup.end())
-	  {
-		  auto iit = it->second.find(item.class_);
-		  if (iit != it->second.end())
-		  {
-			  auto iiit = iit->second.find(item.method_);
-			  if (iiit != iit->second.end())
-			  {
-				  return false;
-			  }
-			  iit->second[item.method_] = item;
-		  }
-		  else
-		  {
-			  it->second[item.class_][item.method_] = item;
-		  }
-	  }
-	  else
-	  {
-		  tmpgroup[item.ns_][item.class_][item.method_] = item;
-	  }
-
-      auto& rs = tmpgroup[item.ns_][item.class_][item.method_];
-      for (auto& ms : rs.structs_)
+      const FlatRoute& route = schema.route(i);
+      if (route.is_push_)
       {
-          std::string olename = ms.second.name_;
-          ms.second.name_ = item.method_ + "_" + ms.second.name_;
-          for (auto& mv : rs.vars_)
-          { 
-              if (olename.compare(mv.typename_) == 0)
-              {
-                  mv.typename_ = ms.second.name_;
-              }
-          }
+          events.push_back(&route);
+          continue;
+      }
+      auto& methods = tmpgroup[schema.str(route.ns_)][schema.str(route.class_)];
+      if (!methods.insert(std::make_pair(schema.str(route.method_), &route)).second)
+      {
+          return false;
       }
   }
 
-  std::string declcode;
-  if (!parser.opts.custom_ns.empty())
+  RouteIds ids;
+  const RouteIds* route_ids = nullptr;
+  if (parser.opts.route_ids)
+  {
+      if (!AssignRouteIds(parser, &ids))
+      {
+          return false;
+      }
+      route_ids = &ids;
+  }
+
+  size_t events_size = 256;
+  for (const FlatRoute* route : events)
+  {
+      events_size += EstimateCodeSize(parser, schema, route->request_);
+  }
+
+  // In one file mode everything is written into declcode, otherwise every
+  // handler class, ServerEvent and the codec helpers get a writer and a
+  // file of their own.
+  size_t decl_size = 0;
+  if (parser.opts.one_file)
+  {
+      decl_size = 16384 + events_size;
+      for (size_t i = 0; i < schema.routes_size(); ++i)
+      {
+          const FlatRoute& route = schema.route(i);
+          if (!route.is_push_)
+          {
+              decl_size += EstimateCodeSize(parser, schema, route.request_);
+          }
+          if (route.response_ >= 0)
+          {
+              decl_size += EstimateCodeSize(parser, schema, route.response_);
+          }
+      }
+  }
+  CodeWriter declcode(decl_size);
+  BeginNamespacedClass(parser, declcode);
+  if (parser.opts.binary_codec)
+  {
+      if (parser.opts.one_file)
+      {
+          GenProtoRuntime(declcode);
+      }
+      else
+      {
+          CodeWriter runtime(16384);
+          BeginNamespacedClass(parser, runtime);
+          GenProtoRuntime(runtime);
+          if (!SaveNamespacedClass(lang, parser, "ProtoRuntime", runtime, path))
+          {
+              return false;
+          }
+      }
+  }
+  if (parser.opts.stream_json || parser.opts.read_json)
+  {
+      if (parser.opts.one_file)
+      {
+          GenJsonRuntime(parser, declcode);
+      }
+      else
+      {
+          CodeWriter runtime(2048);
+          BeginNamespacedClass(parser, runtime);
+          GenJsonRuntime(parser, runtime);
+          if (!SaveNamespacedClass(lang, parser, "ProtoJson", runtime, path))
+          {
+              return false;
+          }
+      }
+  }
+  if (parser.opts.pooled)
+  {
+      if (parser.opts.one_file)
+      {
+          GenPoolRuntime(declcode);
+      }
+      else
+      {
+          CodeWriter runtime(2048);
+          BeginNamespacedClass(parser, runtime);
+          GenPoolRuntime(runtime);
+          if (!SaveNamespacedClass(lang, parser, "ProtoPool", runtime, path))
+          {
+              return false;
+          }
+      }
+  }
+  // Handler classes are independent: each one is emitted into its own
+  // writer on a worker thread, then the writers are saved or joined in
+  // group order so the output does not depend on the thread count.
+  struct ClassTask
   {
-      declcode += "namespace ";
-      declcode += parser.opts.custom_ns;
-      declcode += "{";
+      const std::string* ns;
+      const std::string* cls;
+      const G_BY_METHOD* methods;
+      CodeWriter code;
+  };
+  std::vector<ClassTask> tasks;
+  for (const auto& ns : tmpgroup)
+  {
+      for (const auto& cls : ns.second)
+      {
+          ClassTask task = { &ns.first, &cls.first, &cls.second, CodeWriter() };
+          tasks.push_back(std::move(task));
+      }
+  }
+  declcode.EndLine();
+  int depth = declcode.depth();
+  ParallelFor(tasks.size(), parser.opts.jobs, [&](size_t i) {
+      ClassTask& task = tasks[i];
+      size_t size = 1024;
+      for (const auto& method : *task.methods)
+      {
+          size += EstimateCodeSize(parser, schema, method.second->request_);
+      }
+      if (parser.opts.one_file)
+      {
+          task.code = CodeWriter(size, depth);
+      }
+      else
+      {
+          task.code = CodeWriter(size);
+          BeginNamespacedClass(parser, task.code);
+      }
+      GenClass(lang, parser, schema, *task.ns, *task.cls, *task.methods, route_ids, task.code);
+  });
+  for (auto& task : tasks)
+  {
+      if (parser.opts.one_file)
+      {
+          declcode.EndLine();
+          declcode.Append(task.code);
+          task.code = CodeWriter();
+      }
+      else if (!SaveNamespacedClass(lang, parser, *task.ns + "." + *task.cls, task.code, path))
+      {
+          return false;
+      }
   }
-  for (auto& ns : tmpgroup)
+  CodeWriter split_events;
+  if (!parser.opts.one_file)
   {
-	  declcode += "namespace ";
-	  declcode += ns.first;
-	  declcode += "{";
-	  for (auto& cls : ns.second)
-	  {
-		  declcode += "public class ";
-		  declcode += cls.first;
-		  declcode += "{";
-		  declcode += "public static PomeloClient pc = null;";
-
-		  for (auto& method : cls.second)
-		  {
-			  GenRootStruct(lang, parser, method.second, declcode);
-		  }
-		  declcode += "}";
-	  }
-	  declcode += "}";
+      split_events = CodeWriter(events_size);
+      BeginNamespacedClass(parser, split_events);
   }
-  declcode += "public class ServerEvent{public static PomeloClient pc = null;";
-  for (const auto& item : parser.event_structs_)
+  CodeWriter& eventcode = parser.opts.one_file ? declcode : split_events;
+  eventcode += "public class ServerEvent{public static PomeloClient pc = null;";
+  GenRouteIds(route_ids, schema, events, eventcode);
+  for (const FlatRoute* route : events)
   {
-      GenEventStruct(lang, parser, item, declcode);
+      GenEventStruct(lang, parser, schema, *route, route_ids, eventcode);
   }
-  declcode += "}";
-  if (!parser.opts.custom_ns.empty())
+  eventcode += "}";
+  if (!parser.opts.one_file)
   {
-      declcode += "}";
+      return SaveNamespacedClass(lang, parser, "ServerEvent", eventcode, path);
   }
-  Format(declcode, one_file_code);
-  return SaveClass(lang, parser, file_name, one_file_code,path, true, true);
+  return SaveNamespacedClass(lang, parser, file_name, declcode, path);
 }
 
 }  // namespace pomeloc
@@ -3,6 +3,7 @@
 
 #include "pomeloc/idl.h"
 #include "pomeloc/util.h"
+#include "pomeloc/stats.h"
 
 namespace pomeloc {
 
@@ -16,228 +17,475 @@ namespace pomeloc {
   TD(STRING, "string", string) \
   TD(MESSAGE,  "message",  message)
 
-    const char* const kTypeNames[] = {
-        "int32",
-        "uInt32",
-        "sInt32",
-        "float",
-        "double",
-        "string"
+    // The words of a proto key ("required int32 x", "message Vec3") are
+    // looked up with a single probe of a perfect hash over every keyword.
+    enum KeywordKind
+    {
+        kKeywordNone = 0,
+        kKeywordType,
+        kKeywordOpt,
+        kKeywordMessage,
     };
 
-    const char* const kOptionNames[] = {
-        "required",
-        "optional",
-        "repeated"
+    struct Keyword
+    {
+        const char* name_;
+        size_t size_;
+        KeywordKind kind_;
+        int value_;             // kType or MetaTypeOpt
     };
 
-#define GEN_LOOKUP_TABLE(name, type, max, strarr) \
-    static type name(const char* key) \
-    {\
-        for (int i = 0; i < max; ++i)\
-        {\
-            if (strcmp(strarr[i], key) == 0)\
-            {\
-                return (type)i;\
-            }\
-        }\
-        return max;\
-    }
-    GEN_LOOKUP_TABLE(LookupType, kType, kTypeNone, kTypeNames)
-    GEN_LOOKUP_TABLE(LookupOpt, MetaTypeOpt, kOptNone, kOptionNames)
+    // Collision free for the keywords below, which are 5 to 8 chars long.
+    constexpr size_t KeywordHash(const char* s, size_t sz)
+    {
+        return (static_cast<unsigned char>(s[0]) + 7 * static_cast<unsigned char>(s[2]) +
+            2 * static_cast<unsigned char>(s[sz - 1]) + sz) & 15;
+    }
 
-    inline CheckedError NoError() { return CheckedError(false); }
+    constexpr Keyword kKeywords[16] = {
+        { nullptr, 0, kKeywordNone, 0 },
+        { "uInt32", 6, kKeywordType, kuInt32 },
+        { "repeated", 8, kKeywordOpt, kRepeated },
+        { "message", 7, kKeywordMessage, 0 },
+        { nullptr, 0, kKeywordNone, 0 },
+        { "string", 6, kKeywordType, kstring },
+        { nullptr, 0, kKeywordNone, 0 },
+        { "double", 6, kKeywordType, kdouble },
+        { nullptr, 0, kKeywordNone, 0 },
+        { "required", 8, kKeywordOpt, kRequired },
+        { nullptr, 0, kKeywordNone, 0 },
+        { "optional", 8, kKeywordOpt, kOptional },
+        { "float", 5, kKeywordType, kfloat },
+        { nullptr, 0, kKeywordNone, 0 },
+        { "int32", 5, kKeywordType, kInt32 },
+        { "sInt32", 6, kKeywordType, ksInt32 },
+    };
 
-    CheckedError Parser::ParseVariable(std::unordered_map<std::string, MetaStruct>& lookupt,
-        std::vector<MetaVariable>& ret, const char* key, json& val)
+    constexpr bool KeywordsHashed(size_t i)
     {
-        std::vector<pomeloc::sslice> splits;
-        pomeloc::strslice(key, 0, splits, " ");
+        return i == 16 || ((!kKeywords[i].name_ ||
+            KeywordHash(kKeywords[i].name_, kKeywords[i].size_) == i) && KeywordsHashed(i + 1));
+    }
+    static_assert(KeywordsHashed(0), "a keyword is not in its hash slot");
 
-        if (!val.is_number_integer())
+    static KeywordKind LookupKeyword(const sslice& word, int* value)
+    {
+        if (word.sz < 5 || word.sz > 8)
         {
-            return Error("error grammar " + std::string(key));
+            return kKeywordNone;
         }
-        MetaVariable mv;
-        auto optType = LookupOpt(std::string(splits.at(0).ptr, splits.at(0).sz).c_str());
-        if (kOptNone == optType)
+        const Keyword& kw = kKeywords[KeywordHash(word.ptr, word.sz)];
+        if (kw.size_ != word.sz || memcmp(kw.name_, word.ptr, word.sz))
         {
-            return Error("error type opt " + std::string(splits.at(0).ptr, splits.at(0).sz));
+            return kKeywordNone;
         }
+        *value = kw.value_;
+        return kw.kind_;
+    }
 
-        auto type = LookupType(std::string(splits.at(1).ptr, splits.at(1).sz).c_str());
-        if (kTypeNone == type)
+    inline CheckedError NoError() { return CheckedError(false); }
+
+    inline std::string ToString(const sslice& s)
+    {
+        return std::string(s.ptr, s.sz);
+    }
+
+    // Tokenizer over the raw source. The proto files are plain JSON objects
+    // whose leaves are integers, so no DOM is ever built: the IR is filled
+    // directly while the tokens are read.
+
+    void Parser::SkipWhitespace()
+    {
+        while (cursor_ < end_)
         {
-            //if message type
-            auto itFind = lookupt.find(std::string(splits.at(1).ptr, splits.at(1).sz));
-            if (lookupt.end() == itFind)
+            char ch = *cursor_;
+            if (ch == '\n')
             {
-                return Error("error type " + std::string(splits.at(1).ptr, splits.at(1).sz));
+                ++line_;
             }
-            mv.typename_ = itFind->first;
-            type = kMessage;
+            else if (ch != ' ' && ch != '\t' && ch != '\r')
+            {
+                break;
+            }
+            ++cursor_;
         }
-        mv.name_ = std::string(splits.at(2).ptr, splits.at(2).sz);
-        mv.type_ = type;
-        mv.opt_ = optType;
-        mv.index_ = val;
-
-        ret.push_back(mv);
+    }
 
+    CheckedError Parser::Expect(char ch)
+    {
+        SkipWhitespace();
+        if (cursor_ >= end_ || *cursor_ != ch)
+        {
+            return Error(std::string("expecting '") + ch + "'");
+        }
+        ++cursor_;
         return NoError();
     }
 
-    CheckedError Parser::ParseStruct(std::unordered_map<std::string, MetaStruct>& lookupt, 
-        const char* key, json& val)
+    // Consumes ',' and returns true for another member, or consumes the
+    // closing '}' and returns false.
+    CheckedError Parser::NextMember(bool* more)
     {
-        if (!val.is_object())
+        SkipWhitespace();
+        if (cursor_ < end_ && *cursor_ == ',')
         {
-            return Error("error grammar " + std::string(key));
+            ++cursor_;
+            *more = true;
+            return NoError();
         }
-        MetaStruct ms;
-        std::vector<pomeloc::sslice> splits;
-        pomeloc::strslice(key, 0, splits, " ");
-        if (splits.size() != 2)
+        *more = false;
+        return Expect('}');
+    }
+
+    // Reads a string token. The slice points into the source unless the
+    // string has escapes, then it points into key_buf_ which the next key
+    // overwrites.
+    CheckedError Parser::ParseKey(sslice* key)
+    {
+        auto err = Expect('"');
+        if (err.Check())
         {
-            return Error("error grammar " + std::string(key));
+            return err;
         }
-        if (std::string(splits.at(0).ptr, splits.at(0).sz).compare("message") != 0)
+        const char* start = cursor_;
+        while (cursor_ < end_ && *cursor_ != '"' && *cursor_ != '\\')
         {
-            return Error("unknown declare key type, struct declare must be [message] key word"
-                + std::string(splits.at(0).ptr, splits.at(0).sz));
+            ++cursor_;
         }
-        ms.name_ = std::string(splits.at(1).ptr, splits.at(1).sz);
-        if (lookupt.end() != lookupt.find(ms.name_))
+        if (cursor_ < end_ && *cursor_ == '"')
         {
-            return Error("duplicate message name at same namespace " + ms.name_);
+            key->ptr = start;
+            key->sz = cursor_ - start;
+            ++cursor_;
+            return Expect(':');
         }
-        for (json::iterator it = val.begin();
-        it != val.end(); ++it)
+
+        key_buf_.assign(start, cursor_);
+        while (cursor_ < end_ && *cursor_ != '"')
         {
-            splits.clear();
-            pomeloc::strslice(it.key().c_str(), 0, splits, " ");
-            if (splits.size() == 2) //struct declare
+            char ch = *cursor_++;
+            if (ch != '\\')
             {
-                auto err = this->ParseStruct(ms.structs_, it.key().c_str(), it.value());
-                if (err.Check())
-                {
-                    return err;
-                }
+                key_buf_ += ch;
+                continue;
+            }
+            if (cursor_ >= end_)
+            {
+                break;
             }
-            else if (splits.size() == 3) //variable
+            switch (*cursor_++)
             {
-                auto err = this->ParseVariable(ms.structs_, ms.vars_, it.key().c_str(), it.value());
-                if (err.Check())
+            case '"': key_buf_ += '"'; break;
+            case '\\': key_buf_ += '\\'; break;
+            case '/': key_buf_ += '/'; break;
+            case 'b': key_buf_ += '\b'; break;
+            case 'f': key_buf_ += '\f'; break;
+            case 'n': key_buf_ += '\n'; break;
+            case 'r': key_buf_ += '\r'; break;
+            case 't': key_buf_ += '\t'; break;
+            case 'u':
+            {
+                if (end_ - cursor_ < 4)
                 {
-                    return err;
+                    return Error("invalid escape in string");
                 }
+                std::string hex(cursor_, 4);
+                cursor_ += 4;
+                ToUTF8(static_cast<uint32_t>(StringToUInt(hex.c_str(), 16)), &key_buf_);
             }
-            else
+            break;
+            default:
+                return Error("invalid escape in string");
+            }
+        }
+        if (cursor_ >= end_)
+        {
+            return Error("unterminated string");
+        }
+        ++cursor_;
+        key->ptr = key_buf_.c_str();
+        key->sz = key_buf_.size();
+        return Expect(':');
+    }
+
+    CheckedError Parser::ParseInteger(int32_t* val)
+    {
+        SkipWhitespace();
+        const char* start = cursor_;
+        if (cursor_ < end_ && *cursor_ == '-')
+        {
+            ++cursor_;
+        }
+        int64_t v = 0;
+        while (cursor_ < end_ && *cursor_ >= '0' && *cursor_ <= '9')
+        {
+            v = v * 10 + (*cursor_++ - '0');
+            if (v > 0x7FFFFFFF)
             {
-                return Error("error key " + it.key());
+                return Error("integer out of range");
             }
         }
-        lookupt[ms.name_] = ms;
+        if (cursor_ == start || (cursor_ == start + 1 && *start == '-') ||
+            (cursor_ < end_ && (*cursor_ == '.' || *cursor_ == 'e' || *cursor_ == 'E')))
+        {
+            return Error("expecting an integer");
+        }
+        *val = static_cast<int32_t>(*start == '-' ? -v : v);
         return NoError();
     }
 
-    CheckedError Parser::ParseRoot(std::vector<RootStruct>& rss, const char* key, json& val)
+    // Message typed fields may name a message declared later in the same
+    // object, so they are resolved once the whole object has been read.
+    CheckedError Parser::ResolveVariables(const std::map<std::string, MetaStruct>& lookupt,
+        std::vector<MetaVariable>& vars)
     {
-        RootStruct rs;
-        std::vector<pomeloc::sslice> splits;
-        pomeloc::strslice(key, 0, splits, ".");
-        if (splits.size() == 3)
+        for (auto& mv : vars)
         {
-            rs.ns_ = std::string(splits.at(0).ptr, splits.at(0).sz);
-            rs.class_ = std::string(splits.at(1).ptr, splits.at(1).sz);
-            rs.method_ = std::string(splits.at(2).ptr, splits.at(2).sz);
+            if (mv.type_ == kMessage && lookupt.find(mv.typename_) == lookupt.end())
+            {
+                return Error("error type " + mv.typename_);
+            }
         }
-        else
+        std::sort(vars.begin(), vars.end(),
+            [](const MetaVariable& l, const MetaVariable& r) -> bool {
+            return l.index_ < r.index_;
+        });
+        for (size_t i = 1; i < vars.size(); ++i)
         {
-            rs.method_ = key;
-            rs.is_event_ = true;
-            //return Error("error key name. " + std::string(key));
-            //return NoError(); //skip server method
+            if (vars[i - 1].index_ == vars[i].index_)
+            {
+                return Error("duplicate field index " + NumToString(vars[i].index_) +
+                    " " + vars[i].name_);
+            }
+        }
+        return NoError();
+    }
+
+    // Parses the members of a message object, the '{' is already consumed.
+    CheckedError Parser::ParseMembers(std::map<std::string, MetaStruct>& lookupt,
+        std::vector<MetaVariable>& vars)
+    {
+        SkipWhitespace();
+        if (cursor_ < end_ && *cursor_ == '}')
+        {
+            ++cursor_;
+            return ResolveVariables(lookupt, vars);
         }
-        rs.router_ = key;
-        
-        for (json::iterator it = val.begin();
-        it != val.end(); ++it)
+        for (bool more = true; more;)
         {
-            splits.clear();
-            pomeloc::strslice(it.key().c_str(), 0, splits, " ");
-            if (splits.size() == 2) //struct declare
+            sslice key;
+            auto err = ParseKey(&key);
+            if (err.Check())
             {
-                auto err =  this->ParseStruct(rs.structs_, it.key().c_str(), it.value());
-                if (err.Check())
-                {
-                    return err;
-                }
+                return err;
             }
-            else if (splits.size() == 3) //variable
+            sslice words[3];
+            size_t count = SplitWords(key.ptr, key.sz, ' ', words, 3);
+            if (count == 2) //struct declare
             {
-                auto err = this->ParseVariable(rs.structs_, rs.vars_, it.key().c_str(), it.value());
-                if (err.Check())
-                {
-                    return err;
-                }
+                err = this->ParseStruct(lookupt, key, words);
+            }
+            else if (count == 3) //variable
+            {
+                err = this->ParseVariable(vars, key, words);
             }
             else
             {
-                return Error("error key " + it.key());
+                return Error("error key " + ToString(key));
+            }
+            if (err.Check())
+            {
+                return err;
+            }
+            err = NextMember(&more);
+            if (err.Check())
+            {
+                return err;
             }
         }
+        return ResolveVariables(lookupt, vars);
+    }
 
-        std::sort(rs.vars_.begin(), rs.vars_.end(), 
-            [](const MetaVariable& l, const MetaVariable& r) -> bool {
-            return l.index_ < r.index_;
-        });
-        rss.push_back(rs);
+    // words holds the "opt type name" of the key.
+    CheckedError Parser::ParseVariable(std::vector<MetaVariable>& ret, const sslice& key,
+        const sslice* words)
+    {
+        ret.emplace_back();
+        MetaVariable& mv = ret.back();
+        auto err = ParseInteger(&mv.index_);
+        if (err.Check())
+        {
+            return Error("error grammar " + ToString(key));
+        }
+        int opt = 0;
+        if (LookupKeyword(words[0], &opt) != kKeywordOpt)
+        {
+            return Error("error type opt " + ToString(words[0]));
+        }
+
+        int type = 0;
+        if (LookupKeyword(words[1], &type) != kKeywordType)
+        {
+            //message type, checked in ResolveVariables
+            mv.typename_.assign(words[1].ptr, words[1].sz);
+            type = kMessage;
+        }
+        mv.name_.assign(words[2].ptr, words[2].sz);
+        mv.type_ = static_cast<kType>(type);
+        mv.opt_ = static_cast<MetaTypeOpt>(opt);
+        return NoError();
+    }
+
+    // words holds the "message name" of the key.
+    CheckedError Parser::ParseStruct(std::map<std::string, MetaStruct>& lookupt,
+        const sslice& key, const sslice* words)
+    {
+        MetaStruct ms;
+        int unused = 0;
+        if (LookupKeyword(words[0], &unused) != kKeywordMessage)
+        {
+            return Error("unknown declare key type, struct declare must be [message] key word"
+                + ToString(words[0]));
+        }
+        ms.name_.assign(words[1].ptr, words[1].sz);
+        if (lookupt.end() != lookupt.find(ms.name_))
+        {
+            return Error("duplicate message name at same namespace " + ms.name_);
+        }
+        auto err = Expect('{');
+        if (err.Check())
+        {
+            return Error("error grammar " + ToString(key));
+        }
+        err = ParseMembers(ms.structs_, ms.vars_);
+        if (err.Check())
+        {
+            return err;
+        }
+        std::string name = ms.name_;
+        lookupt[name] = std::move(ms);
+        return NoError();
+    }
+
+    CheckedError Parser::ParseRoot(std::vector<RootStruct>& rss, const sslice& key)
+    {
+        RootStruct rs;
+        sslice words[3];
+        if (SplitWords(key.ptr, key.sz, '.', words, 3) == 3)
+        {
+            rs.ns_ = ToString(words[0]);
+            rs.class_ = ToString(words[1]);
+            rs.method_ = ToString(words[2]);
+        }
+        else
+        {
+            rs.method_ = ToString(key);
+            rs.is_event_ = true;
+        }
+        rs.router_ = ToString(key);
+        rs.name_ = rs.method_;
+
+        auto err = Expect('{');
+        if (err.Check())
+        {
+            return Error("message data should be object type. " + rs.router_);
+        }
+        err = ParseMembers(rs.structs_, rs.vars_);
+        if (err.Check())
+        {
+            return err;
+        }
+        rss.push_back(std::move(rs));
         return NoError();
     }
 
     CheckedError Parser::Error(const std::string &msg) 
     {
-        error_ += "error: " + msg;
+        error_ += "error: line " + NumToString(line_) + ": " + msg;
         error_ += "\n";
         return CheckedError(true);
     }
 
     bool Parser::Parse(const char *source, const char *source_filename)
     {
-        return !this->DoParse(source, source_filename).Check();
+        return Parse(source, source ? strlen(source) : 0, source_filename);
     }
 
-    CheckedError Parser::DoParse(const char *source, const char *source_filename)
+    bool Parser::Parse(const char *source, size_t length, const char *source_filename)
+    {
+        return !this->DoParse(source, length, source_filename).Check();
+    }
+
+    CheckedError Parser::DoParse(const char *source, size_t length,
+        const char *source_filename)
     {
         if (!source || !source_filename)
         {
             return Error("invalidate argument.");
         }
-        json_content_ = json::parse(source);
-        if (json_content_.empty())
+        cursor_ = source;
+        end_ = source + length;
+        line_ = 1;
+
+        structs_.clear();
+        SkipWhitespace();
+        if (cursor_ >= end_ || *cursor_ != '{')
         {
-            return Error("parse error.  " + std::string(source_filename));
+            return Error("the root data must be object type. " + std::string(source_filename));
         }
-        if (!json_content_.is_object())
+        ++cursor_;
+        SkipWhitespace();
+        if (cursor_ < end_ && *cursor_ == '}')
         {
-            return Error("the root data must be object type. " + std::string(source_filename));
+            return Error("parse error.  " + std::string(source_filename));
         }
-
-        structs_.clear();
-        for (json::iterator it = json_content_.begin();
-        it != json_content_.end(); ++it)
+        for (bool more = true; more;)
         {
-            if (!(*it).is_object())
+            sslice key;
+            if (ParseKey(&key).Check() ||
+                this->ParseRoot(structs_, key).Check() ||
+                NextMember(&more).Check())
             {
-                return Error("message data should be object type. " + std::string(source_filename));
+                return Error("parse failed. " + std::string(source_filename));
             }
-            if (this->ParseRoot(structs_, it.key().c_str(), it.value()).Check())
+        }
+        SkipWhitespace();
+        if (cursor_ != end_)
+        {
+            return Error("unexpected data after the root object. " + std::string(source_filename));
+        }
+
+        // Keep routes in a stable order, generators rely on it.
+        std::sort(structs_.begin(), structs_.end(),
+            [](const RootStruct& l, const RootStruct& r) -> bool {
+            return l.router_ < r.router_;
+        });
+        for (size_t i = 1; i < structs_.size(); ++i)
+        {
+            if (structs_[i - 1].router_ == structs_[i].router_)
             {
-                return Error("parse failed. " + it.key());
+                return Error("duplicate route " + structs_[i].router_);
             }
         }
-       
         return NoError();
     }
+
+    bool SaveGeneratedFile(const Parser& parser, const std::string& filename,
+        const std::string& code, bool binary)
+    {
+        parser.generated_files_.push_back(filename);
+        if (parser.outputs_)
+        {
+            GeneratedFile file = { filename, code };
+            parser.outputs_->push_back(std::move(file));
+            return true;
+        }
+        std::string dir = StripFileName(filename);
+        if (!dir.empty()) EnsureDirExists(dir);
+        ScopedPhase phase(parser.stats_, kPhaseSave);
+        bool written = false;
+        if (!SaveFileIfChanged(filename.c_str(), code, binary, &written)) return false;
+        if (written) phase.AddBytes(code.size());
+        return true;
+    }
 }  // namespace 
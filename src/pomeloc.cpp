@@ -1,7 +1,22 @@
 #include "pomeloc/pomeloc.h"
 #include "pomeloc/idl.h"
+#include "pomeloc/compiler.h"
+#include "pomeloc/binary_schema.h"
 #include "pomeloc/util.h"
+#include "pomeloc/stats.h"
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
 #define POMELOC_VERSION "0.0.1 (" __DATE__ ")"
 const char* SERVER_PROTOS = "serverProtos.json";
@@ -31,6 +46,22 @@ const Generator generators[] =
         pomeloc::IDLOptions::kCSharp,
         "Generate C# classes for tables/structs"
     },
+    {
+        pomeloc::GenerateCpp,  nullptr, "--cpp", "C++",
+        pomeloc::IDLOptions::kCpp,
+        "Generate C++ structs with inline codecs"
+    },
+    {
+        pomeloc::GenerateBinarySchema,  nullptr, "--binary-schema", "binary schema",
+        pomeloc::IDLOptions::kMAX,
+        "Generate a precompiled .pbfs schema"
+    },
+    {
+        pomeloc::GenerateRouteDictionary,  nullptr, "--route-dict", "route dictionary",
+        pomeloc::IDLOptions::kMAX,
+        "Generate dictionary.json and pass numeric route codes,\n"
+        "                  see --routes"
+    },
 };
 
 const char *program_name = nullptr;
@@ -54,6 +85,33 @@ static void Error(const std::string &err, bool usage, bool show_exe_name)
             "  -o PATH         Prefix PATH to all generated files.\n"
             "  --version       Print the version number of flatc and exit.\n"
             "  --ns            Use custom namespace or empty\n"
+            "  --binary        Generate pomelo-protobuf Encode/Decode methods and\n"
+            "                  send and receive protobuf bytes\n"
+            "  --force         Regenerate even if the inputs are unchanged\n"
+            "  --split         Write one C# file per handler class and ServerEvent\n"
+            "  --pooled        Recycle C# results, events and nested messages\n"
+            "                  through static pools\n"
+            "  --value-structs Emit C# structs for nested messages of plain\n"
+            "                  numbers and strings\n"
+            "  --stream-json   Add C# WriteJson methods and send requests as\n"
+            "                  bytes written by one reused JsonWriter\n"
+            "  --read-json     Add C# ReadJson methods and read responses and\n"
+            "                  pushes from the JSON text with a JsonReader\n"
+            "  --routes FILE   Number the --route-dict codes from the server routes,\n"
+            "                  a json array of every handler route or the route\n"
+            "                  dictionary object of the handshake. Fails when a\n"
+            "                  client route is missing. Without it the client\n"
+            "                  protos must list every handler route of the servers\n"
+            "  -j N            Emit with N threads, defaults to the number of cores\n"
+            "  --client PATH   Add a client proto file, directory or glob of\n"
+            "                  fragments, may be repeated\n"
+            "  --server PATH   Same for the server protos\n"
+            "  --batch FILE    Compile every project of a json list of\n"
+            "                  {client, server, ns, output} in one run\n"
+            "  --watch         Stay resident and regenerate whenever an input\n"
+            "                  changes, until interrupted (Linux only)\n"
+            "  --stats         Print time, bytes and peak memory per compiler phase\n"
+            "  --stats-json    Same as --stats, printed as a json object\n"
             "Output files are named using the base file name of the input,\n"
             "and written to the current directory or the path given by -o.\n"
             "example: %s -n -o ./out %s %s.\n",
@@ -63,38 +121,832 @@ static void Error(const std::string &err, bool usage, bool show_exe_name)
     exit(1);
 }
 
-void ParseFile(std::string file, pomeloc::Parser* pp)
+// A precompiled schema written by --binary-schema.
+static bool IsBinarySchema(const std::string& file)
+{
+    return pomeloc::GetExtension(file) == pomeloc::kBinarySchemaExtension;
+}
+
+// Proto files shared by several projects of a batch are mapped, hashed
+// and parsed once. Entries are filled on first use, from any thread.
+class ProtoCache
+{
+public:
+    struct Entry
+    {
+        Entry() : hash(0), uses(0) {}
+
+        std::once_flag load_once;
+        std::once_flag parse_once;
+        pomeloc::MappedFile file;
+        uint64_t hash;              // of the contents
+        std::unique_ptr<pomeloc::Parser> parser;
+        std::string error;          // empty while loading and parsing succeed
+        int uses;                   // projects reading the file
+    };
+
+    ProtoCache() : retain_(false) {}
+
+    // Counts the projects of a file before any of them runs.
+    void AddUse(const std::string& file) { ++Lookup(file)->uses; }
+
+    // Keeps every parsed file for later runs, e.g. in watch mode.
+    void Retain() { retain_ = true; }
+
+    // Forgets a file that changed on disk, it is loaded and parsed again
+    // on its next use.
+    void Invalidate(const std::string& file)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(pomeloc::AbsolutePath(file));
+        if (it == entries_.end()) return;
+        int uses = it->second->uses;
+        it->second.reset(new Entry());
+        it->second->uses = uses;
+    }
+
+    Entry* Load(const std::string& file, pomeloc::Stats* stats)
+    {
+        Entry* entry = Lookup(file);
+        std::call_once(entry->load_once, [&]() {
+            pomeloc::ScopedPhase phase(stats, pomeloc::kPhaseLoad);
+            if (!entry->file.Open(file.c_str()))
+            {
+                entry->error = "unable to load file: " + file;
+                return;
+            }
+            // Check if file contains 0 bytes.
+            if (!IsBinarySchema(file) && memchr(entry->file.data(), 0, entry->file.size()))
+            {
+                entry->error = "input file appears to be binary: " + file;
+                return;
+            }
+            entry->hash = pomeloc::HashFnv1a64(entry->file.data(), entry->file.size());
+            phase.AddBytes(entry->file.size());
+        });
+        return entry;
+    }
+
+    Entry* Parse(const std::string& file, pomeloc::Stats* stats)
+    {
+        Entry* entry = Load(file, stats);
+        std::call_once(entry->parse_once, [&]() {
+            if (!entry->error.empty()) return;
+            pomeloc::ScopedPhase phase(stats, pomeloc::kPhaseParse);
+            entry->parser.reset(new pomeloc::Parser());
+            if (!entry->parser->Parse(entry->file.data(), entry->file.size(), file.c_str()))
+            {
+                entry->error = entry->parser->error_;
+                entry->parser.reset();
+                return;
+            }
+            phase.AddBytes(entry->file.size());
+        });
+        return entry;
+    }
+
+    // The routes of a parsed file, moved out when no other project needs
+    // them.
+    std::vector<pomeloc::RootStruct> TakeRoutes(Entry* entry) const
+    {
+        if (retain_ || entry->uses > 1) return entry->parser->structs_;
+        return std::move(entry->parser->structs_);
+    }
+
+private:
+    Entry* Lookup(const std::string& file)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::unique_ptr<Entry>& entry = entries_[pomeloc::AbsolutePath(file)];
+        if (!entry) entry.reset(new Entry());
+        return entry.get();
+    }
+
+    std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<Entry>> entries_;
+    bool retain_;
+};
+
+// The manifest remembers the hash of everything that went into the last
+// run (version, options, input files) and the hashes of the files it
+// produced, so an identical run can stop before parsing anything.
+static const char* const kManifestName = ".pomeloc.manifest";
+
+static std::string HashToString(uint64_t hash)
+{
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+    return buf;
+}
+
+static uint64_t HashOutputFile(const std::string& file)
+{
+    std::string contents;
+    if (!pomeloc::LoadFile(file.c_str(), true, &contents)) return 0;
+    return pomeloc::HashFnv1a64(contents);
+}
+
+static bool ManifestUpToDate(const std::string& manifest, uint64_t inputs)
+{
+    std::string contents;
+    if (!pomeloc::LoadFile(manifest.c_str(), false, &contents)) return false;
+    std::istringstream ss(contents);
+    std::string key, value;
+    if (!(ss >> key >> value) || key != "inputs" || value != HashToString(inputs))
+    {
+        return false;
+    }
+    // Outputs that were deleted or edited by hand are regenerated.
+    std::string hash, file;
+    size_t count = 0;
+    while (ss >> hash && std::getline(ss >> std::ws, file))
+    {
+        if (hash != HashToString(HashOutputFile(file))) return false;
+        ++count;
+    }
+    return count > 0;
+}
+
+static void SaveManifest(const std::string& manifest, uint64_t inputs,
+    const std::vector<std::string>& files)
+{
+    std::string contents = "inputs " + HashToString(inputs) + "\n";
+    for (const auto& file : files)
+    {
+        contents += HashToString(HashOutputFile(file)) + " " + file + "\n";
+    }
+    pomeloc::SaveFileIfChanged(manifest.c_str(), contents, false);
+}
+
+// The files a manifest lists as produced by the last run.
+static void ManifestFiles(const std::string& manifest, std::vector<std::string>* files)
+{
+    std::string contents;
+    if (!pomeloc::LoadFile(manifest.c_str(), false, &contents)) return;
+    std::istringstream ss(contents);
+    std::string line, hash, file;
+    std::getline(ss, line);
+    while (ss >> hash && std::getline(ss >> std::ws, file))
+    {
+        files->push_back(file);
+    }
+}
+
+struct IRCounts
+{
+    uint64_t routes;
+    uint64_t events;
+    uint64_t responses;
+    uint64_t messages;
+    uint64_t fields;
+};
+
+static void CountMessage(const pomeloc::MetaStruct& ms, IRCounts* counts)
+{
+    ++counts->messages;
+    counts->fields += ms.vars_.size();
+    for (const auto& item : ms.structs_)
+    {
+        CountMessage(item.second, counts);
+    }
+}
+
+static IRCounts CountIR(const pomeloc::Parser& pp)
+{
+    IRCounts counts = { 0, 0, 0, 0, 0 };
+    counts.routes = pp.structs_.size();
+    counts.events = pp.event_structs_.size();
+    counts.responses = pp.response_maps_.size();
+    for (const auto& rs : pp.structs_) CountMessage(rs, &counts);
+    for (const auto& rs : pp.event_structs_) CountMessage(rs, &counts);
+    for (const auto& item : pp.response_maps_) CountMessage(item.second, &counts);
+    return counts;
+}
+
+// project names the batch entry the stats belong to, empty otherwise.
+static void PrintStats(const pomeloc::Stats& stats, const IRCounts& ir, bool as_json,
+    const std::string& project)
+{
+    double total_ms = stats.total_seconds() * 1000;
+    uint64_t rss = pomeloc::PeakRssKb();
+    if (as_json)
+    {
+        json root = json::object();
+        if (!project.empty()) root["project"] = project;
+        json& phases = root["phases"];
+        for (int i = 0; i < pomeloc::kPhaseMAX; ++i)
+        {
+            const pomeloc::PhaseStats& ps = stats.phase(static_cast<pomeloc::Phase>(i));
+            json& item = phases[pomeloc::kPhaseNames[i]];
+            item["ms"] = ps.seconds_ * 1000;
+            item["calls"] = ps.calls_;
+            item["bytes"] = ps.bytes_;
+        }
+        root["total_ms"] = total_ms;
+        root["peak_rss_kb"] = rss;
+        json& nodes = root["ir"];
+        nodes["routes"] = ir.routes;
+        nodes["events"] = ir.events;
+        nodes["responses"] = ir.responses;
+        nodes["messages"] = ir.messages;
+        nodes["fields"] = ir.fields;
+        printf("%s\n", root.dump().c_str());
+        return;
+    }
+    if (!project.empty()) printf("project  %s\n", project.c_str());
+    printf("%-8s %10s %8s %12s\n", "phase", "ms", "calls", "bytes");
+    for (int i = 0; i < pomeloc::kPhaseMAX; ++i)
+    {
+        const pomeloc::PhaseStats& ps = stats.phase(static_cast<pomeloc::Phase>(i));
+        printf("%-8s %10.3f %8llu %12llu\n", pomeloc::kPhaseNames[i], ps.seconds_ * 1000,
+            static_cast<unsigned long long>(ps.calls_),
+            static_cast<unsigned long long>(ps.bytes_));
+    }
+    printf("%-8s %10.3f\n", "total", total_ms);
+    printf("peak rss %llu KB\n", static_cast<unsigned long long>(rss));
+    printf("ir       %llu routes, %llu events, %llu responses, %llu messages, %llu fields\n",
+        static_cast<unsigned long long>(ir.routes),
+        static_cast<unsigned long long>(ir.events),
+        static_cast<unsigned long long>(ir.responses),
+        static_cast<unsigned long long>(ir.messages),
+        static_cast<unsigned long long>(ir.fields));
+}
+
+// One client/server proto pair and where its code goes. Each side may be
+// split into fragments that are merged after parsing.
+struct Project
+{
+    std::vector<std::string> client_specs;  // files, directories or globs
+    std::vector<std::string> server_specs;
+    std::vector<std::string> client;        // the fragments they expand to
+    std::vector<std::string> server;        // may be empty
+    std::string filebase;               // names the generated files
+    std::string output_path;
+    pomeloc::IDLOptions opts;
+};
+
+struct ProjectResult
+{
+    std::string error;      // empty on success
+    pomeloc::Stats stats;
+    IRCounts counts;
+};
+
+const size_t num_generators = sizeof(generators) / sizeof(generators[0]);
+
+// Moves the routes of every fragment of one side into "routes", failing
+// on a route defined by two fragments.
+static bool MergeFragments(const ProtoCache& cache, const std::vector<std::string>& files,
+    const std::vector<ProtoCache::Entry*>& entries,
+    std::vector<pomeloc::RootStruct>* routes, std::string* error)
+{
+    std::vector<std::vector<pomeloc::RootStruct>> fragments;
+    fragments.reserve(entries.size());
+    for (auto* entry : entries) fragments.push_back(cache.TakeRoutes(entry));
+    return pomeloc::MergeFragments(fragments, files, routes, error);
+}
+
+// Parses every fragment of a project and merges them into the client
+// parser.
+static bool ParseAndMerge(const Project& project, const std::vector<std::string>& inputs,
+    ProtoCache* cache, pomeloc::Stats* stats, pomeloc::Parser* client, std::string* error)
+{
+    // Every fragment is parsed into a partial parser of its own. Stats
+    // are not thread safe, so parallel parses are charged as one phase.
+    std::vector<ProtoCache::Entry*> entries(inputs.size());
+    if (inputs.size() > 1 && project.opts.jobs > 1)
+    {
+        pomeloc::ScopedPhase phase(stats, pomeloc::kPhaseParse);
+        pomeloc::ParallelFor(inputs.size(), project.opts.jobs, [&](size_t i) {
+            entries[i] = cache->Parse(inputs[i], nullptr);
+        });
+        for (const auto* entry : entries) phase.AddBytes(entry->file.size());
+    }
+    else
+    {
+        for (size_t i = 0; i < inputs.size(); ++i)
+            entries[i] = cache->Parse(inputs[i], stats);
+    }
+    for (const auto* entry : entries)
+    {
+        if (!entry->error.empty())
+        {
+            *error = entry->error;
+            return false;
+        }
+    }
+
+    std::vector<pomeloc::RootStruct> server;
+    // The server routes are not used afterwards, so their definitions are
+    // moved into the client parser instead of copied.
+    pomeloc::ScopedPhase phase(stats, pomeloc::kPhaseMerge);
+    std::vector<ProtoCache::Entry*> server_entries(
+        entries.begin() + project.client.size(), entries.end());
+    entries.resize(project.client.size());
+    if (!MergeFragments(*cache, project.client, entries, &client->structs_, error) ||
+        !MergeFragments(*cache, project.server, server_entries, &server, error))
+    {
+        return false;
+    }
+    pomeloc::MergeServerRoutes(server, client);
+    return true;
+}
+
+// A precompiled schema already holds the merged routes, it is verified
+// in place and replaces parsing and merging.
+static bool LoadPrecompiled(ProtoCache* cache, const std::string& file,
+    pomeloc::Stats* stats, pomeloc::Parser* client, std::string* error)
+{
+    ProtoCache::Entry* entry = cache->Load(file, stats);
+    pomeloc::ScopedPhase phase(stats, pomeloc::kPhaseParse);
+    const reflection::Schema* schema =
+        pomeloc::VerifyBinarySchema(entry->file.data(), entry->file.size());
+    if (!schema)
+    {
+        *error = "invalid binary schema: " + file;
+        return false;
+    }
+    phase.AddBytes(entry->file.size());
+    return pomeloc::LoadBinarySchema(*schema, client, error);
+}
+
+// Loads, parses, merges and generates one project. Never exits, so a
+// batch keeps going when a project fails.
+static bool CompileProject(const Project& project, const bool* generator_enabled,
+    bool force, uint64_t base_hash, ProtoCache* cache, pomeloc::Stats* stats,
+    IRCounts* counts, std::string* error)
+{
+    IRCounts none = { 0, 0, 0, 0, 0 };
+    *counts = none;
+    std::vector<std::string> inputs(project.client);
+    inputs.insert(inputs.end(), project.server.begin(), project.server.end());
+
+    // The options, the outputs and the input contents feed the manifest
+    // hash on top of the command line.
+    uint64_t inputs_hash = base_hash;
+    {
+        std::string key = project.opts.custom_ns + '\0' + project.output_path + '\0';
+        inputs_hash = pomeloc::HashFnv1a64(key, inputs_hash);
+    }
+    for (const auto& file : inputs)
+    {
+        ProtoCache::Entry* entry = cache->Load(file, stats);
+        if (!entry->error.empty())
+        {
+            *error = entry->error;
+            return false;
+        }
+        inputs_hash = pomeloc::HashFnv1a64(file.c_str(), file.size() + 1, inputs_hash);
+        inputs_hash = pomeloc::HashFnv1a64(reinterpret_cast<const char*>(&entry->hash),
+            sizeof(entry->hash), inputs_hash);
+    }
+    std::string manifest = project.output_path + kManifestName;
+    {
+        pomeloc::ScopedPhase phase(stats, pomeloc::kPhaseLoad);
+        if (!force && ManifestUpToDate(manifest, inputs_hash)) return true;
+    }
+
+    pomeloc::Parser client(project.opts);
+    client.stats_ = stats;
+    bool precompiled = inputs.size() == 1 && IsBinarySchema(inputs[0]);
+    for (const auto& file : inputs)
+    {
+        if (!precompiled && IsBinarySchema(file))
+        {
+            *error = "a binary schema must be the only input: " + file;
+            return false;
+        }
+    }
+    if (precompiled)
+    {
+        if (!LoadPrecompiled(cache, project.client[0], stats, &client, error)) return false;
+    }
+    else if (!ParseAndMerge(project, inputs, cache, stats, &client, error))
+    {
+        return false;
+    }
+
+    const std::string& filebase = project.filebase;
+    if (client.opts.route_ids)
+    {
+        // Checked once up front, the generators only report a failure.
+        pomeloc::RouteIds ids;
+        std::string route_error;
+        if (!pomeloc::AssignRouteIds(client, &ids, &route_error))
+        {
+            *error = "unable to number the routes of " + filebase + ": " + route_error;
+            return false;
+        }
+    }
+    for (size_t i = 0; i < num_generators; ++i)
+    {
+        client.opts.lang = generators[i].lang;
+        if (generator_enabled[i])
+        {
+            pomeloc::EnsureDirExists(project.output_path);
+            pomeloc::ScopedPhase phase(stats, pomeloc::kPhaseEmit);
+            if (!generators[i].generate(client, project.output_path, filebase))
+            {
+                *error = std::string("Unable to generate ") +
+                    generators[i].lang_name +
+                    " for " +
+                    filebase;
+                return false;
+            }
+        }
+    }
+
+    {
+        pomeloc::ScopedPhase phase(stats, pomeloc::kPhaseSave);
+        SaveManifest(manifest, inputs_hash, client.generated_files_);
+    }
+    *counts = CountIR(client);
+    return true;
+}
+
+// Batch entries name files relative to the batch file.
+static std::string ResolvePath(const std::string& dir, const std::string& path)
+{
+    if (dir.empty() || path.empty() || strchr(pomeloc::PathSeparatorSet, path[0]) ||
+        (path.size() > 1 && path[1] == ':'))
+    {
+        return path;
+    }
+    return pomeloc::ConCatPathFileName(dir, path);
+}
+
+// A directory as batch entries compare it: absolute, without "." or ".."
+// parts and ending in a separator, also before it exists.
+static std::string CanonicalDir(const std::string& path)
+{
+    std::string abs = ResolvePath(pomeloc::AbsolutePath("."),
+        pomeloc::AbsolutePath(path.empty() ? "." : path));
+    std::vector<std::string> parts;
+    size_t begin = 0;
+    while (begin <= abs.size())
+    {
+        size_t end = abs.find_first_of(pomeloc::PathSeparatorSet, begin);
+        if (end == std::string::npos) end = abs.size();
+        std::string part = abs.substr(begin, end - begin);
+        if (part == "..")
+        {
+            if (!parts.empty()) parts.pop_back();
+        }
+        else if (!part.empty() && part != ".")
+        {
+            parts.push_back(part);
+        }
+        begin = end + 1;
+    }
+    std::string ret;
+    if (!abs.empty() && strchr(pomeloc::PathSeparatorSet, abs[0])) ret += pomeloc::kPathSeparator;
+    for (const auto& part : parts)
+    {
+        ret += part;
+        ret += pomeloc::kPathSeparator;
+    }
+    return ret;
+}
+
+static std::string CanonicalFile(const std::string& path)
+{
+    return CanonicalDir(pomeloc::StripFileName(path)) + pomeloc::StripPath(path);
+}
+
+// The files of the last compile of a project and its manifest. An output
+// directory can be, or be inside, an input directory, and these files are
+// not protos however a directory or glob matches them.
+static std::set<std::string> GeneratedFiles(const Project& project)
+{
+    std::string manifest = project.output_path + kManifestName;
+    std::vector<std::string> files;
+    ManifestFiles(manifest, &files);
+    files.push_back(manifest);
+    std::set<std::string> ret;
+    for (const auto& file : files) ret.insert(CanonicalFile(file));
+    return ret;
+}
+
+// Expands the file, directory and glob specs of a project into its
+// fragments. A single proto file names the output after itself.
+static bool ExpandInputs(Project* project, std::string* error)
+{
+    project->client.clear();
+    project->server.clear();
+    std::set<std::string> generated = GeneratedFiles(*project);
+    std::vector<std::string> found;
+    for (const auto* specs : { &project->client_specs, &project->server_specs })
+    {
+        auto& files = specs == &project->client_specs ? project->client : project->server;
+        for (const auto& spec : *specs)
+        {
+            found.clear();
+            pomeloc::ExpandInputPath(spec, &found);
+            size_t count = files.size();
+            for (const auto& file : found)
+            {
+                if (!generated.count(CanonicalFile(file))) files.push_back(file);
+            }
+            if (files.size() == count)
+            {
+                *error = "no proto files match: " + spec;
+                return false;
+            }
+        }
+    }
+    const std::vector<std::string>& specs = project->client_specs;
+    if (specs.size() == 1 && project->client.size() == 1 &&
+        project->client[0] == specs[0])
+    {
+        project->filebase = pomeloc::StripPath(pomeloc::StripExtension(specs[0]));
+    }
+    else
+    {
+        project->filebase = pomeloc::StripExtension(CLIENT_PROTOS);
+    }
+    return true;
+}
+
+// A batch entry names its inputs with a string or an array of strings.
+static bool BatchSpecs(const json& item, const char* key, const std::string& dir,
+    std::vector<std::string>* specs)
+{
+    if (!item.count(key)) return true;
+    const json& value = item[key];
+    if (value.is_string())
+    {
+        specs->push_back(ResolvePath(dir, value.get<std::string>()));
+        return true;
+    }
+    if (!value.is_array()) return false;
+    for (const auto& spec : value)
+    {
+        if (!spec.is_string()) return false;
+        specs->push_back(ResolvePath(dir, spec.get<std::string>()));
+    }
+    return true;
+}
+
+// A batch file is a json array of
+//   {"client": "...", "server": "...", "ns": "...", "output": "..."}
+// where only client and output are required and ns defaults to --ns.
+// client and server may also be arrays, and each path a directory or glob
+// of fragments.
+static void LoadBatch(const std::string& file, const pomeloc::IDLOptions& opts,
+    std::vector<Project>* projects)
 {
     std::string contents;
-    if (!pomeloc::LoadFile(file.c_str(), true, &contents))
+    if (!pomeloc::LoadFile(file.c_str(), false, &contents))
         Error("unable to load file: " + file);
+    json root;
+    try
+    {
+        root = json::parse(contents);
+    }
+    catch (const std::exception& e)
+    {
+        Error("invalid batch file " + file + ": " + e.what());
+    }
+    if (!root.is_array()) Error("batch file must be a json array: " + file);
+    std::string dir = pomeloc::StripFileName(file);
+    // Every project keeps its manifest and outputs in its own directory,
+    // two projects in one would overwrite each other and fool the
+    // unchanged check of the other.
+    std::set<std::string> outputs;
+    for (const auto& item : root)
+    {
+        Project project;
+        if (!item.is_object() || !BatchSpecs(item, "client", dir, &project.client_specs) ||
+            project.client_specs.empty() ||
+            !BatchSpecs(item, "server", dir, &project.server_specs) ||
+            !item.count("output") || !item["output"].is_string())
+        {
+            Error("batch entry needs client and output strings: " + item.dump());
+        }
+        project.opts = opts;
+        if (item.count("ns") && item["ns"].is_string())
+            project.opts.custom_ns = item["ns"].get<std::string>();
+        project.output_path = pomeloc::ConCatPathFileName(
+            ResolvePath(dir, item["output"].get<std::string>()), "");
+        std::string error;
+        if (!ExpandInputs(&project, &error)) Error(error);
+        if (!outputs.insert(CanonicalDir(project.output_path)).second)
+            Error("batch entries share the output " + item["output"].get<std::string>());
+        projects->push_back(project);
+    }
+}
+
+// Settings shared by every compile of a run.
+struct Session
+{
+    const bool* generator_enabled;
+    bool force;
+    uint64_t inputs_hash;       // base of the manifest hashes
+    int jobs;
+    bool print_stats;
+    bool stats_json;
+    bool batch;
+    ProtoCache cache;
+};
 
-    // Check if file contains 0 bytes.
-    if (contents.length() != strlen(contents.c_str()))
+// Compiles the projects listed in "which" concurrently and reports their
+// errors and stats. Returns the exit code.
+static int RunProjects(Session* session, const std::vector<Project>& projects,
+    const std::vector<size_t>& which)
+{
+    std::vector<ProjectResult> results(which.size());
+    pomeloc::ParallelFor(which.size(), session->jobs, [&](size_t i) {
+        ProjectResult& result = results[i];
+        result.stats = pomeloc::Stats();
+        CompileProject(projects[which[i]], session->generator_enabled, session->force,
+            session->inputs_hash, &session->cache,
+            session->print_stats ? &result.stats : nullptr, &result.counts,
+            &result.error);
+        result.stats.Stop();
+    });
+
+    int ret = 0;
+    for (size_t i = 0; i < which.size(); ++i)
     {
-        Error("input file appears to be binary: " + file, true);
+        if (!results[i].error.empty())
+        {
+            std::string err = results[i].error;
+            while (!err.empty() && err[err.size() - 1] == '\n') err.erase(err.size() - 1);
+            printf("%s: %s\n", program_name, err.c_str());
+            ret = 1;
+        }
+        else if (session->print_stats)
+        {
+            PrintStats(results[i].stats, results[i].counts, session->stats_json,
+                session->batch ? projects[which[i]].output_path : "");
+        }
+    }
+    return ret;
+}
+
+#ifdef __linux__
+// Directories whose changes can affect a project: the directories of its
+// files, the directories it names and the directory part of its globs.
+static std::set<std::string> WatchedDirs(const Project& project)
+{
+    std::set<std::string> dirs;
+    for (const auto* specs : { &project.client_specs, &project.server_specs })
+    {
+        for (const auto& spec : *specs)
+        {
+            std::string dir = pomeloc::DirExists(spec.c_str())
+                ? spec : pomeloc::StripFileName(spec);
+            dirs.insert(pomeloc::AbsolutePath(dir.empty() ? "." : dir));
+        }
     }
+    return dirs;
+}
+
+// Regenerates the projects affected by every burst of changes until the
+// process is interrupted. Directories rather than files are watched, so
+// editors that save by renaming and new or deleted fragments are seen.
+static int Watch(Session* session, std::vector<Project>& projects)
+{
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0) Error("unable to start watching: inotify_init1 failed");
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+        IN_CREATE | IN_DELETE;
+    std::map<int, std::string> watches;
+    std::vector<std::set<std::string>> project_dirs;
+    for (const auto& project : projects)
+    {
+        project_dirs.push_back(WatchedDirs(project));
+        for (const auto& dir : project_dirs.back())
+        {
+            int wd = inotify_add_watch(fd, dir.c_str(), mask);
+            if (wd < 0) Error("unable to watch directory: " + dir);
+            watches[wd] = dir;
+        }
+    }
+    session->force = false;
+    printf("watching %zu director%s, press Ctrl-C to stop\n", watches.size(),
+        watches.size() == 1 ? "y" : "ies");
+    fflush(stdout);
+
+    alignas(inotify_event) char buf[16 * 1024];
+    for (;;)
+    {
+        // Block for the first event, then gather the rest of the burst
+        // (an editor save is several events) before rebuilding once.
+        std::set<std::pair<std::string, std::string>> changed;
+        int timeout = -1;
+        for (;;)
+        {
+            pollfd pfd = { fd, POLLIN, 0 };
+            int ready = poll(&pfd, 1, timeout);
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready <= 0) break;
+            ssize_t len = read(fd, buf, sizeof(buf));
+            if (len <= 0) break;
+            for (char* p = buf; p < buf + len; )
+            {
+                const inotify_event* ev = reinterpret_cast<const inotify_event*>(p);
+                auto it = watches.find(ev->wd);
+                if (it != watches.end() && ev->len && !(ev->mask & IN_ISDIR))
+                    changed.insert(std::make_pair(it->second, std::string(ev->name)));
+                p += sizeof(inotify_event) + ev->len;
+            }
+            timeout = 20;
+        }
+
+        std::vector<size_t> dirty;
+        for (size_t i = 0; i < projects.size(); ++i)
+        {
+            Project& project = projects[i];
+            // Writing the outputs into a watched directory is not a change.
+            std::set<std::string> generated = GeneratedFiles(project);
+            bool affected = false;
+            for (const auto& item : changed)
+            {
+                if (project_dirs[i].count(item.first) && !generated.count(
+                    CanonicalFile(pomeloc::ConCatPathFileName(item.first, item.second))))
+                {
+                    affected = true;
+                }
+            }
+            if (!affected) continue;
+            std::vector<std::string> client = project.client;
+            std::vector<std::string> server = project.server;
+            std::string error;
+            if (!ExpandInputs(&project, &error))
+            {
+                printf("%s: %s\n", program_name, error.c_str());
+                continue;
+            }
+            bool rebuild = client != project.client || server != project.server;
+            for (const auto* files : { &project.client, &project.server })
+            {
+                for (const auto& file : *files)
+                {
+                    std::string path = pomeloc::AbsolutePath(file);
+                    if (changed.count(std::make_pair(pomeloc::StripFileName(path),
+                        pomeloc::StripPath(path))))
+                    {
+                        rebuild = true;
+                    }
+                }
+            }
+            if (rebuild) dirty.push_back(i);
+        }
+        for (const auto& item : changed)
+        {
+            session->cache.Invalidate(pomeloc::ConCatPathFileName(item.first, item.second));
+        }
+        if (dirty.empty()) continue;
 
-    if (!pp->Parse(contents.c_str(), file.c_str()))
-        Error(pp->error_, false, false);
+        pomeloc::Stats timer;
+        if (!RunProjects(session, projects, dirty))
+        {
+            for (size_t i : dirty)
+            {
+                printf("regenerated %s%s in %.1f ms\n", projects[i].output_path.c_str(),
+                    projects[i].filebase.c_str(), timer.total_seconds() * 1000);
+            }
+        }
+        fflush(stdout);
+    }
 }
+#endif
 
 int main(int argc, const char *argv[])
 {
     program_name = argv[0];
     pomeloc::IDLOptions opts;
+    opts.jobs = pomeloc::DefaultJobs();
     std::string output_path;
-    const size_t num_generators = sizeof(generators) / sizeof(generators[0]);
+    std::string batch_file;
     bool generator_enabled[num_generators] =
     { false };
     bool any_generator = false;
-    bool raw_binary = false;
-    bool schema_binary = false;
+    bool force = false;
+    bool print_stats = false;
+    bool stats_json = false;
+    bool watch = false;
     std::vector<std::string> filenames;
+    std::vector<std::string> client_specs;
+    std::vector<std::string> server_specs;
+    std::string routes_file;
     std::vector<const char *> include_directories;
+    // The command line (but --force, -j, --watch and the stats flags) is the base of
+    // every project's manifest hash.
+    uint64_t inputs_hash = pomeloc::HashFnv1a64(POMELOC_VERSION);
     for (int argi = 1; argi < argc; argi++)
     {
         std::string arg = argv[argi];
+        if (arg == "-j" && argi + 1 < argc)
+        {
+            opts.jobs = atoi(argv[++argi]);
+            if (opts.jobs < 1) Error("invalid job count: " + std::string(argv[argi]), true);
+            continue;
+        }
+        if (arg != "--force" && arg != "--stats" && arg != "--stats-json" &&
+            arg != "--watch")
+            inputs_hash = pomeloc::HashFnv1a64(arg.c_str(), arg.size() + 1, inputs_hash);
         if (arg[0] == '-')
         {
             if (filenames.size() && arg[1] != '-')
@@ -114,6 +966,66 @@ int main(int argc, const char *argv[])
                 if (++argi >= argc) Error("missing namespace following: " + arg, true);
                 opts.custom_ns = argv[argi];
             }
+            else if (arg == "--binary")
+            {
+                opts.binary_codec = true;
+            }
+            else if (arg == "--pooled")
+            {
+                opts.pooled = true;
+            }
+            else if (arg == "--value-structs")
+            {
+                opts.value_structs = true;
+            }
+            else if (arg == "--stream-json")
+            {
+                opts.stream_json = true;
+            }
+            else if (arg == "--read-json")
+            {
+                opts.read_json = true;
+            }
+            else if (arg == "--routes")
+            {
+                if (++argi >= argc) Error("missing file following: " + arg, true);
+                routes_file = argv[argi];
+            }
+            else if (arg == "--split")
+            {
+                opts.one_file = false;
+            }
+            else if (arg == "--force")
+            {
+                force = true;
+            }
+            else if (arg == "--client" || arg == "--server")
+            {
+                if (++argi >= argc) Error("missing path following: " + arg, true);
+                (arg == "--client" ? client_specs : server_specs).push_back(argv[argi]);
+            }
+            else if (arg == "--batch")
+            {
+                if (++argi >= argc) Error("missing file following: " + arg, true);
+                batch_file = argv[argi];
+            }
+            else if (arg == "--watch")
+            {
+#ifdef __linux__
+                watch = true;
+#else
+                Error("--watch is only supported on Linux", true);
+#endif
+            }
+            else if (arg == "--stats")
+            {
+                print_stats = true;
+            }
+            else if (arg == "--stats-json")
+            {
+                print_stats = true;
+                stats_json = true;
+            }
             else
             {
                 for (size_t i = 0; i < num_generators; ++i)
@@ -152,66 +1064,75 @@ int main(int argc, const char *argv[])
             }
         }
     }
-
-    if (!filenames.size()) Error("missing input files", false, true);
-    if (!any_generator)
+    // The code generators use the codes the dictionary assigns.
+    for (size_t i = 0; i < num_generators; ++i)
     {
-        Error("no options: specify at least one generator.", true);
+        if (generator_enabled[i] && generators[i].generate == pomeloc::GenerateRouteDictionary)
+            opts.route_ids = true;
+    }
+    if (!routes_file.empty())
+    {
+        if (!opts.route_ids) Error("--routes needs --route-dict", true);
+        std::string contents, error;
+        if (!pomeloc::LoadFile(routes_file.c_str(), false, &contents))
+            Error("unable to load file: " + routes_file);
+        auto routes = std::make_shared<pomeloc::ServerRoutes>();
+        if (!pomeloc::ParseServerRoutes(contents, routes.get(), &error))
+            Error("invalid server routes " + routes_file + ": " + error);
+        opts.server_routes = routes;
+        inputs_hash = pomeloc::HashFnv1a64(contents, inputs_hash);
     }
 
-    // Now process the files:
-    pomeloc::Parser* parserClient = new pomeloc::Parser(opts);
-    pomeloc::Parser* parserServer = new pomeloc::Parser(opts);
-    std::string file;
-    if (filenames.size() > 1)
+    std::vector<Project> projects;
+    if (!batch_file.empty())
     {
-        ParseFile(filenames.at(1), parserServer);
-        ParseFile(filenames.at(0), parserClient);
-        file = filenames.at(0);
+        if (filenames.size() || client_specs.size() || server_specs.size())
+            Error("input files and --batch are exclusive", true);
+        LoadBatch(batch_file, opts, &projects);
     }
     else
     {
-        ParseFile(filenames.at(0), parserClient);
-        file = filenames.at(0);
+        if (filenames.size() > 0) client_specs.insert(client_specs.begin(), filenames[0]);
+        if (filenames.size() > 1) server_specs.insert(server_specs.begin(), filenames[1]);
+        if (!client_specs.size()) Error("missing input files", false, true);
+        Project project;
+        project.client_specs = client_specs;
+        project.server_specs = server_specs;
+        project.output_path = output_path;
+        std::string error;
+        if (!ExpandInputs(&project, &error)) Error(error);
+        project.opts = opts;
+        projects.push_back(project);
     }
-
-    for (auto& item : parserServer->structs_)
+    if (!any_generator)
     {
-        if (item.is_event_)
-        {
-            parserClient->event_structs_.push_back(item);
-        }
-        else
-        {
-            pomeloc::MetaStruct ms;
-            std::string name = item.router_;
-            ms.name_ = name.substr(name.find_last_of('.') + 1);
-            ms.name_ += "_result";
-            ms.structs_ = item.structs_;
-            ms.vars_ = item.vars_;
-            parserClient->response_maps_[name] = ms;
-        }
+        Error("no options: specify at least one generator.", true);
     }
-    
-    std::string filebase = pomeloc::StripPath(
-        pomeloc::StripExtension(file));
-    for (size_t i = 0; i < num_generators; ++i)
+
+    // Projects run concurrently and share the inputs they have in common.
+    // Each one then emits on a single thread so the cores are not
+    // oversubscribed.
+    Session session;
+    session.generator_enabled = generator_enabled;
+    session.force = force;
+    session.inputs_hash = inputs_hash;
+    session.jobs = opts.jobs;
+    session.print_stats = print_stats;
+    session.stats_json = stats_json;
+    session.batch = !batch_file.empty();
+    if (watch) session.cache.Retain();
+    std::vector<size_t> all(projects.size());
+    for (size_t i = 0; i < projects.size(); ++i)
     {
-        parserClient->opts.lang = generators[i].lang;
-        if (generator_enabled[i])
-        {
-            pomeloc::EnsureDirExists(output_path);
-            if (!generators[i].generate(*parserClient, output_path, filebase))
-            {
-                Error(std::string("Unable to generate ") +
-                    generators[i].lang_name +
-                    " for " +
-                    filebase);
-            }
-        }
+        Project& project = projects[i];
+        for (const auto& file : project.client) session.cache.AddUse(file);
+        for (const auto& file : project.server) session.cache.AddUse(file);
+        if (projects.size() > 1) project.opts.jobs = 1;
+        all[i] = i;
     }
-
-    delete parserClient;
-    delete parserServer;
-    return 0;
+    int ret = RunProjects(&session, projects, all);
+#ifdef __linux__
+    if (watch) return Watch(&session, projects);
+#endif
+    return ret;
 }
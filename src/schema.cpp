@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <cstring>
+
+#include "pomeloc/schema.h"
+#include "pomeloc/util.h"
+
+namespace pomeloc {
+
+    Arena::Arena(size_t block_size, const simple_allocator* allocator)
+        : allocator_(allocator ? *allocator : default_allocator_),
+          block_size_(block_size),
+          head_(nullptr),
+          cur_(nullptr),
+          end_(nullptr),
+          used_(0),
+          reserved_(0)
+    {
+    }
+
+    Arena::~Arena()
+    {
+        Reset();
+    }
+
+    void* Arena::Allocate(size_t size, size_t align)
+    {
+        uintptr_t p = (reinterpret_cast<uintptr_t>(cur_) + (align - 1)) & ~(align - 1);
+        if (!cur_ || p + size > reinterpret_cast<uintptr_t>(end_))
+        {
+            // Oversized requests get a block of their own.
+            size_t header = (sizeof(Block) + AlignOf<largest_scalar_t>() - 1) &
+                ~(AlignOf<largest_scalar_t>() - 1);
+            size_t len = (std::max)(block_size_, header + size + align);
+            uint8_t* buf = allocator_.allocate(len);
+            Block* block = reinterpret_cast<Block*>(buf);
+            block->next_ = head_;
+            head_ = block;
+            cur_ = buf + header;
+            end_ = buf + len;
+            reserved_ += len;
+            p = (reinterpret_cast<uintptr_t>(cur_) + (align - 1)) & ~(align - 1);
+        }
+        cur_ = reinterpret_cast<uint8_t*>(p + size);
+        used_ += size;
+        return reinterpret_cast<void*>(p);
+    }
+
+    void Arena::Reset()
+    {
+        while (head_)
+        {
+            Block* next = head_->next_;
+            allocator_.deallocate(reinterpret_cast<uint8_t*>(head_));
+            head_ = next;
+        }
+        cur_ = end_ = nullptr;
+        used_ = reserved_ = 0;
+    }
+
+    // Upper bounds of everything a schema needs, so each array is
+    // allocated exactly once.
+    struct SchemaCounts
+    {
+        size_t messages_;
+        size_t fields_;
+        size_t strings_;
+        size_t bytes_;
+
+        void AddString(const std::string& s)
+        {
+            ++strings_;
+            bytes_ += s.size() + 1;
+        }
+
+        void AddMessage(const std::string& name, const MetaStruct& ms)
+        {
+            ++messages_;
+            AddString(name);
+            fields_ += ms.vars_.size();
+            for (const auto& mv : ms.vars_)
+            {
+                AddString(mv.name_);
+            }
+            for (const auto& item : ms.structs_)
+            {
+                AddMessage(item.second.name_, item.second);
+            }
+        }
+
+        void AddRoute(const RootStruct& rs)
+        {
+            AddString(rs.router_);
+            AddString(rs.ns_);
+            AddString(rs.class_);
+            AddString(rs.method_);
+            AddMessage(rs.name_, rs);
+        }
+    };
+
+    FlatSchema::FlatSchema(const simple_allocator* allocator)
+        : arena_(4096, allocator)
+    {
+        Clear();
+    }
+
+    void FlatSchema::Clear()
+    {
+        arena_.Reset();
+        messages_ = nullptr;
+        fields_ = nullptr;
+        routes_ = nullptr;
+        pool_ = nullptr;
+        intern_ = nullptr;
+        messages_size_ = 0;
+        fields_size_ = 0;
+        routes_size_ = 0;
+        pool_size_ = 0;
+        intern_mask_ = 0;
+        error_.clear();
+    }
+
+    bool FlatSchema::Error(const std::string& msg)
+    {
+        error_ = "error: " + msg;
+        return false;
+    }
+
+    uint32_t FlatSchema::Intern(const std::string& s)
+    {
+        size_t slot = static_cast<size_t>(HashFnv1a64(s)) & intern_mask_;
+        for (;; slot = (slot + 1) & intern_mask_)
+        {
+            uint32_t entry = intern_[slot];
+            if (!entry)
+            {
+                break;
+            }
+            const char* str = pool_ + entry - 1;
+            if (!strncmp(str, s.c_str(), s.size()) && !str[s.size()])
+            {
+                return entry - 1;
+            }
+        }
+        uint32_t offset = static_cast<uint32_t>(pool_size_);
+        memcpy(pool_ + pool_size_, s.c_str(), s.size() + 1);
+        pool_size_ += s.size() + 1;
+        intern_[slot] = offset + 1;
+        return offset;
+    }
+
+    int32_t FlatSchema::LookupRoute(const std::string& router) const
+    {
+        size_t lo = 0, hi = routes_size_;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            int cmp = strcmp(str(routes_[mid].router_), router.c_str());
+            if (!cmp)
+            {
+                return static_cast<int32_t>(mid);
+            }
+            if (cmp < 0)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return -1;
+    }
+
+    // Reserves the message and its field range, the fields themselves and
+    // the nested messages are written by FillMessage.
+    int32_t FlatSchema::AddMessage(const std::string& name, const MetaStruct& ms,
+        int32_t parent)
+    {
+        int32_t id = static_cast<int32_t>(messages_size_++);
+        FlatMessage& msg = messages_[id];
+        msg.name_ = Intern(name);
+        msg.parent_ = parent;
+        msg.fields_begin_ = static_cast<uint32_t>(fields_size_);
+        msg.fields_size_ = static_cast<uint32_t>(ms.vars_.size());
+        msg.nested_begin_ = 0;
+        msg.nested_size_ = 0;
+        fields_size_ += ms.vars_.size();
+        return id;
+    }
+
+    bool FlatSchema::FillMessage(int32_t id, const MetaStruct& ms)
+    {
+        // Siblings first so they stay adjacent, then their subtrees.
+        uint32_t nested_begin = static_cast<uint32_t>(messages_size_);
+        for (const auto& item : ms.structs_)
+        {
+            AddMessage(item.second.name_, item.second, id);
+        }
+        FlatMessage& msg = messages_[id];
+        msg.nested_begin_ = nested_begin;
+        msg.nested_size_ = static_cast<uint32_t>(ms.structs_.size());
+
+        FlatField* field = fields_ + msg.fields_begin_;
+        for (const auto& mv : ms.vars_)
+        {
+            field->index_ = mv.index_;
+            field->opt_ = mv.opt_;
+            field->type_ = mv.type_;
+            field->message_ = -1;
+            field->name_ = Intern(mv.name_);
+            if (mv.type_ == kMessage)
+            {
+                uint32_t type = Intern(mv.typename_);
+                for (uint32_t i = 0; i < msg.nested_size_; ++i)
+                {
+                    if (messages_[nested_begin + i].name_ == type)
+                    {
+                        field->message_ = static_cast<int32_t>(nested_begin + i);
+                        break;
+                    }
+                }
+                if (field->message_ < 0)
+                {
+                    return Error("unknown message type " + mv.typename_ + " in " +
+                        str(msg.name_));
+                }
+            }
+            ++field;
+        }
+
+        uint32_t i = 0;
+        for (const auto& item : ms.structs_)
+        {
+            if (!FillMessage(static_cast<int32_t>(nested_begin + i++), item.second))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool FlatSchema::AddRoute(const RootStruct& rs, int32_t response, bool is_push)
+    {
+        int32_t request = AddMessage(rs.name_, rs, -1);
+        if (!FillMessage(request, rs))
+        {
+            return false;
+        }
+        FlatRoute& route = routes_[routes_size_++];
+        route.router_ = Intern(rs.router_);
+        route.ns_ = Intern(rs.ns_);
+        route.class_ = Intern(rs.class_);
+        route.method_ = Intern(rs.method_);
+        route.request_ = request;
+        route.response_ = response;
+        route.is_event_ = rs.is_event_;
+        route.is_push_ = is_push;
+        return true;
+    }
+
+    bool FlatSchema::Build(const Parser& parser)
+    {
+        Clear();
+
+        SchemaCounts counts = { 0, 0, 0, 0 };
+        for (const auto& rs : parser.structs_)
+        {
+            counts.AddRoute(rs);
+        }
+        for (const auto& rs : parser.event_structs_)
+        {
+            counts.AddRoute(rs);
+        }
+        for (const auto& item : parser.response_maps_)
+        {
+            counts.AddMessage(item.second.name_, item.second);
+        }
+        size_t routes = parser.structs_.size() + parser.event_structs_.size();
+        size_t capacity = 16;
+        while (capacity < counts.strings_ * 2)
+        {
+            capacity <<= 1;
+        }
+
+        messages_ = arena_.AllocateArray<FlatMessage>(counts.messages_);
+        fields_ = arena_.AllocateArray<FlatField>(counts.fields_);
+        routes_ = arena_.AllocateArray<FlatRoute>(routes);
+        pool_ = arena_.AllocateArray<char>(counts.bytes_);
+        intern_ = arena_.AllocateArray<uint32_t>(capacity);
+        memset(intern_, 0, capacity * sizeof(uint32_t));
+        intern_mask_ = capacity - 1;
+
+        for (const auto& rs : parser.structs_)
+        {
+            int32_t response = -1;
+            auto it = parser.response_maps_.find(rs.router_);
+            if (!rs.is_event_ && it != parser.response_maps_.end())
+            {
+                response = AddMessage(it->second.name_, it->second, -1);
+                if (!FillMessage(response, it->second))
+                {
+                    return false;
+                }
+            }
+            if (!AddRoute(rs, response, false))
+            {
+                return false;
+            }
+        }
+        for (const auto& rs : parser.event_structs_)
+        {
+            if (!AddRoute(rs, -1, true))
+            {
+                return false;
+            }
+        }
+
+        std::sort(routes_, routes_ + routes_size_,
+            [this](const FlatRoute& l, const FlatRoute& r) -> bool {
+            return strcmp(str(l.router_), str(r.router_)) < 0;
+        });
+        for (size_t i = 1; i < routes_size_; ++i)
+        {
+            if (routes_[i - 1].router_ == routes_[i].router_)
+            {
+                return Error(std::string("duplicate route ") + str(routes_[i].router_));
+            }
+        }
+        return true;
+    }
+
+}  // namespace pomeloc
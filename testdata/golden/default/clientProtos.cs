@@ -0,0 +1,1509 @@
+using System;
+using LitJson;
+using Pomelo.DotNetClient;
+[System.Runtime.InteropServices.StructLayout(System.Runtime.InteropServices.LayoutKind.Explicit)]public struct ProtoBits
+{
+    [System.Runtime.InteropServices.FieldOffset(0)]public float f;
+    [System.Runtime.InteropServices.FieldOffset(0)]public uint u;
+}
+public class ProtoWriter
+{
+    public byte[] buffer;
+    public int position;
+    [System.ThreadStatic]static ProtoWriter shared;
+    public static ProtoWriter Shared
+    {
+        get
+        {
+            if(shared == null)
+            {
+                shared = new ProtoWriter(256);
+            }
+            shared.position = 0;
+            return shared;
+        }
+    }
+    public ProtoWriter(int capacity)
+    {
+        buffer = new byte[capacity > 0 ? capacity : 16];
+        position = 0;
+    }
+    public void Ensure(int n)
+    {
+        if(position + n > buffer.Length)
+        {
+            System.Array.Resize(ref buffer, System.Math.Max(buffer.Length * 2, position + n));
+        }
+    }
+    public static int VarintSize(uint v)
+    {
+        int n = 1;
+        while(v > 0x7F)
+        {
+            v >>= 7;
+            ++n;
+        }
+        return n;
+    }
+    public static int SInt32Size(int v)
+    {
+        return VarintSize((uint)((v << 1) ^ (v >> 31)));
+    }
+    public static int StringSize(string v)
+    {
+        if(v == null)
+        {
+            return 1;
+        }
+        int len = System.Text.Encoding.UTF8.GetByteCount(v);
+        return VarintSize((uint)len) + len;
+    }
+    public static int MessageSize(int len)
+    {
+        return VarintSize((uint)len) + len;
+    }
+    public void WriteUInt32(uint v)
+    {
+        if(position + 5 > buffer.Length)
+        {
+            Ensure(VarintSize(v));
+        }
+        while(v > 0x7F)
+        {
+            buffer[position++] = (byte)(v | 0x80);
+            v >>= 7;
+        }
+        buffer[position++] = (byte)v;
+    }
+    public void WriteSInt32(int v)
+    {
+        WriteUInt32((uint)((v << 1) ^ (v >> 31)));
+    }
+    public void WriteTag(int index, int wireType)
+    {
+        WriteUInt32((uint)((index << 3) | wireType));
+    }
+    public void WriteFixed32(uint v)
+    {
+        Ensure(4);
+        buffer[position++] = (byte)v;
+        buffer[position++] = (byte)(v >> 8);
+        buffer[position++] = (byte)(v >> 16);
+        buffer[position++] = (byte)(v >> 24);
+    }
+    public void WriteFloat(float v)
+    {
+        ProtoBits bits = new ProtoBits();
+        bits.f = v;
+        WriteFixed32(bits.u);
+    }
+    public void WriteDouble(double v)
+    {
+        ulong u = (ulong)System.BitConverter.DoubleToInt64Bits(v);
+        WriteFixed32((uint)u);
+        WriteFixed32((uint)(u >> 32));
+    }
+    public void WriteString(string v)
+    {
+        if(v == null)
+        {
+            WriteUInt32(0);
+            return;
+        }
+        int len = System.Text.Encoding.UTF8.GetByteCount(v);
+        WriteUInt32((uint)len);
+        Ensure(len);
+        System.Text.Encoding.UTF8.GetBytes(v, 0, v.Length, buffer, position);
+        position += len;
+    }
+    public int BeginMessage()
+    {
+        return position;
+    }
+    public void EndMessage(int start)
+    {
+        int len = position - start;
+        int n = VarintSize((uint)len);
+        Ensure(n);
+        System.Buffer.BlockCopy(buffer, start, buffer, start + n, len);
+        position = start;
+        WriteUInt32((uint)len);
+        position += len;
+    }
+    [System.ThreadStatic]static ProtoWriter wrapper;
+    public static ProtoWriter Wrap(byte[] buf, int offset, int size)
+    {
+        if(buf == null || offset < 0 || buf.Length - offset < size)
+        {
+            throw new System.ArgumentException("buffer too small");
+        }
+        if(wrapper == null)
+        {
+            wrapper = new ProtoWriter(1);
+        }
+        wrapper.buffer = buf;
+        wrapper.position = offset;
+        return wrapper;
+    }
+    public void Unwrap()
+    {
+        buffer = null;
+        position = 0;
+    }
+    public byte[] ToArray()
+    {
+        byte[] ret = new byte[position];
+        System.Buffer.BlockCopy(buffer, 0, ret, 0, position);
+        return ret;
+    }
+}
+public static class ProtoReader
+{
+    public static uint ReadUInt32(byte[] buf, ref int pos)
+    {
+        uint v = 0;
+        int shift = 0;
+        byte b;
+        do
+        {
+            b = buf[pos++];
+            if(shift < 32)
+            {
+                v |= (uint)(b & 0x7F) << shift;
+            }
+            shift += 7;
+        }
+        while((b & 0x80) != 0);
+        return v;
+    }
+    public static int ReadSInt32(byte[] buf, ref int pos)
+    {
+        uint v = ReadUInt32(buf, ref pos);
+        return (int)(v >> 1) ^ -(int)(v & 1);
+    }
+    public static uint ReadFixed32(byte[] buf, ref int pos)
+    {
+        uint v = (uint)(buf[pos] | (buf[pos + 1] << 8) | (buf[pos + 2] << 16) | (buf[pos + 3] << 24));
+        pos += 4;
+        return v;
+    }
+    public static float ReadFloat(byte[] buf, ref int pos)
+    {
+        ProtoBits bits = new ProtoBits();
+        bits.u = ReadFixed32(buf, ref pos);
+        return bits.f;
+    }
+    public static double ReadDouble(byte[] buf, ref int pos)
+    {
+        ulong lo = ReadFixed32(buf, ref pos);
+        ulong hi = ReadFixed32(buf, ref pos);
+        return System.BitConverter.Int64BitsToDouble((long)(lo | (hi << 32)));
+    }
+    public static string ReadString(byte[] buf, ref int pos)
+    {
+        int len = (int)ReadUInt32(buf, ref pos);
+        string v = System.Text.Encoding.UTF8.GetString(buf, pos, len);
+        pos += len;
+        return v;
+    }
+    public static void Skip(byte[] buf, ref int pos, int wireType)
+    {
+        switch(wireType)
+        {
+            case 0:ReadUInt32(buf, ref pos);
+            break;
+            case 1:pos += 8;
+            break;
+            case 2:
+            {
+                int len = (int)ReadUInt32(buf, ref pos);
+                pos += len;
+            }
+            break;
+            case 5:pos += 4;
+            break;
+            default:throw new System.FormatException("unknown wire type " + wireType);
+        }
+    }
+}
+namespace chat
+{
+    public class chatHandler
+    {
+        public static PomeloClient pc = null;
+        public static class Routes
+        {
+            public const ushort recv = 1;
+            public const ushort send = 2;
+        }
+        public static class Requests
+        {
+            public static void recv(ProtoWriter w, int x,int y,int z,recv_Vec3 pos=null)
+            {
+                w.WriteTag(1, 0);
+                w.WriteSInt32(x);
+                w.WriteTag(2, 0);
+                w.WriteSInt32(y);
+                w.WriteTag(3, 0);
+                w.WriteSInt32(z);
+                if(pos != null)
+                {
+                    w.WriteTag(4, 2);
+                    {
+                        int m = w.BeginMessage();
+                        pos.Encode(w);
+                        w.EndMessage(m);
+                    }
+                }
+            }
+            public static void send(ProtoWriter w, string rid,string content,string from,string target,send_Vec3[] positions,int opti=0,send_Vec3 pos=null)
+            {
+                w.WriteTag(1, 2);
+                w.WriteString(rid);
+                w.WriteTag(2, 2);
+                w.WriteString(content);
+                w.WriteTag(3, 0);
+                w.WriteSInt32(opti);
+                w.WriteTag(4, 2);
+                w.WriteString(from);
+                w.WriteTag(5, 2);
+                w.WriteString(target);
+                if(pos != null)
+                {
+                    w.WriteTag(6, 2);
+                    {
+                        int m = w.BeginMessage();
+                        pos.Encode(w);
+                        w.EndMessage(m);
+                    }
+                }
+                if(positions != null && positions.Length > 0)
+                {
+                    for(int i=0;i<positions.Length;++i)
+                    {
+                        if(positions[i] == null)
+                        {
+                            continue;
+                        }
+                        w.WriteTag(7, 2);
+                        {
+                            int m = w.BeginMessage();
+                            positions[i].Encode(w);
+                            w.EndMessage(m);
+                        }
+                    }
+                }
+            }
+        }
+        public class recv_Vec3
+        {
+            public class Vec2
+            {
+                public int x;
+                public int y;
+                public JsonData ToJson()
+                {
+                    JsonData data = new JsonData();
+                    data["x"] = x;
+                    data["y"] = y;
+                    return data;
+                }
+                public void FromJson(JsonData ret)
+                {
+                    this.x= ret.ContainsKey("x")?(int)ret["x"]:0;
+                    this.y= ret.ContainsKey("y")?(int)ret["y"]:0;
+                }
+                public int CalculateSize()
+                {
+                    int size = 0;
+                    size += 1 + ProtoWriter.SInt32Size(this.x);
+                    size += 1 + ProtoWriter.SInt32Size(this.y);
+                    return size;
+                }
+                public void Encode(ProtoWriter w)
+                {
+                    w.WriteTag(1, 0);
+                    w.WriteSInt32(x);
+                    w.WriteTag(2, 0);
+                    w.WriteSInt32(y);
+                }
+                public void Encode(System.IO.Stream s)
+                {
+                    ProtoWriter w = ProtoWriter.Shared;
+                    Encode(w);
+                    s.Write(w.buffer, 0, w.position);
+                }
+                public byte[] Encode()
+                {
+                    ProtoWriter w = ProtoWriter.Shared;
+                    Encode(w);
+                    return w.ToArray();
+                }
+                public int Encode(byte[] buf, int offset)
+                {
+                    int size = CalculateSize();
+                    ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                    Encode(w);
+                    w.Unwrap();
+                    return size;
+                }
+                public void Decode(byte[] buf, int offset, int length)
+                {
+                    int end = offset + length;
+                    while(offset < end)
+                    {
+                        uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                        switch((int)(tag >> 3))
+                        {
+                            case 1:this.x = ProtoReader.ReadSInt32(buf, ref offset);
+                            break;
+                            case 2:this.y = ProtoReader.ReadSInt32(buf, ref offset);
+                            break;
+                            default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                            break;
+                        }
+                    }
+                }
+            }
+            public float x;
+            public float y;
+            public float z;
+            public Vec2 xx;
+            public Vec2[] xxx;
+            public JsonData ToJson()
+            {
+                JsonData data = new JsonData();
+                data["x"] = x;
+                data["y"] = y;
+                data["z"] = z;
+                if(xx != null)
+                {
+                    data["xx"]=xx.ToJson();
+                }
+                if(xxx != null)
+                {
+                    data["xxx"] = new JsonData();
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        data["xxx"].Add(xxx[i].ToJson());
+                    }
+                }
+                return data;
+            }
+            public void FromJson(JsonData ret)
+            {
+                this.x= ret.ContainsKey("x")?(float)ret["x"]:0.0f;
+                this.y= ret.ContainsKey("y")?(float)ret["y"]:0.0f;
+                this.z= ret.ContainsKey("z")?(float)ret["z"]:0.0f;
+                if(ret.ContainsKey("xx"))
+                {
+                    this.xx = new Vec2();
+                    this.xx.FromJson(ret["xx"]);
+                }
+                if(ret.ContainsKey("xxx") && ret["xxx"].IsArray && ret["xxx"].Count > 0)
+                {
+                    this.xxx = new Vec2[ret["xxx"].Count];
+                    for(int i=0;i<ret["xxx"].Count;++i)
+                    {
+                        this.xxx[i] = new Vec2();
+                        this.xxx[i].FromJson(ret["xxx"][i]);
+                    }
+                }
+            }
+            public int CalculateSize()
+            {
+                int size = 0;
+                size += 1 + 4;
+                size += 1 + 4;
+                size += 1 + 4;
+                if(this.xx != null)
+                {
+                    size += 1 + ProtoWriter.MessageSize(this.xx.CalculateSize());
+                }
+                if(this.xxx != null && this.xxx.Length > 0)
+                {
+                    for(int i=0;i<this.xxx.Length;++i)
+                    {
+                        if(this.xxx[i] == null)
+                        {
+                            continue;
+                        }
+                        size += 1 + ProtoWriter.MessageSize(this.xxx[i].CalculateSize());
+                    }
+                }
+                return size;
+            }
+            public void Encode(ProtoWriter w)
+            {
+                w.WriteTag(1, 5);
+                w.WriteFloat(x);
+                w.WriteTag(2, 5);
+                w.WriteFloat(y);
+                w.WriteTag(3, 5);
+                w.WriteFloat(z);
+                if(xx != null)
+                {
+                    w.WriteTag(4, 2);
+                    {
+                        int m = w.BeginMessage();
+                        xx.Encode(w);
+                        w.EndMessage(m);
+                    }
+                }
+                if(xxx != null && xxx.Length > 0)
+                {
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        if(xxx[i] == null)
+                        {
+                            continue;
+                        }
+                        w.WriteTag(5, 2);
+                        {
+                            int m = w.BeginMessage();
+                            xxx[i].Encode(w);
+                            w.EndMessage(m);
+                        }
+                    }
+                }
+            }
+            public void Encode(System.IO.Stream s)
+            {
+                ProtoWriter w = ProtoWriter.Shared;
+                Encode(w);
+                s.Write(w.buffer, 0, w.position);
+            }
+            public byte[] Encode()
+            {
+                ProtoWriter w = ProtoWriter.Shared;
+                Encode(w);
+                return w.ToArray();
+            }
+            public int Encode(byte[] buf, int offset)
+            {
+                int size = CalculateSize();
+                ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                Encode(w);
+                w.Unwrap();
+                return size;
+            }
+            public void Decode(byte[] buf, int offset, int length)
+            {
+                int end = offset + length;
+                int n_xxx = 0;
+                while(offset < end)
+                {
+                    uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                    switch((int)(tag >> 3))
+                    {
+                        case 1:this.x = ProtoReader.ReadFloat(buf, ref offset);
+                        break;
+                        case 2:this.y = ProtoReader.ReadFloat(buf, ref offset);
+                        break;
+                        case 3:this.z = ProtoReader.ReadFloat(buf, ref offset);
+                        break;
+                        case 4:
+                        {
+                            int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                            this.xx = new Vec2();
+                            this.xx.Decode(buf, offset, len);
+                            offset += len;
+                        }
+                        break;
+                        case 5:if(this.xxx == null || n_xxx == this.xxx.Length)
+                        {
+                            System.Array.Resize(ref this.xxx, n_xxx == 0 ? 4 : n_xxx * 2);
+                        }
+                        {
+                            int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                            this.xxx[n_xxx] = new Vec2();
+                            this.xxx[n_xxx].Decode(buf, offset, len);
+                            offset += len;
+                        }
+                        ++n_xxx;
+                        break;
+                        default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                        break;
+                    }
+                }
+                if(n_xxx > 0 && n_xxx != this.xxx.Length)
+                {
+                    System.Array.Resize(ref this.xxx, n_xxx);
+                }
+            }
+        }
+        public static bool recv(int x,int y,int z,recv_Vec3 pos=null)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Requests.recv(w, x, y, z, pos);
+            pc.notify(Routes.recv, w.ToArray());
+            return true;
+        }
+        public class send_Vec3
+        {
+            public class Vec2
+            {
+                public int x;
+                public int y;
+                public JsonData ToJson()
+                {
+                    JsonData data = new JsonData();
+                    data["x"] = x;
+                    data["y"] = y;
+                    return data;
+                }
+                public void FromJson(JsonData ret)
+                {
+                    this.x= ret.ContainsKey("x")?(int)ret["x"]:0;
+                    this.y= ret.ContainsKey("y")?(int)ret["y"]:0;
+                }
+                public int CalculateSize()
+                {
+                    int size = 0;
+                    size += 1 + ProtoWriter.SInt32Size(this.x);
+                    size += 1 + ProtoWriter.SInt32Size(this.y);
+                    return size;
+                }
+                public void Encode(ProtoWriter w)
+                {
+                    w.WriteTag(1, 0);
+                    w.WriteSInt32(x);
+                    w.WriteTag(2, 0);
+                    w.WriteSInt32(y);
+                }
+                public void Encode(System.IO.Stream s)
+                {
+                    ProtoWriter w = ProtoWriter.Shared;
+                    Encode(w);
+                    s.Write(w.buffer, 0, w.position);
+                }
+                public byte[] Encode()
+                {
+                    ProtoWriter w = ProtoWriter.Shared;
+                    Encode(w);
+                    return w.ToArray();
+                }
+                public int Encode(byte[] buf, int offset)
+                {
+                    int size = CalculateSize();
+                    ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                    Encode(w);
+                    w.Unwrap();
+                    return size;
+                }
+                public void Decode(byte[] buf, int offset, int length)
+                {
+                    int end = offset + length;
+                    while(offset < end)
+                    {
+                        uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                        switch((int)(tag >> 3))
+                        {
+                            case 1:this.x = ProtoReader.ReadSInt32(buf, ref offset);
+                            break;
+                            case 2:this.y = ProtoReader.ReadSInt32(buf, ref offset);
+                            break;
+                            default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                            break;
+                        }
+                    }
+                }
+            }
+            public float x;
+            public float y;
+            public float z;
+            public Vec2 xx;
+            public Vec2[] xxx;
+            public JsonData ToJson()
+            {
+                JsonData data = new JsonData();
+                data["x"] = x;
+                data["y"] = y;
+                data["z"] = z;
+                if(xx != null)
+                {
+                    data["xx"]=xx.ToJson();
+                }
+                if(xxx != null)
+                {
+                    data["xxx"] = new JsonData();
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        data["xxx"].Add(xxx[i].ToJson());
+                    }
+                }
+                return data;
+            }
+            public void FromJson(JsonData ret)
+            {
+                this.x= ret.ContainsKey("x")?(float)ret["x"]:0.0f;
+                this.y= ret.ContainsKey("y")?(float)ret["y"]:0.0f;
+                this.z= ret.ContainsKey("z")?(float)ret["z"]:0.0f;
+                if(ret.ContainsKey("xx"))
+                {
+                    this.xx = new Vec2();
+                    this.xx.FromJson(ret["xx"]);
+                }
+                if(ret.ContainsKey("xxx") && ret["xxx"].IsArray && ret["xxx"].Count > 0)
+                {
+                    this.xxx = new Vec2[ret["xxx"].Count];
+                    for(int i=0;i<ret["xxx"].Count;++i)
+                    {
+                        this.xxx[i] = new Vec2();
+                        this.xxx[i].FromJson(ret["xxx"][i]);
+                    }
+                }
+            }
+            public int CalculateSize()
+            {
+                int size = 0;
+                size += 1 + 4;
+                size += 1 + 4;
+                size += 1 + 4;
+                if(this.xx != null)
+                {
+                    size += 1 + ProtoWriter.MessageSize(this.xx.CalculateSize());
+                }
+                if(this.xxx != null && this.xxx.Length > 0)
+                {
+                    for(int i=0;i<this.xxx.Length;++i)
+                    {
+                        if(this.xxx[i] == null)
+                        {
+                            continue;
+                        }
+                        size += 1 + ProtoWriter.MessageSize(this.xxx[i].CalculateSize());
+                    }
+                }
+                return size;
+            }
+            public void Encode(ProtoWriter w)
+            {
+                w.WriteTag(1, 5);
+                w.WriteFloat(x);
+                w.WriteTag(2, 5);
+                w.WriteFloat(y);
+                w.WriteTag(3, 5);
+                w.WriteFloat(z);
+                if(xx != null)
+                {
+                    w.WriteTag(4, 2);
+                    {
+                        int m = w.BeginMessage();
+                        xx.Encode(w);
+                        w.EndMessage(m);
+                    }
+                }
+                if(xxx != null && xxx.Length > 0)
+                {
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        if(xxx[i] == null)
+                        {
+                            continue;
+                        }
+                        w.WriteTag(5, 2);
+                        {
+                            int m = w.BeginMessage();
+                            xxx[i].Encode(w);
+                            w.EndMessage(m);
+                        }
+                    }
+                }
+            }
+            public void Encode(System.IO.Stream s)
+            {
+                ProtoWriter w = ProtoWriter.Shared;
+                Encode(w);
+                s.Write(w.buffer, 0, w.position);
+            }
+            public byte[] Encode()
+            {
+                ProtoWriter w = ProtoWriter.Shared;
+                Encode(w);
+                return w.ToArray();
+            }
+            public int Encode(byte[] buf, int offset)
+            {
+                int size = CalculateSize();
+                ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                Encode(w);
+                w.Unwrap();
+                return size;
+            }
+            public void Decode(byte[] buf, int offset, int length)
+            {
+                int end = offset + length;
+                int n_xxx = 0;
+                while(offset < end)
+                {
+                    uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                    switch((int)(tag >> 3))
+                    {
+                        case 1:this.x = ProtoReader.ReadFloat(buf, ref offset);
+                        break;
+                        case 2:this.y = ProtoReader.ReadFloat(buf, ref offset);
+                        break;
+                        case 3:this.z = ProtoReader.ReadFloat(buf, ref offset);
+                        break;
+                        case 4:
+                        {
+                            int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                            this.xx = new Vec2();
+                            this.xx.Decode(buf, offset, len);
+                            offset += len;
+                        }
+                        break;
+                        case 5:if(this.xxx == null || n_xxx == this.xxx.Length)
+                        {
+                            System.Array.Resize(ref this.xxx, n_xxx == 0 ? 4 : n_xxx * 2);
+                        }
+                        {
+                            int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                            this.xxx[n_xxx] = new Vec2();
+                            this.xxx[n_xxx].Decode(buf, offset, len);
+                            offset += len;
+                        }
+                        ++n_xxx;
+                        break;
+                        default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                        break;
+                    }
+                }
+                if(n_xxx > 0 && n_xxx != this.xxx.Length)
+                {
+                    System.Array.Resize(ref this.xxx, n_xxx);
+                }
+            }
+        }
+        public static bool send(string rid,string content,string from,string target,send_Vec3[] positions,int opti=0,send_Vec3 pos=null)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Requests.send(w, rid, content, from, target, positions, opti, pos);
+            pc.notify(Routes.send, w.ToArray());
+            return true;
+        }
+    }
+}
+namespace connector
+{
+    public class entryHandler
+    {
+        public static PomeloClient pc = null;
+        public static class Routes
+        {
+            public const ushort enter = 3;
+        }
+        public static class Requests
+        {
+            public static void enter(ProtoWriter w, string username,string rid)
+            {
+                w.WriteTag(1, 2);
+                w.WriteString(username);
+                w.WriteTag(2, 2);
+                w.WriteString(rid);
+            }
+        }
+        public static bool enter(string username,string rid)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Requests.enter(w, username, rid);
+            pc.notify(Routes.enter, w.ToArray());
+            return true;
+        }
+    }
+}
+namespace gate
+{
+    public class gateHandler
+    {
+        public static PomeloClient pc = null;
+        public static class Routes
+        {
+            public const ushort queryEntry = 4;
+        }
+        public static class Requests
+        {
+            public static void queryEntry(ProtoWriter w, string uid)
+            {
+                w.WriteTag(1, 2);
+                w.WriteString(uid);
+            }
+        }
+        public class queryEntry_result
+        {
+            public class Vec3
+            {
+                public class Vec2
+                {
+                    public int x;
+                    public int y;
+                    public JsonData ToJson()
+                    {
+                        JsonData data = new JsonData();
+                        data["x"] = x;
+                        data["y"] = y;
+                        return data;
+                    }
+                    public void FromJson(JsonData ret)
+                    {
+                        this.x= ret.ContainsKey("x")?(int)ret["x"]:0;
+                        this.y= ret.ContainsKey("y")?(int)ret["y"]:0;
+                    }
+                    public int CalculateSize()
+                    {
+                        int size = 0;
+                        size += 1 + ProtoWriter.SInt32Size(this.x);
+                        size += 1 + ProtoWriter.SInt32Size(this.y);
+                        return size;
+                    }
+                    public void Encode(ProtoWriter w)
+                    {
+                        w.WriteTag(1, 0);
+                        w.WriteSInt32(x);
+                        w.WriteTag(2, 0);
+                        w.WriteSInt32(y);
+                    }
+                    public void Encode(System.IO.Stream s)
+                    {
+                        ProtoWriter w = ProtoWriter.Shared;
+                        Encode(w);
+                        s.Write(w.buffer, 0, w.position);
+                    }
+                    public byte[] Encode()
+                    {
+                        ProtoWriter w = ProtoWriter.Shared;
+                        Encode(w);
+                        return w.ToArray();
+                    }
+                    public int Encode(byte[] buf, int offset)
+                    {
+                        int size = CalculateSize();
+                        ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                        Encode(w);
+                        w.Unwrap();
+                        return size;
+                    }
+                    public void Decode(byte[] buf, int offset, int length)
+                    {
+                        int end = offset + length;
+                        while(offset < end)
+                        {
+                            uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                            switch((int)(tag >> 3))
+                            {
+                                case 1:this.x = ProtoReader.ReadSInt32(buf, ref offset);
+                                break;
+                                case 2:this.y = ProtoReader.ReadSInt32(buf, ref offset);
+                                break;
+                                default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                                break;
+                            }
+                        }
+                    }
+                }
+                public float x;
+                public float y;
+                public float z;
+                public Vec2 xx;
+                public Vec2[] xxx;
+                public JsonData ToJson()
+                {
+                    JsonData data = new JsonData();
+                    data["x"] = x;
+                    data["y"] = y;
+                    data["z"] = z;
+                    if(xx != null)
+                    {
+                        data["xx"]=xx.ToJson();
+                    }
+                    if(xxx != null)
+                    {
+                        data["xxx"] = new JsonData();
+                        for(int i=0;i<xxx.Length;++i)
+                        {
+                            data["xxx"].Add(xxx[i].ToJson());
+                        }
+                    }
+                    return data;
+                }
+                public void FromJson(JsonData ret)
+                {
+                    this.x= ret.ContainsKey("x")?(float)ret["x"]:0.0f;
+                    this.y= ret.ContainsKey("y")?(float)ret["y"]:0.0f;
+                    this.z= ret.ContainsKey("z")?(float)ret["z"]:0.0f;
+                    if(ret.ContainsKey("xx"))
+                    {
+                        this.xx = new Vec2();
+                        this.xx.FromJson(ret["xx"]);
+                    }
+                    if(ret.ContainsKey("xxx") && ret["xxx"].IsArray && ret["xxx"].Count > 0)
+                    {
+                        this.xxx = new Vec2[ret["xxx"].Count];
+                        for(int i=0;i<ret["xxx"].Count;++i)
+                        {
+                            this.xxx[i] = new Vec2();
+                            this.xxx[i].FromJson(ret["xxx"][i]);
+                        }
+                    }
+                }
+                public int CalculateSize()
+                {
+                    int size = 0;
+                    size += 1 + 4;
+                    size += 1 + 4;
+                    size += 1 + 4;
+                    if(this.xx != null)
+                    {
+                        size += 1 + ProtoWriter.MessageSize(this.xx.CalculateSize());
+                    }
+                    if(this.xxx != null && this.xxx.Length > 0)
+                    {
+                        for(int i=0;i<this.xxx.Length;++i)
+                        {
+                            if(this.xxx[i] == null)
+                            {
+                                continue;
+                            }
+                            size += 1 + ProtoWriter.MessageSize(this.xxx[i].CalculateSize());
+                        }
+                    }
+                    return size;
+                }
+                public void Encode(ProtoWriter w)
+                {
+                    w.WriteTag(1, 5);
+                    w.WriteFloat(x);
+                    w.WriteTag(2, 5);
+                    w.WriteFloat(y);
+                    w.WriteTag(3, 5);
+                    w.WriteFloat(z);
+                    if(xx != null)
+                    {
+                        w.WriteTag(4, 2);
+                        {
+                            int m = w.BeginMessage();
+                            xx.Encode(w);
+                            w.EndMessage(m);
+                        }
+                    }
+                    if(xxx != null && xxx.Length > 0)
+                    {
+                        for(int i=0;i<xxx.Length;++i)
+                        {
+                            if(xxx[i] == null)
+                            {
+                                continue;
+                            }
+                            w.WriteTag(5, 2);
+                            {
+                                int m = w.BeginMessage();
+                                xxx[i].Encode(w);
+                                w.EndMessage(m);
+                            }
+                        }
+                    }
+                }
+                public void Encode(System.IO.Stream s)
+                {
+                    ProtoWriter w = ProtoWriter.Shared;
+                    Encode(w);
+                    s.Write(w.buffer, 0, w.position);
+                }
+                public byte[] Encode()
+                {
+                    ProtoWriter w = ProtoWriter.Shared;
+                    Encode(w);
+                    return w.ToArray();
+                }
+                public int Encode(byte[] buf, int offset)
+                {
+                    int size = CalculateSize();
+                    ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                    Encode(w);
+                    w.Unwrap();
+                    return size;
+                }
+                public void Decode(byte[] buf, int offset, int length)
+                {
+                    int end = offset + length;
+                    int n_xxx = 0;
+                    while(offset < end)
+                    {
+                        uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                        switch((int)(tag >> 3))
+                        {
+                            case 1:this.x = ProtoReader.ReadFloat(buf, ref offset);
+                            break;
+                            case 2:this.y = ProtoReader.ReadFloat(buf, ref offset);
+                            break;
+                            case 3:this.z = ProtoReader.ReadFloat(buf, ref offset);
+                            break;
+                            case 4:
+                            {
+                                int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                                this.xx = new Vec2();
+                                this.xx.Decode(buf, offset, len);
+                                offset += len;
+                            }
+                            break;
+                            case 5:if(this.xxx == null || n_xxx == this.xxx.Length)
+                            {
+                                System.Array.Resize(ref this.xxx, n_xxx == 0 ? 4 : n_xxx * 2);
+                            }
+                            {
+                                int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                                this.xxx[n_xxx] = new Vec2();
+                                this.xxx[n_xxx].Decode(buf, offset, len);
+                                offset += len;
+                            }
+                            ++n_xxx;
+                            break;
+                            default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                            break;
+                        }
+                    }
+                    if(n_xxx > 0 && n_xxx != this.xxx.Length)
+                    {
+                        System.Array.Resize(ref this.xxx, n_xxx);
+                    }
+                }
+            }
+            public int code;
+            public string host;
+            public int port;
+            public int[] xxx;
+            public Vec3[] positions;
+            public JsonData ToJson()
+            {
+                JsonData data = new JsonData();
+                data["code"] = code;
+                data["host"] = host;
+                data["port"] = port;
+                for(int i=0;i<xxx.Length;++i)
+                {
+                    data["xxx"].Add(xxx[i]);
+                }
+                if(positions != null)
+                {
+                    data["positions"] = new JsonData();
+                    for(int i=0;i<positions.Length;++i)
+                    {
+                        data["positions"].Add(positions[i].ToJson());
+                    }
+                }
+                return data;
+            }
+            public void FromJson(JsonData ret)
+            {
+                this.code= ret.ContainsKey("code")?(int)ret["code"]:0;
+                this.host= ret.ContainsKey("host")?(string)ret["host"]:"";
+                this.port= ret.ContainsKey("port")?(int)ret["port"]:0;
+                if(ret.ContainsKey("xxx") && ret["xxx"].IsArray && ret["xxx"].Count > 0)
+                {
+                    this.xxx = new int[ret["xxx"].Count];
+                    for(int i=0;i<ret["xxx"].Count;++i)
+                    {
+                        this.xxx[i]=(int)ret["xxx"][i];
+                    }
+                }
+                if(ret.ContainsKey("positions") && ret["positions"].IsArray && ret["positions"].Count > 0)
+                {
+                    this.positions = new Vec3[ret["positions"].Count];
+                    for(int i=0;i<ret["positions"].Count;++i)
+                    {
+                        this.positions[i] = new Vec3();
+                        this.positions[i].FromJson(ret["positions"][i]);
+                    }
+                }
+            }
+            public int CalculateSize()
+            {
+                int size = 0;
+                size += 1 + ProtoWriter.SInt32Size(this.code);
+                size += 1 + ProtoWriter.StringSize(this.host);
+                size += 1 + ProtoWriter.SInt32Size(this.port);
+                if(this.xxx != null && this.xxx.Length > 0)
+                {
+                    size += 1 + ProtoWriter.VarintSize((uint)this.xxx.Length);
+                    for(int i=0;i<this.xxx.Length;++i)
+                    {
+                        size += ProtoWriter.SInt32Size(this.xxx[i]);
+                    }
+                }
+                if(this.positions != null && this.positions.Length > 0)
+                {
+                    for(int i=0;i<this.positions.Length;++i)
+                    {
+                        if(this.positions[i] == null)
+                        {
+                            continue;
+                        }
+                        size += 1 + ProtoWriter.MessageSize(this.positions[i].CalculateSize());
+                    }
+                }
+                return size;
+            }
+            public void Encode(ProtoWriter w)
+            {
+                w.WriteTag(1, 0);
+                w.WriteSInt32(code);
+                w.WriteTag(2, 2);
+                w.WriteString(host);
+                w.WriteTag(3, 0);
+                w.WriteSInt32(port);
+                if(xxx != null && xxx.Length > 0)
+                {
+                    w.WriteTag(4, 0);
+                    w.WriteUInt32((uint)xxx.Length);
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        w.WriteSInt32(xxx[i]);
+                    }
+                }
+                if(positions != null && positions.Length > 0)
+                {
+                    for(int i=0;i<positions.Length;++i)
+                    {
+                        if(positions[i] == null)
+                        {
+                            continue;
+                        }
+                        w.WriteTag(5, 2);
+                        {
+                            int m = w.BeginMessage();
+                            positions[i].Encode(w);
+                            w.EndMessage(m);
+                        }
+                    }
+                }
+            }
+            public void Encode(System.IO.Stream s)
+            {
+                ProtoWriter w = ProtoWriter.Shared;
+                Encode(w);
+                s.Write(w.buffer, 0, w.position);
+            }
+            public byte[] Encode()
+            {
+                ProtoWriter w = ProtoWriter.Shared;
+                Encode(w);
+                return w.ToArray();
+            }
+            public int Encode(byte[] buf, int offset)
+            {
+                int size = CalculateSize();
+                ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                Encode(w);
+                w.Unwrap();
+                return size;
+            }
+            public void Decode(byte[] buf, int offset, int length)
+            {
+                int end = offset + length;
+                int n_positions = 0;
+                while(offset < end)
+                {
+                    uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                    switch((int)(tag >> 3))
+                    {
+                        case 1:this.code = ProtoReader.ReadSInt32(buf, ref offset);
+                        break;
+                        case 2:this.host = ProtoReader.ReadString(buf, ref offset);
+                        break;
+                        case 3:this.port = ProtoReader.ReadSInt32(buf, ref offset);
+                        break;
+                        case 4:
+                        {
+                            int count = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                            int start = this.xxx == null ? 0 : this.xxx.Length;
+                            if(start == 0)
+                            {
+                                this.xxx = new int[count];
+                            }
+                            else
+                            {
+                                System.Array.Resize(ref this.xxx, start + count);
+                            }
+                            for(int i=start;i<start + count;++i)
+                            {
+                                this.xxx[i] = ProtoReader.ReadSInt32(buf, ref offset);
+                            }
+                        }
+                        break;
+                        case 5:if(this.positions == null || n_positions == this.positions.Length)
+                        {
+                            System.Array.Resize(ref this.positions, n_positions == 0 ? 4 : n_positions * 2);
+                        }
+                        {
+                            int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                            this.positions[n_positions] = new Vec3();
+                            this.positions[n_positions].Decode(buf, offset, len);
+                            offset += len;
+                        }
+                        ++n_positions;
+                        break;
+                        default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                        break;
+                    }
+                }
+                if(n_positions > 0 && n_positions != this.positions.Length)
+                {
+                    System.Array.Resize(ref this.positions, n_positions);
+                }
+            }
+        }
+        public static bool queryEntry(string uid,System.Action<queryEntry_result> cb)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Requests.queryEntry(w, uid);
+            pc.request(Routes.queryEntry, w.ToArray(), delegate (byte[] ret)
+            {
+                queryEntry_result result = new queryEntry_result();
+                result.Decode(ret, 0, ret.Length);
+                cb(result);
+            }
+            );
+            return true;
+        }
+    }
+}
+public class ServerEvent
+{
+    public static PomeloClient pc = null;
+    public static class Routes
+    {
+        public const ushort onAdd = 5;
+        public const ushort onChat = 6;
+        public const ushort onLeave = 7;
+    }
+    public class onAdd_event
+    {
+        public string user;
+        public JsonData ToJson()
+        {
+            JsonData data = new JsonData();
+            data["user"] = user;
+            return data;
+        }
+        public void FromJson(JsonData ret)
+        {
+            this.user= ret.ContainsKey("user")?(string)ret["user"]:"";
+        }
+        public int CalculateSize()
+        {
+            int size = 0;
+            size += 1 + ProtoWriter.StringSize(this.user);
+            return size;
+        }
+        public void Encode(ProtoWriter w)
+        {
+            w.WriteTag(1, 2);
+            w.WriteString(user);
+        }
+        public void Encode(System.IO.Stream s)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Encode(w);
+            s.Write(w.buffer, 0, w.position);
+        }
+        public byte[] Encode()
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Encode(w);
+            return w.ToArray();
+        }
+        public int Encode(byte[] buf, int offset)
+        {
+            int size = CalculateSize();
+            ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+            Encode(w);
+            w.Unwrap();
+            return size;
+        }
+        public void Decode(byte[] buf, int offset, int length)
+        {
+            int end = offset + length;
+            while(offset < end)
+            {
+                uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                switch((int)(tag >> 3))
+                {
+                    case 1:this.user = ProtoReader.ReadString(buf, ref offset);
+                    break;
+                    default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                    break;
+                }
+            }
+        }
+    }
+    public static bool onAdd(System.Action<onAdd_event> cb)
+    {
+        pc.on(Routes.onAdd, delegate (byte[] ret)
+        {
+            onAdd_event result = new onAdd_event();
+            result.Decode(ret, 0, ret.Length);
+            cb(result);
+        }
+        );
+        return true;
+    }
+    public class onChat_event
+    {
+        public string msg;
+        public string from;
+        public string target;
+        public JsonData ToJson()
+        {
+            JsonData data = new JsonData();
+            data["msg"] = msg;
+            data["from"] = from;
+            data["target"] = target;
+            return data;
+        }
+        public void FromJson(JsonData ret)
+        {
+            this.msg= ret.ContainsKey("msg")?(string)ret["msg"]:"";
+            this.from= ret.ContainsKey("from")?(string)ret["from"]:"";
+            this.target= ret.ContainsKey("target")?(string)ret["target"]:"";
+        }
+        public int CalculateSize()
+        {
+            int size = 0;
+            size += 1 + ProtoWriter.StringSize(this.msg);
+            size += 1 + ProtoWriter.StringSize(this.from);
+            size += 1 + ProtoWriter.StringSize(this.target);
+            return size;
+        }
+        public void Encode(ProtoWriter w)
+        {
+            w.WriteTag(1, 2);
+            w.WriteString(msg);
+            w.WriteTag(2, 2);
+            w.WriteString(from);
+            w.WriteTag(3, 2);
+            w.WriteString(target);
+        }
+        public void Encode(System.IO.Stream s)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Encode(w);
+            s.Write(w.buffer, 0, w.position);
+        }
+        public byte[] Encode()
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Encode(w);
+            return w.ToArray();
+        }
+        public int Encode(byte[] buf, int offset)
+        {
+            int size = CalculateSize();
+            ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+            Encode(w);
+            w.Unwrap();
+            return size;
+        }
+        public void Decode(byte[] buf, int offset, int length)
+        {
+            int end = offset + length;
+            while(offset < end)
+            {
+                uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                switch((int)(tag >> 3))
+                {
+                    case 1:this.msg = ProtoReader.ReadString(buf, ref offset);
+                    break;
+                    case 2:this.from = ProtoReader.ReadString(buf, ref offset);
+                    break;
+                    case 3:this.target = ProtoReader.ReadString(buf, ref offset);
+                    break;
+                    default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                    break;
+                }
+            }
+        }
+    }
+    public static bool onChat(System.Action<onChat_event> cb)
+    {
+        pc.on(Routes.onChat, delegate (byte[] ret)
+        {
+            onChat_event result = new onChat_event();
+            result.Decode(ret, 0, ret.Length);
+            cb(result);
+        }
+        );
+        return true;
+    }
+    public class onLeave_event
+    {
+        public string user;
+        public JsonData ToJson()
+        {
+            JsonData data = new JsonData();
+            data["user"] = user;
+            return data;
+        }
+        public void FromJson(JsonData ret)
+        {
+            this.user= ret.ContainsKey("user")?(string)ret["user"]:"";
+        }
+        public int CalculateSize()
+        {
+            int size = 0;
+            size += 1 + ProtoWriter.StringSize(this.user);
+            return size;
+        }
+        public void Encode(ProtoWriter w)
+        {
+            w.WriteTag(1, 2);
+            w.WriteString(user);
+        }
+        public void Encode(System.IO.Stream s)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Encode(w);
+            s.Write(w.buffer, 0, w.position);
+        }
+        public byte[] Encode()
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Encode(w);
+            return w.ToArray();
+        }
+        public int Encode(byte[] buf, int offset)
+        {
+            int size = CalculateSize();
+            ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+            Encode(w);
+            w.Unwrap();
+            return size;
+        }
+        public void Decode(byte[] buf, int offset, int length)
+        {
+            int end = offset + length;
+            while(offset < end)
+            {
+                uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                switch((int)(tag >> 3))
+                {
+                    case 1:this.user = ProtoReader.ReadString(buf, ref offset);
+                    break;
+                    default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                    break;
+                }
+            }
+        }
+    }
+    public static bool onLeave(System.Action<onLeave_event> cb)
+    {
+        pc.on(Routes.onLeave, delegate (byte[] ret)
+        {
+            onLeave_event result = new onLeave_event();
+            result.Decode(ret, 0, ret.Length);
+            cb(result);
+        }
+        );
+        return true;
+    }
+}
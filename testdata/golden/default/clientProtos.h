@@ -0,0 +1,1339 @@
+// automatically generated by pomeloc, do not modify
+#ifndef POMELOC_GENERATED_CLIENTPROTOS_H_
+#define POMELOC_GENERATED_CLIENTPROTOS_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef POMELOC_CPP_RUNTIME_
+#define POMELOC_CPP_RUNTIME_
+namespace pomeloc_rt
+{
+    struct Writer
+    {
+        uint8_t* p;
+    };
+    struct Reader
+    {
+        const uint8_t* p;
+        const uint8_t* end;
+        bool ok;
+    };
+    inline uint32_t VarintSize(uint32_t v)
+    {
+        uint32_t n = 1;
+        while(v > 0x7F)
+        {
+            v >>= 7;
+            ++n;
+        }
+        return n;
+    }
+    inline uint32_t ZigZag(int32_t v)
+    {
+        return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+    }
+    inline int32_t UnZigZag(uint32_t v)
+    {
+        return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+    }
+    inline void PutVarint(Writer& w, uint32_t v)
+    {
+        while(v > 0x7F)
+        {
+            *w.p++ = static_cast<uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+        *w.p++ = static_cast<uint8_t>(v);
+    }
+    inline void PutFixed32(Writer& w, uint32_t v)
+    {
+        w.p[0] = static_cast<uint8_t>(v);
+        w.p[1] = static_cast<uint8_t>(v >> 8);
+        w.p[2] = static_cast<uint8_t>(v >> 16);
+        w.p[3] = static_cast<uint8_t>(v >> 24);
+        w.p += 4;
+    }
+    inline void PutFloat(Writer& w, float v)
+    {
+        uint32_t u;
+        memcpy(&u, &v, sizeof(u));
+        PutFixed32(w, u);
+    }
+    inline void PutDouble(Writer& w, double v)
+    {
+        uint64_t u;
+        memcpy(&u, &v, sizeof(u));
+        PutFixed32(w, static_cast<uint32_t>(u));
+        PutFixed32(w, static_cast<uint32_t>(u >> 32));
+    }
+    inline void PutString(Writer& w, const std::string& v)
+    {
+        PutVarint(w, static_cast<uint32_t>(v.size()));
+        if(!v.empty())
+        {
+            memcpy(w.p, v.data(), v.size());
+        }
+        w.p += v.size();
+    }
+    inline uint32_t StringSize(const std::string& v)
+    {
+        return VarintSize(static_cast<uint32_t>(v.size())) + static_cast<uint32_t>(v.size());
+    }
+    inline uint32_t MessageSize(uint32_t n)
+    {
+        return VarintSize(n) + n;
+    }
+    inline uint32_t GetVarint(Reader& r)
+    {
+        uint32_t v = 0;
+        int shift = 0;
+        while(r.p < r.end)
+        {
+            uint8_t b = *r.p++;
+            if(shift < 32)
+            {
+                v |= static_cast<uint32_t>(b & 0x7F) << shift;
+            }
+            if(!(b & 0x80))
+            {
+                return v;
+            }
+            shift += 7;
+            if(shift >= 70)
+            {
+                break;
+            }
+        }
+        r.ok = false;
+        return 0;
+    }
+    inline uint32_t GetFixed32(Reader& r)
+    {
+        if(r.end - r.p < 4)
+        {
+            r.ok = false;
+            return 0;
+        }
+        uint32_t v = static_cast<uint32_t>(r.p[0]) | (static_cast<uint32_t>(r.p[1]) << 8) | (static_cast<uint32_t>(r.p[2]) << 16) | (static_cast<uint32_t>(r.p[3]) << 24);
+        r.p += 4;
+        return v;
+    }
+    inline float GetFloat(Reader& r)
+    {
+        uint32_t u = GetFixed32(r);
+        float v;
+        memcpy(&v, &u, sizeof(v));
+        return v;
+    }
+    inline double GetDouble(Reader& r)
+    {
+        uint64_t u = GetFixed32(r);
+        u |= static_cast<uint64_t>(GetFixed32(r)) << 32;
+        double v;
+        memcpy(&v, &u, sizeof(v));
+        return v;
+    }
+    inline bool GetSub(Reader& r, Reader& sub)
+    {
+        uint32_t len = GetVarint(r);
+        if(!r.ok || len > static_cast<size_t>(r.end - r.p))
+        {
+            r.ok = false;
+            return false;
+        }
+        sub.p = r.p;
+        sub.end = r.p + len;
+        sub.ok = true;
+        r.p += len;
+        return true;
+    }
+    inline void GetString(Reader& r, std::string& v)
+    {
+        Reader sub;
+        if(GetSub(r, sub))
+        {
+            v.assign(reinterpret_cast<const char*>(sub.p), sub.end - sub.p);
+        }
+    }
+    inline void Skip(Reader& r, uint32_t wire)
+    {
+        Reader sub;
+        switch(wire)
+        {
+            case 0:GetVarint(r);
+            break;
+            case 1:GetFixed32(r);
+            GetFixed32(r);
+            break;
+            case 2:GetSub(r, sub);
+            break;
+            case 5:GetFixed32(r);
+            break;
+            default:r.ok = false;
+            break;
+        }
+    }
+}
+#endif  // POMELOC_CPP_RUNTIME_
+namespace chat
+{
+    namespace chatHandler
+    {
+        struct recv
+        {
+            static const char* route()
+            {
+                return "chat.chatHandler.recv";
+            }
+            static uint16_t route_id()
+            {
+                return 1;
+            }
+            typedef void response;
+            struct Vec3
+            {
+                struct Vec2
+                {
+                    int32_t x = 0;
+                    int32_t y = 0;
+                    mutable uint32_t cached_size_ = 0;
+                    uint32_t ByteSize() const
+                    {
+                        uint32_t n = 0;
+                        n += 1 + pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(x));
+                        n += 1 + pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(y));
+                        cached_size_ = n;
+                        return n;
+                    }
+                    void Write(pomeloc_rt::Writer& w) const
+                    {
+                        pomeloc_rt::PutVarint(w, 8);
+                        pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(x));
+                        pomeloc_rt::PutVarint(w, 16);
+                        pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(y));
+                    }
+                    bool Read(pomeloc_rt::Reader& r)
+                    {
+                        while(r.ok && r.p < r.end)
+                        {
+                            uint32_t tag = pomeloc_rt::GetVarint(r);
+                            switch(tag)
+                            {
+                                case 8:x = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                                break;
+                                case 16:y = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                                break;
+                                default:pomeloc_rt::Skip(r, tag & 7);
+                                break;
+                            }
+                        }
+                        return r.ok;
+                    }
+                    bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+                    {
+                        uint32_t n = ByteSize();
+                        if(n > cap)
+                        {
+                            return false;
+                        }
+                        pomeloc_rt::Writer w = {buf};
+                        Write(w);
+                        *len = n;
+                        return true;
+                    }
+                    bool Decode(const uint8_t* buf, size_t len)
+                    {
+                        *this = Vec2();
+                        pomeloc_rt::Reader r = {buf, buf + len, true};
+                        return Read(r);
+                    }
+                };
+                float x = 0.0f;
+                float y = 0.0f;
+                float z = 0.0f;
+                Vec2 xx;
+                bool has_xx = false;
+                std::vector<Vec2> xxx;
+                mutable uint32_t cached_size_ = 0;
+                uint32_t ByteSize() const
+                {
+                    uint32_t n = 0;
+                    n += 1 + 4;
+                    n += 1 + 4;
+                    n += 1 + 4;
+                    if(has_xx)
+                    {
+                        n += 1 + pomeloc_rt::MessageSize(xx.ByteSize());
+                    }
+                    for(const auto& e : xxx)
+                    {
+                        n += 1 + pomeloc_rt::MessageSize(e.ByteSize());
+                    }
+                    cached_size_ = n;
+                    return n;
+                }
+                void Write(pomeloc_rt::Writer& w) const
+                {
+                    pomeloc_rt::PutVarint(w, 13);
+                    pomeloc_rt::PutFloat(w, x);
+                    pomeloc_rt::PutVarint(w, 21);
+                    pomeloc_rt::PutFloat(w, y);
+                    pomeloc_rt::PutVarint(w, 29);
+                    pomeloc_rt::PutFloat(w, z);
+                    if(has_xx)
+                    {
+                        pomeloc_rt::PutVarint(w, 34);
+                        pomeloc_rt::PutVarint(w, xx.cached_size_);
+                        xx.Write(w);
+                    }
+                    for(const auto& e : xxx)
+                    {
+                        pomeloc_rt::PutVarint(w, 42);
+                        pomeloc_rt::PutVarint(w, e.cached_size_);
+                        e.Write(w);
+                    }
+                }
+                bool Read(pomeloc_rt::Reader& r)
+                {
+                    while(r.ok && r.p < r.end)
+                    {
+                        uint32_t tag = pomeloc_rt::GetVarint(r);
+                        switch(tag)
+                        {
+                            case 13:x = pomeloc_rt::GetFloat(r);
+                            break;
+                            case 21:y = pomeloc_rt::GetFloat(r);
+                            break;
+                            case 29:z = pomeloc_rt::GetFloat(r);
+                            break;
+                            case 34:
+                            {
+                                pomeloc_rt::Reader sub;
+                                if(!pomeloc_rt::GetSub(r, sub) || !xx.Read(sub))
+                                {
+                                    return false;
+                                }
+                            }
+                            has_xx = true;
+                            break;
+                            case 42:xxx.emplace_back();
+                            {
+                                pomeloc_rt::Reader sub;
+                                if(!pomeloc_rt::GetSub(r, sub) || !xxx.back().Read(sub))
+                                {
+                                    return false;
+                                }
+                            }
+                            break;
+                            default:pomeloc_rt::Skip(r, tag & 7);
+                            break;
+                        }
+                    }
+                    return r.ok;
+                }
+                bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+                {
+                    uint32_t n = ByteSize();
+                    if(n > cap)
+                    {
+                        return false;
+                    }
+                    pomeloc_rt::Writer w = {buf};
+                    Write(w);
+                    *len = n;
+                    return true;
+                }
+                bool Decode(const uint8_t* buf, size_t len)
+                {
+                    *this = Vec3();
+                    pomeloc_rt::Reader r = {buf, buf + len, true};
+                    return Read(r);
+                }
+            };
+            int32_t x = 0;
+            int32_t y = 0;
+            int32_t z = 0;
+            Vec3 pos;
+            bool has_pos = false;
+            mutable uint32_t cached_size_ = 0;
+            uint32_t ByteSize() const
+            {
+                uint32_t n = 0;
+                n += 1 + pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(x));
+                n += 1 + pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(y));
+                n += 1 + pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(z));
+                if(has_pos)
+                {
+                    n += 1 + pomeloc_rt::MessageSize(pos.ByteSize());
+                }
+                cached_size_ = n;
+                return n;
+            }
+            void Write(pomeloc_rt::Writer& w) const
+            {
+                pomeloc_rt::PutVarint(w, 8);
+                pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(x));
+                pomeloc_rt::PutVarint(w, 16);
+                pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(y));
+                pomeloc_rt::PutVarint(w, 24);
+                pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(z));
+                if(has_pos)
+                {
+                    pomeloc_rt::PutVarint(w, 34);
+                    pomeloc_rt::PutVarint(w, pos.cached_size_);
+                    pos.Write(w);
+                }
+            }
+            bool Read(pomeloc_rt::Reader& r)
+            {
+                while(r.ok && r.p < r.end)
+                {
+                    uint32_t tag = pomeloc_rt::GetVarint(r);
+                    switch(tag)
+                    {
+                        case 8:x = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                        break;
+                        case 16:y = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                        break;
+                        case 24:z = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                        break;
+                        case 34:
+                        {
+                            pomeloc_rt::Reader sub;
+                            if(!pomeloc_rt::GetSub(r, sub) || !pos.Read(sub))
+                            {
+                                return false;
+                            }
+                        }
+                        has_pos = true;
+                        break;
+                        default:pomeloc_rt::Skip(r, tag & 7);
+                        break;
+                    }
+                }
+                return r.ok;
+            }
+            bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+            {
+                uint32_t n = ByteSize();
+                if(n > cap)
+                {
+                    return false;
+                }
+                pomeloc_rt::Writer w = {buf};
+                Write(w);
+                *len = n;
+                return true;
+            }
+            bool Decode(const uint8_t* buf, size_t len)
+            {
+                *this = recv();
+                pomeloc_rt::Reader r = {buf, buf + len, true};
+                return Read(r);
+            }
+        };
+    }
+}
+namespace chat
+{
+    namespace chatHandler
+    {
+        struct send
+        {
+            static const char* route()
+            {
+                return "chat.chatHandler.send";
+            }
+            static uint16_t route_id()
+            {
+                return 2;
+            }
+            typedef void response;
+            struct Vec3
+            {
+                struct Vec2
+                {
+                    int32_t x = 0;
+                    int32_t y = 0;
+                    mutable uint32_t cached_size_ = 0;
+                    uint32_t ByteSize() const
+                    {
+                        uint32_t n = 0;
+                        n += 1 + pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(x));
+                        n += 1 + pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(y));
+                        cached_size_ = n;
+                        return n;
+                    }
+                    void Write(pomeloc_rt::Writer& w) const
+                    {
+                        pomeloc_rt::PutVarint(w, 8);
+                        pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(x));
+                        pomeloc_rt::PutVarint(w, 16);
+                        pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(y));
+                    }
+                    bool Read(pomeloc_rt::Reader& r)
+                    {
+                        while(r.ok && r.p < r.end)
+                        {
+                            uint32_t tag = pomeloc_rt::GetVarint(r);
+                            switch(tag)
+                            {
+                                case 8:x = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                                break;
+                                case 16:y = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                                break;
+                                default:pomeloc_rt::Skip(r, tag & 7);
+                                break;
+                            }
+                        }
+                        return r.ok;
+                    }
+                    bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+                    {
+                        uint32_t n = ByteSize();
+                        if(n > cap)
+                        {
+                            return false;
+                        }
+                        pomeloc_rt::Writer w = {buf};
+                        Write(w);
+                        *len = n;
+                        return true;
+                    }
+                    bool Decode(const uint8_t* buf, size_t len)
+                    {
+                        *this = Vec2();
+                        pomeloc_rt::Reader r = {buf, buf + len, true};
+                        return Read(r);
+                    }
+                };
+                float x = 0.0f;
+                float y = 0.0f;
+                float z = 0.0f;
+                Vec2 xx;
+                bool has_xx = false;
+                std::vector<Vec2> xxx;
+                mutable uint32_t cached_size_ = 0;
+                uint32_t ByteSize() const
+                {
+                    uint32_t n = 0;
+                    n += 1 + 4;
+                    n += 1 + 4;
+                    n += 1 + 4;
+                    if(has_xx)
+                    {
+                        n += 1 + pomeloc_rt::MessageSize(xx.ByteSize());
+                    }
+                    for(const auto& e : xxx)
+                    {
+                        n += 1 + pomeloc_rt::MessageSize(e.ByteSize());
+                    }
+                    cached_size_ = n;
+                    return n;
+                }
+                void Write(pomeloc_rt::Writer& w) const
+                {
+                    pomeloc_rt::PutVarint(w, 13);
+                    pomeloc_rt::PutFloat(w, x);
+                    pomeloc_rt::PutVarint(w, 21);
+                    pomeloc_rt::PutFloat(w, y);
+                    pomeloc_rt::PutVarint(w, 29);
+                    pomeloc_rt::PutFloat(w, z);
+                    if(has_xx)
+                    {
+                        pomeloc_rt::PutVarint(w, 34);
+                        pomeloc_rt::PutVarint(w, xx.cached_size_);
+                        xx.Write(w);
+                    }
+                    for(const auto& e : xxx)
+                    {
+                        pomeloc_rt::PutVarint(w, 42);
+                        pomeloc_rt::PutVarint(w, e.cached_size_);
+                        e.Write(w);
+                    }
+                }
+                bool Read(pomeloc_rt::Reader& r)
+                {
+                    while(r.ok && r.p < r.end)
+                    {
+                        uint32_t tag = pomeloc_rt::GetVarint(r);
+                        switch(tag)
+                        {
+                            case 13:x = pomeloc_rt::GetFloat(r);
+                            break;
+                            case 21:y = pomeloc_rt::GetFloat(r);
+                            break;
+                            case 29:z = pomeloc_rt::GetFloat(r);
+                            break;
+                            case 34:
+                            {
+                                pomeloc_rt::Reader sub;
+                                if(!pomeloc_rt::GetSub(r, sub) || !xx.Read(sub))
+                                {
+                                    return false;
+                                }
+                            }
+                            has_xx = true;
+                            break;
+                            case 42:xxx.emplace_back();
+                            {
+                                pomeloc_rt::Reader sub;
+                                if(!pomeloc_rt::GetSub(r, sub) || !xxx.back().Read(sub))
+                                {
+                                    return false;
+                                }
+                            }
+                            break;
+                            default:pomeloc_rt::Skip(r, tag & 7);
+                            break;
+                        }
+                    }
+                    return r.ok;
+                }
+                bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+                {
+                    uint32_t n = ByteSize();
+                    if(n > cap)
+                    {
+                        return false;
+                    }
+                    pomeloc_rt::Writer w = {buf};
+                    Write(w);
+                    *len = n;
+                    return true;
+                }
+                bool Decode(const uint8_t* buf, size_t len)
+                {
+                    *this = Vec3();
+                    pomeloc_rt::Reader r = {buf, buf + len, true};
+                    return Read(r);
+                }
+            };
+            std::string rid;
+            std::string content;
+            int32_t opti = 0;
+            std::string from;
+            std::string target;
+            Vec3 pos;
+            bool has_pos = false;
+            std::vector<Vec3> positions;
+            mutable uint32_t cached_size_ = 0;
+            uint32_t ByteSize() const
+            {
+                uint32_t n = 0;
+                n += 1 + pomeloc_rt::StringSize(rid);
+                n += 1 + pomeloc_rt::StringSize(content);
+                n += 1 + pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(opti));
+                n += 1 + pomeloc_rt::StringSize(from);
+                n += 1 + pomeloc_rt::StringSize(target);
+                if(has_pos)
+                {
+                    n += 1 + pomeloc_rt::MessageSize(pos.ByteSize());
+                }
+                for(const auto& e : positions)
+                {
+                    n += 1 + pomeloc_rt::MessageSize(e.ByteSize());
+                }
+                cached_size_ = n;
+                return n;
+            }
+            void Write(pomeloc_rt::Writer& w) const
+            {
+                pomeloc_rt::PutVarint(w, 10);
+                pomeloc_rt::PutString(w, rid);
+                pomeloc_rt::PutVarint(w, 18);
+                pomeloc_rt::PutString(w, content);
+                pomeloc_rt::PutVarint(w, 24);
+                pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(opti));
+                pomeloc_rt::PutVarint(w, 34);
+                pomeloc_rt::PutString(w, from);
+                pomeloc_rt::PutVarint(w, 42);
+                pomeloc_rt::PutString(w, target);
+                if(has_pos)
+                {
+                    pomeloc_rt::PutVarint(w, 50);
+                    pomeloc_rt::PutVarint(w, pos.cached_size_);
+                    pos.Write(w);
+                }
+                for(const auto& e : positions)
+                {
+                    pomeloc_rt::PutVarint(w, 58);
+                    pomeloc_rt::PutVarint(w, e.cached_size_);
+                    e.Write(w);
+                }
+            }
+            bool Read(pomeloc_rt::Reader& r)
+            {
+                while(r.ok && r.p < r.end)
+                {
+                    uint32_t tag = pomeloc_rt::GetVarint(r);
+                    switch(tag)
+                    {
+                        case 10:pomeloc_rt::GetString(r, rid);
+                        break;
+                        case 18:pomeloc_rt::GetString(r, content);
+                        break;
+                        case 24:opti = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                        break;
+                        case 34:pomeloc_rt::GetString(r, from);
+                        break;
+                        case 42:pomeloc_rt::GetString(r, target);
+                        break;
+                        case 50:
+                        {
+                            pomeloc_rt::Reader sub;
+                            if(!pomeloc_rt::GetSub(r, sub) || !pos.Read(sub))
+                            {
+                                return false;
+                            }
+                        }
+                        has_pos = true;
+                        break;
+                        case 58:positions.emplace_back();
+                        {
+                            pomeloc_rt::Reader sub;
+                            if(!pomeloc_rt::GetSub(r, sub) || !positions.back().Read(sub))
+                            {
+                                return false;
+                            }
+                        }
+                        break;
+                        default:pomeloc_rt::Skip(r, tag & 7);
+                        break;
+                    }
+                }
+                return r.ok;
+            }
+            bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+            {
+                uint32_t n = ByteSize();
+                if(n > cap)
+                {
+                    return false;
+                }
+                pomeloc_rt::Writer w = {buf};
+                Write(w);
+                *len = n;
+                return true;
+            }
+            bool Decode(const uint8_t* buf, size_t len)
+            {
+                *this = send();
+                pomeloc_rt::Reader r = {buf, buf + len, true};
+                return Read(r);
+            }
+        };
+    }
+}
+namespace connector
+{
+    namespace entryHandler
+    {
+        struct enter
+        {
+            static const char* route()
+            {
+                return "connector.entryHandler.enter";
+            }
+            static uint16_t route_id()
+            {
+                return 3;
+            }
+            typedef void response;
+            std::string username;
+            std::string rid;
+            mutable uint32_t cached_size_ = 0;
+            uint32_t ByteSize() const
+            {
+                uint32_t n = 0;
+                n += 1 + pomeloc_rt::StringSize(username);
+                n += 1 + pomeloc_rt::StringSize(rid);
+                cached_size_ = n;
+                return n;
+            }
+            void Write(pomeloc_rt::Writer& w) const
+            {
+                pomeloc_rt::PutVarint(w, 10);
+                pomeloc_rt::PutString(w, username);
+                pomeloc_rt::PutVarint(w, 18);
+                pomeloc_rt::PutString(w, rid);
+            }
+            bool Read(pomeloc_rt::Reader& r)
+            {
+                while(r.ok && r.p < r.end)
+                {
+                    uint32_t tag = pomeloc_rt::GetVarint(r);
+                    switch(tag)
+                    {
+                        case 10:pomeloc_rt::GetString(r, username);
+                        break;
+                        case 18:pomeloc_rt::GetString(r, rid);
+                        break;
+                        default:pomeloc_rt::Skip(r, tag & 7);
+                        break;
+                    }
+                }
+                return r.ok;
+            }
+            bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+            {
+                uint32_t n = ByteSize();
+                if(n > cap)
+                {
+                    return false;
+                }
+                pomeloc_rt::Writer w = {buf};
+                Write(w);
+                *len = n;
+                return true;
+            }
+            bool Decode(const uint8_t* buf, size_t len)
+            {
+                *this = enter();
+                pomeloc_rt::Reader r = {buf, buf + len, true};
+                return Read(r);
+            }
+        };
+    }
+}
+namespace gate
+{
+    namespace gateHandler
+    {
+        struct queryEntry_result
+        {
+            static const char* route()
+            {
+                return "gate.gateHandler.queryEntry";
+            }
+            static uint16_t route_id()
+            {
+                return 4;
+            }
+            struct Vec3
+            {
+                struct Vec2
+                {
+                    int32_t x = 0;
+                    int32_t y = 0;
+                    mutable uint32_t cached_size_ = 0;
+                    uint32_t ByteSize() const
+                    {
+                        uint32_t n = 0;
+                        n += 1 + pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(x));
+                        n += 1 + pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(y));
+                        cached_size_ = n;
+                        return n;
+                    }
+                    void Write(pomeloc_rt::Writer& w) const
+                    {
+                        pomeloc_rt::PutVarint(w, 8);
+                        pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(x));
+                        pomeloc_rt::PutVarint(w, 16);
+                        pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(y));
+                    }
+                    bool Read(pomeloc_rt::Reader& r)
+                    {
+                        while(r.ok && r.p < r.end)
+                        {
+                            uint32_t tag = pomeloc_rt::GetVarint(r);
+                            switch(tag)
+                            {
+                                case 8:x = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                                break;
+                                case 16:y = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                                break;
+                                default:pomeloc_rt::Skip(r, tag & 7);
+                                break;
+                            }
+                        }
+                        return r.ok;
+                    }
+                    bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+                    {
+                        uint32_t n = ByteSize();
+                        if(n > cap)
+                        {
+                            return false;
+                        }
+                        pomeloc_rt::Writer w = {buf};
+                        Write(w);
+                        *len = n;
+                        return true;
+                    }
+                    bool Decode(const uint8_t* buf, size_t len)
+                    {
+                        *this = Vec2();
+                        pomeloc_rt::Reader r = {buf, buf + len, true};
+                        return Read(r);
+                    }
+                };
+                float x = 0.0f;
+                float y = 0.0f;
+                float z = 0.0f;
+                Vec2 xx;
+                bool has_xx = false;
+                std::vector<Vec2> xxx;
+                mutable uint32_t cached_size_ = 0;
+                uint32_t ByteSize() const
+                {
+                    uint32_t n = 0;
+                    n += 1 + 4;
+                    n += 1 + 4;
+                    n += 1 + 4;
+                    if(has_xx)
+                    {
+                        n += 1 + pomeloc_rt::MessageSize(xx.ByteSize());
+                    }
+                    for(const auto& e : xxx)
+                    {
+                        n += 1 + pomeloc_rt::MessageSize(e.ByteSize());
+                    }
+                    cached_size_ = n;
+                    return n;
+                }
+                void Write(pomeloc_rt::Writer& w) const
+                {
+                    pomeloc_rt::PutVarint(w, 13);
+                    pomeloc_rt::PutFloat(w, x);
+                    pomeloc_rt::PutVarint(w, 21);
+                    pomeloc_rt::PutFloat(w, y);
+                    pomeloc_rt::PutVarint(w, 29);
+                    pomeloc_rt::PutFloat(w, z);
+                    if(has_xx)
+                    {
+                        pomeloc_rt::PutVarint(w, 34);
+                        pomeloc_rt::PutVarint(w, xx.cached_size_);
+                        xx.Write(w);
+                    }
+                    for(const auto& e : xxx)
+                    {
+                        pomeloc_rt::PutVarint(w, 42);
+                        pomeloc_rt::PutVarint(w, e.cached_size_);
+                        e.Write(w);
+                    }
+                }
+                bool Read(pomeloc_rt::Reader& r)
+                {
+                    while(r.ok && r.p < r.end)
+                    {
+                        uint32_t tag = pomeloc_rt::GetVarint(r);
+                        switch(tag)
+                        {
+                            case 13:x = pomeloc_rt::GetFloat(r);
+                            break;
+                            case 21:y = pomeloc_rt::GetFloat(r);
+                            break;
+                            case 29:z = pomeloc_rt::GetFloat(r);
+                            break;
+                            case 34:
+                            {
+                                pomeloc_rt::Reader sub;
+                                if(!pomeloc_rt::GetSub(r, sub) || !xx.Read(sub))
+                                {
+                                    return false;
+                                }
+                            }
+                            has_xx = true;
+                            break;
+                            case 42:xxx.emplace_back();
+                            {
+                                pomeloc_rt::Reader sub;
+                                if(!pomeloc_rt::GetSub(r, sub) || !xxx.back().Read(sub))
+                                {
+                                    return false;
+                                }
+                            }
+                            break;
+                            default:pomeloc_rt::Skip(r, tag & 7);
+                            break;
+                        }
+                    }
+                    return r.ok;
+                }
+                bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+                {
+                    uint32_t n = ByteSize();
+                    if(n > cap)
+                    {
+                        return false;
+                    }
+                    pomeloc_rt::Writer w = {buf};
+                    Write(w);
+                    *len = n;
+                    return true;
+                }
+                bool Decode(const uint8_t* buf, size_t len)
+                {
+                    *this = Vec3();
+                    pomeloc_rt::Reader r = {buf, buf + len, true};
+                    return Read(r);
+                }
+            };
+            int32_t code = 0;
+            std::string host;
+            int32_t port = 0;
+            std::vector<int32_t> xxx;
+            std::vector<Vec3> positions;
+            mutable uint32_t cached_size_ = 0;
+            uint32_t ByteSize() const
+            {
+                uint32_t n = 0;
+                n += 1 + pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(code));
+                n += 1 + pomeloc_rt::StringSize(host);
+                n += 1 + pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(port));
+                if(!xxx.empty())
+                {
+                    n += 1 + pomeloc_rt::VarintSize(static_cast<uint32_t>(xxx.size()));
+                    for(const auto& e : xxx)
+                    {
+                        n += pomeloc_rt::VarintSize(pomeloc_rt::ZigZag(e));
+                    }
+                }
+                for(const auto& e : positions)
+                {
+                    n += 1 + pomeloc_rt::MessageSize(e.ByteSize());
+                }
+                cached_size_ = n;
+                return n;
+            }
+            void Write(pomeloc_rt::Writer& w) const
+            {
+                pomeloc_rt::PutVarint(w, 8);
+                pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(code));
+                pomeloc_rt::PutVarint(w, 18);
+                pomeloc_rt::PutString(w, host);
+                pomeloc_rt::PutVarint(w, 24);
+                pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(port));
+                if(!xxx.empty())
+                {
+                    pomeloc_rt::PutVarint(w, 32);
+                    pomeloc_rt::PutVarint(w, static_cast<uint32_t>(xxx.size()));
+                    for(const auto& e : xxx)
+                    {
+                        pomeloc_rt::PutVarint(w, pomeloc_rt::ZigZag(e));
+                    }
+                }
+                for(const auto& e : positions)
+                {
+                    pomeloc_rt::PutVarint(w, 42);
+                    pomeloc_rt::PutVarint(w, e.cached_size_);
+                    e.Write(w);
+                }
+            }
+            bool Read(pomeloc_rt::Reader& r)
+            {
+                while(r.ok && r.p < r.end)
+                {
+                    uint32_t tag = pomeloc_rt::GetVarint(r);
+                    switch(tag)
+                    {
+                        case 8:code = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                        break;
+                        case 18:pomeloc_rt::GetString(r, host);
+                        break;
+                        case 24:port = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                        break;
+                        case 32:
+                        {
+                            uint32_t count = pomeloc_rt::GetVarint(r);
+                            if(!r.ok || count > static_cast<size_t>(r.end - r.p))
+                            {
+                                return false;
+                            }
+                            size_t base = xxx.size();
+                            xxx.resize(base + count);
+                            for(size_t i = base; i < base + count; ++i)
+                            {
+                                xxx[i] = pomeloc_rt::UnZigZag(pomeloc_rt::GetVarint(r));
+                            }
+                        }
+                        break;
+                        case 42:positions.emplace_back();
+                        {
+                            pomeloc_rt::Reader sub;
+                            if(!pomeloc_rt::GetSub(r, sub) || !positions.back().Read(sub))
+                            {
+                                return false;
+                            }
+                        }
+                        break;
+                        default:pomeloc_rt::Skip(r, tag & 7);
+                        break;
+                    }
+                }
+                return r.ok;
+            }
+            bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+            {
+                uint32_t n = ByteSize();
+                if(n > cap)
+                {
+                    return false;
+                }
+                pomeloc_rt::Writer w = {buf};
+                Write(w);
+                *len = n;
+                return true;
+            }
+            bool Decode(const uint8_t* buf, size_t len)
+            {
+                *this = queryEntry_result();
+                pomeloc_rt::Reader r = {buf, buf + len, true};
+                return Read(r);
+            }
+        };
+        struct queryEntry
+        {
+            static const char* route()
+            {
+                return "gate.gateHandler.queryEntry";
+            }
+            static uint16_t route_id()
+            {
+                return 4;
+            }
+            typedef queryEntry_result response;
+            std::string uid;
+            mutable uint32_t cached_size_ = 0;
+            uint32_t ByteSize() const
+            {
+                uint32_t n = 0;
+                n += 1 + pomeloc_rt::StringSize(uid);
+                cached_size_ = n;
+                return n;
+            }
+            void Write(pomeloc_rt::Writer& w) const
+            {
+                pomeloc_rt::PutVarint(w, 10);
+                pomeloc_rt::PutString(w, uid);
+            }
+            bool Read(pomeloc_rt::Reader& r)
+            {
+                while(r.ok && r.p < r.end)
+                {
+                    uint32_t tag = pomeloc_rt::GetVarint(r);
+                    switch(tag)
+                    {
+                        case 10:pomeloc_rt::GetString(r, uid);
+                        break;
+                        default:pomeloc_rt::Skip(r, tag & 7);
+                        break;
+                    }
+                }
+                return r.ok;
+            }
+            bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+            {
+                uint32_t n = ByteSize();
+                if(n > cap)
+                {
+                    return false;
+                }
+                pomeloc_rt::Writer w = {buf};
+                Write(w);
+                *len = n;
+                return true;
+            }
+            bool Decode(const uint8_t* buf, size_t len)
+            {
+                *this = queryEntry();
+                pomeloc_rt::Reader r = {buf, buf + len, true};
+                return Read(r);
+            }
+        };
+    }
+}
+namespace ServerEvent
+{
+    struct onAdd_event
+    {
+        static const char* route()
+        {
+            return "onAdd";
+        }
+        static uint16_t route_id()
+        {
+            return 5;
+        }
+        std::string user;
+        mutable uint32_t cached_size_ = 0;
+        uint32_t ByteSize() const
+        {
+            uint32_t n = 0;
+            n += 1 + pomeloc_rt::StringSize(user);
+            cached_size_ = n;
+            return n;
+        }
+        void Write(pomeloc_rt::Writer& w) const
+        {
+            pomeloc_rt::PutVarint(w, 10);
+            pomeloc_rt::PutString(w, user);
+        }
+        bool Read(pomeloc_rt::Reader& r)
+        {
+            while(r.ok && r.p < r.end)
+            {
+                uint32_t tag = pomeloc_rt::GetVarint(r);
+                switch(tag)
+                {
+                    case 10:pomeloc_rt::GetString(r, user);
+                    break;
+                    default:pomeloc_rt::Skip(r, tag & 7);
+                    break;
+                }
+            }
+            return r.ok;
+        }
+        bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+        {
+            uint32_t n = ByteSize();
+            if(n > cap)
+            {
+                return false;
+            }
+            pomeloc_rt::Writer w = {buf};
+            Write(w);
+            *len = n;
+            return true;
+        }
+        bool Decode(const uint8_t* buf, size_t len)
+        {
+            *this = onAdd_event();
+            pomeloc_rt::Reader r = {buf, buf + len, true};
+            return Read(r);
+        }
+    };
+    struct onChat_event
+    {
+        static const char* route()
+        {
+            return "onChat";
+        }
+        static uint16_t route_id()
+        {
+            return 6;
+        }
+        std::string msg;
+        std::string from;
+        std::string target;
+        mutable uint32_t cached_size_ = 0;
+        uint32_t ByteSize() const
+        {
+            uint32_t n = 0;
+            n += 1 + pomeloc_rt::StringSize(msg);
+            n += 1 + pomeloc_rt::StringSize(from);
+            n += 1 + pomeloc_rt::StringSize(target);
+            cached_size_ = n;
+            return n;
+        }
+        void Write(pomeloc_rt::Writer& w) const
+        {
+            pomeloc_rt::PutVarint(w, 10);
+            pomeloc_rt::PutString(w, msg);
+            pomeloc_rt::PutVarint(w, 18);
+            pomeloc_rt::PutString(w, from);
+            pomeloc_rt::PutVarint(w, 26);
+            pomeloc_rt::PutString(w, target);
+        }
+        bool Read(pomeloc_rt::Reader& r)
+        {
+            while(r.ok && r.p < r.end)
+            {
+                uint32_t tag = pomeloc_rt::GetVarint(r);
+                switch(tag)
+                {
+                    case 10:pomeloc_rt::GetString(r, msg);
+                    break;
+                    case 18:pomeloc_rt::GetString(r, from);
+                    break;
+                    case 26:pomeloc_rt::GetString(r, target);
+                    break;
+                    default:pomeloc_rt::Skip(r, tag & 7);
+                    break;
+                }
+            }
+            return r.ok;
+        }
+        bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+        {
+            uint32_t n = ByteSize();
+            if(n > cap)
+            {
+                return false;
+            }
+            pomeloc_rt::Writer w = {buf};
+            Write(w);
+            *len = n;
+            return true;
+        }
+        bool Decode(const uint8_t* buf, size_t len)
+        {
+            *this = onChat_event();
+            pomeloc_rt::Reader r = {buf, buf + len, true};
+            return Read(r);
+        }
+    };
+    struct onLeave_event
+    {
+        static const char* route()
+        {
+            return "onLeave";
+        }
+        static uint16_t route_id()
+        {
+            return 7;
+        }
+        std::string user;
+        mutable uint32_t cached_size_ = 0;
+        uint32_t ByteSize() const
+        {
+            uint32_t n = 0;
+            n += 1 + pomeloc_rt::StringSize(user);
+            cached_size_ = n;
+            return n;
+        }
+        void Write(pomeloc_rt::Writer& w) const
+        {
+            pomeloc_rt::PutVarint(w, 10);
+            pomeloc_rt::PutString(w, user);
+        }
+        bool Read(pomeloc_rt::Reader& r)
+        {
+            while(r.ok && r.p < r.end)
+            {
+                uint32_t tag = pomeloc_rt::GetVarint(r);
+                switch(tag)
+                {
+                    case 10:pomeloc_rt::GetString(r, user);
+                    break;
+                    default:pomeloc_rt::Skip(r, tag & 7);
+                    break;
+                }
+            }
+            return r.ok;
+        }
+        bool Encode(uint8_t* buf, size_t cap, size_t* len) const
+        {
+            uint32_t n = ByteSize();
+            if(n > cap)
+            {
+                return false;
+            }
+            pomeloc_rt::Writer w = {buf};
+            Write(w);
+            *len = n;
+            return true;
+        }
+        bool Decode(const uint8_t* buf, size_t len)
+        {
+            *this = onLeave_event();
+            pomeloc_rt::Reader r = {buf, buf + len, true};
+            return Read(r);
+        }
+    };
+}
+#endif  // POMELOC_GENERATED_CLIENTPROTOS_H_
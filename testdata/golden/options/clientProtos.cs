@@ -0,0 +1,2317 @@
+using System;
+using LitJson;
+using Pomelo.DotNetClient;
+[System.Runtime.InteropServices.StructLayout(System.Runtime.InteropServices.LayoutKind.Explicit)]public struct ProtoBits
+{
+    [System.Runtime.InteropServices.FieldOffset(0)]public float f;
+    [System.Runtime.InteropServices.FieldOffset(0)]public uint u;
+}
+public class ProtoWriter
+{
+    public byte[] buffer;
+    public int position;
+    [System.ThreadStatic]static ProtoWriter shared;
+    public static ProtoWriter Shared
+    {
+        get
+        {
+            if(shared == null)
+            {
+                shared = new ProtoWriter(256);
+            }
+            shared.position = 0;
+            return shared;
+        }
+    }
+    public ProtoWriter(int capacity)
+    {
+        buffer = new byte[capacity > 0 ? capacity : 16];
+        position = 0;
+    }
+    public void Ensure(int n)
+    {
+        if(position + n > buffer.Length)
+        {
+            System.Array.Resize(ref buffer, System.Math.Max(buffer.Length * 2, position + n));
+        }
+    }
+    public static int VarintSize(uint v)
+    {
+        int n = 1;
+        while(v > 0x7F)
+        {
+            v >>= 7;
+            ++n;
+        }
+        return n;
+    }
+    public static int SInt32Size(int v)
+    {
+        return VarintSize((uint)((v << 1) ^ (v >> 31)));
+    }
+    public static int StringSize(string v)
+    {
+        if(v == null)
+        {
+            return 1;
+        }
+        int len = System.Text.Encoding.UTF8.GetByteCount(v);
+        return VarintSize((uint)len) + len;
+    }
+    public static int MessageSize(int len)
+    {
+        return VarintSize((uint)len) + len;
+    }
+    public void WriteUInt32(uint v)
+    {
+        if(position + 5 > buffer.Length)
+        {
+            Ensure(VarintSize(v));
+        }
+        while(v > 0x7F)
+        {
+            buffer[position++] = (byte)(v | 0x80);
+            v >>= 7;
+        }
+        buffer[position++] = (byte)v;
+    }
+    public void WriteSInt32(int v)
+    {
+        WriteUInt32((uint)((v << 1) ^ (v >> 31)));
+    }
+    public void WriteTag(int index, int wireType)
+    {
+        WriteUInt32((uint)((index << 3) | wireType));
+    }
+    public void WriteFixed32(uint v)
+    {
+        Ensure(4);
+        buffer[position++] = (byte)v;
+        buffer[position++] = (byte)(v >> 8);
+        buffer[position++] = (byte)(v >> 16);
+        buffer[position++] = (byte)(v >> 24);
+    }
+    public void WriteFloat(float v)
+    {
+        ProtoBits bits = new ProtoBits();
+        bits.f = v;
+        WriteFixed32(bits.u);
+    }
+    public void WriteDouble(double v)
+    {
+        ulong u = (ulong)System.BitConverter.DoubleToInt64Bits(v);
+        WriteFixed32((uint)u);
+        WriteFixed32((uint)(u >> 32));
+    }
+    public void WriteString(string v)
+    {
+        if(v == null)
+        {
+            WriteUInt32(0);
+            return;
+        }
+        int len = System.Text.Encoding.UTF8.GetByteCount(v);
+        WriteUInt32((uint)len);
+        Ensure(len);
+        System.Text.Encoding.UTF8.GetBytes(v, 0, v.Length, buffer, position);
+        position += len;
+    }
+    public int BeginMessage()
+    {
+        return position;
+    }
+    public void EndMessage(int start)
+    {
+        int len = position - start;
+        int n = VarintSize((uint)len);
+        Ensure(n);
+        System.Buffer.BlockCopy(buffer, start, buffer, start + n, len);
+        position = start;
+        WriteUInt32((uint)len);
+        position += len;
+    }
+    [System.ThreadStatic]static ProtoWriter wrapper;
+    public static ProtoWriter Wrap(byte[] buf, int offset, int size)
+    {
+        if(buf == null || offset < 0 || buf.Length - offset < size)
+        {
+            throw new System.ArgumentException("buffer too small");
+        }
+        if(wrapper == null)
+        {
+            wrapper = new ProtoWriter(1);
+        }
+        wrapper.buffer = buf;
+        wrapper.position = offset;
+        return wrapper;
+    }
+    public void Unwrap()
+    {
+        buffer = null;
+        position = 0;
+    }
+    public byte[] ToArray()
+    {
+        byte[] ret = new byte[position];
+        System.Buffer.BlockCopy(buffer, 0, ret, 0, position);
+        return ret;
+    }
+}
+public static class ProtoReader
+{
+    public static uint ReadUInt32(byte[] buf, ref int pos)
+    {
+        uint v = 0;
+        int shift = 0;
+        byte b;
+        do
+        {
+            b = buf[pos++];
+            if(shift < 32)
+            {
+                v |= (uint)(b & 0x7F) << shift;
+            }
+            shift += 7;
+        }
+        while((b & 0x80) != 0);
+        return v;
+    }
+    public static int ReadSInt32(byte[] buf, ref int pos)
+    {
+        uint v = ReadUInt32(buf, ref pos);
+        return (int)(v >> 1) ^ -(int)(v & 1);
+    }
+    public static uint ReadFixed32(byte[] buf, ref int pos)
+    {
+        uint v = (uint)(buf[pos] | (buf[pos + 1] << 8) | (buf[pos + 2] << 16) | (buf[pos + 3] << 24));
+        pos += 4;
+        return v;
+    }
+    public static float ReadFloat(byte[] buf, ref int pos)
+    {
+        ProtoBits bits = new ProtoBits();
+        bits.u = ReadFixed32(buf, ref pos);
+        return bits.f;
+    }
+    public static double ReadDouble(byte[] buf, ref int pos)
+    {
+        ulong lo = ReadFixed32(buf, ref pos);
+        ulong hi = ReadFixed32(buf, ref pos);
+        return System.BitConverter.Int64BitsToDouble((long)(lo | (hi << 32)));
+    }
+    public static string ReadString(byte[] buf, ref int pos)
+    {
+        int len = (int)ReadUInt32(buf, ref pos);
+        string v = System.Text.Encoding.UTF8.GetString(buf, pos, len);
+        pos += len;
+        return v;
+    }
+    public static void Skip(byte[] buf, ref int pos, int wireType)
+    {
+        switch(wireType)
+        {
+            case 0:ReadUInt32(buf, ref pos);
+            break;
+            case 1:pos += 8;
+            break;
+            case 2:
+            {
+                int len = (int)ReadUInt32(buf, ref pos);
+                pos += len;
+            }
+            break;
+            case 5:pos += 4;
+            break;
+            default:throw new System.FormatException("unknown wire type " + wireType);
+        }
+    }
+}
+public static class ProtoJson
+{
+    [System.ThreadStatic]static System.Text.StringBuilder text;
+    [System.ThreadStatic]static JsonWriter writer;
+    [System.ThreadStatic]static char[] chars;
+    public static JsonWriter Begin()
+    {
+        if(writer == null)
+        {
+            text = new System.Text.StringBuilder(256);
+            writer = new JsonWriter(text);
+        }
+        text.Length = 0;
+        writer.Reset();
+        return writer;
+    }
+    public static byte[] End()
+    {
+        int n = text.Length;
+        if(chars == null || chars.Length < n)
+        {
+            chars = new char[System.Math.Max(n, 256)];
+        }
+        text.CopyTo(0, chars, 0, n);
+        return System.Text.Encoding.UTF8.GetBytes(chars, 0, n);
+    }
+    public static void Skip(JsonReader r)
+    {
+        int depth = 0;
+        do
+        {
+            if(r.Token == JsonToken.ObjectStart || r.Token == JsonToken.ArrayStart)
+            {
+                ++depth;
+            }
+            else if(r.Token == JsonToken.ObjectEnd || r.Token == JsonToken.ArrayEnd)
+            {
+                --depth;
+            }
+        }
+        while(depth > 0 && r.Read());
+    }
+    public static int ReadInt(JsonReader r)
+    {
+        switch(r.Token)
+        {
+            case JsonToken.Int:case JsonToken.Long:case JsonToken.Double:return (int)System.Convert.ToInt64(r.Value);
+            default:Skip(r);
+            return 0;
+        }
+    }
+    public static double ReadDouble(JsonReader r)
+    {
+        switch(r.Token)
+        {
+            case JsonToken.Int:case JsonToken.Long:case JsonToken.Double:return System.Convert.ToDouble(r.Value);
+            default:Skip(r);
+            return 0.0;
+        }
+    }
+    public static string ReadString(JsonReader r)
+    {
+        if(r.Token == JsonToken.String)
+        {
+            return (string)r.Value;
+        }
+        Skip(r);
+        return null;
+    }
+}
+public static class ProtoPool<T> where T : new()
+{
+    static readonly System.Collections.Generic.Stack<T> items = new System.Collections.Generic.Stack<T>();
+    public static T Get()
+    {
+        lock(items)
+        {
+            if(items.Count > 0)
+            {
+                return items.Pop();
+            }
+        }
+        return new T();
+    }
+    public static void Put(T v)
+    {
+        lock(items)
+        {
+            items.Push(v);
+        }
+    }
+}
+public static class ProtoPool
+{
+    public static T[] Reuse<T>(T[] current, ref T[] spare, int n)
+    {
+        if(current != null && current.Length == n)
+        {
+            return current;
+        }
+        T[] ret;
+        if(spare != null && spare.Length == n)
+        {
+            ret = spare;
+            spare = current;
+        }
+        else
+        {
+            ret = new T[n];
+            if(current != null)
+            {
+                spare = current;
+            }
+        }
+        return ret;
+    }
+}
+namespace chat
+{
+    public class chatHandler
+    {
+        public static PomeloClient pc = null;
+        public static class Routes
+        {
+            public const ushort recv = 1;
+            public const ushort send = 2;
+        }
+        public static class Requests
+        {
+            public static void recv(ProtoWriter w, int x,int y,int z,recv_Vec3 pos=null)
+            {
+                w.WriteTag(1, 0);
+                w.WriteSInt32(x);
+                w.WriteTag(2, 0);
+                w.WriteSInt32(y);
+                w.WriteTag(3, 0);
+                w.WriteSInt32(z);
+                if(pos != null)
+                {
+                    w.WriteTag(4, 2);
+                    {
+                        int m = w.BeginMessage();
+                        pos.Encode(w);
+                        w.EndMessage(m);
+                    }
+                }
+            }
+            public static void send(ProtoWriter w, string rid,string content,string from,string target,send_Vec3[] positions,int opti=0,send_Vec3 pos=null)
+            {
+                w.WriteTag(1, 2);
+                w.WriteString(rid);
+                w.WriteTag(2, 2);
+                w.WriteString(content);
+                w.WriteTag(3, 0);
+                w.WriteSInt32(opti);
+                w.WriteTag(4, 2);
+                w.WriteString(from);
+                w.WriteTag(5, 2);
+                w.WriteString(target);
+                if(pos != null)
+                {
+                    w.WriteTag(6, 2);
+                    {
+                        int m = w.BeginMessage();
+                        pos.Encode(w);
+                        w.EndMessage(m);
+                    }
+                }
+                if(positions != null && positions.Length > 0)
+                {
+                    for(int i=0;i<positions.Length;++i)
+                    {
+                        if(positions[i] == null)
+                        {
+                            continue;
+                        }
+                        w.WriteTag(7, 2);
+                        {
+                            int m = w.BeginMessage();
+                            positions[i].Encode(w);
+                            w.EndMessage(m);
+                        }
+                    }
+                }
+            }
+        }
+        public class recv_Vec3
+        {
+            public struct Vec2
+            {
+                public int x;
+                public int y;
+                public JsonData ToJson()
+                {
+                    JsonData data = new JsonData();
+                    data["x"] = x;
+                    data["y"] = y;
+                    return data;
+                }
+                public void FromJson(JsonData ret)
+                {
+                    this.x= ret.ContainsKey("x")?(int)ret["x"]:0;
+                    this.y= ret.ContainsKey("y")?(int)ret["y"]:0;
+                }
+                public void WriteJson(JsonWriter w)
+                {
+                    w.WriteObjectStart();
+                    w.WritePropertyName("x");
+                    w.Write(x);
+                    w.WritePropertyName("y");
+                    w.Write(y);
+                    w.WriteObjectEnd();
+                }
+                public void ReadJson(JsonReader r)
+                {
+                    this.x = 0;
+                    this.y = 0;
+                    while(r.Read() && r.Token == JsonToken.PropertyName)
+                    {
+                        string key = (string)r.Value;
+                        r.Read();
+                        switch(key)
+                        {
+                            case "x":this.x = ProtoJson.ReadInt(r);
+                            break;
+                            case "y":this.y = ProtoJson.ReadInt(r);
+                            break;
+                            default:ProtoJson.Skip(r);
+                            break;
+                        }
+                    }
+                }
+                public int CalculateSize()
+                {
+                    int size = 0;
+                    size += 1 + ProtoWriter.SInt32Size(this.x);
+                    size += 1 + ProtoWriter.SInt32Size(this.y);
+                    return size;
+                }
+                public void Encode(ProtoWriter w)
+                {
+                    w.WriteTag(1, 0);
+                    w.WriteSInt32(x);
+                    w.WriteTag(2, 0);
+                    w.WriteSInt32(y);
+                }
+                public void Encode(System.IO.Stream s)
+                {
+                    ProtoWriter w = ProtoWriter.Shared;
+                    Encode(w);
+                    s.Write(w.buffer, 0, w.position);
+                }
+                public byte[] Encode()
+                {
+                    ProtoWriter w = ProtoWriter.Shared;
+                    Encode(w);
+                    return w.ToArray();
+                }
+                public int Encode(byte[] buf, int offset)
+                {
+                    int size = CalculateSize();
+                    ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                    Encode(w);
+                    w.Unwrap();
+                    return size;
+                }
+                public void Decode(byte[] buf, int offset, int length)
+                {
+                    int end = offset + length;
+                    while(offset < end)
+                    {
+                        uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                        switch((int)(tag >> 3))
+                        {
+                            case 1:this.x = ProtoReader.ReadSInt32(buf, ref offset);
+                            break;
+                            case 2:this.y = ProtoReader.ReadSInt32(buf, ref offset);
+                            break;
+                            default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                            break;
+                        }
+                    }
+                }
+            }
+            public float x;
+            public float y;
+            public float z;
+            public Vec2 xx;
+            public Vec2[] xxx;
+            private Vec2[] spare_xxx;
+            public static recv_Vec3 Get()
+            {
+                return ProtoPool<recv_Vec3>.Get();
+            }
+            public static void Release(recv_Vec3 v)
+            {
+                if(v == null)
+                {
+                    return;
+                }
+                v.Reset();
+                ProtoPool<recv_Vec3>.Put(v);
+            }
+            public void Reset()
+            {
+                x = 0.0f;
+                y = 0.0f;
+                z = 0.0f;
+                xx = default(Vec2);
+                if(xxx != null)
+                {
+                    spare_xxx = xxx;
+                    xxx = null;
+                }
+            }
+            public JsonData ToJson()
+            {
+                JsonData data = new JsonData();
+                data["x"] = x;
+                data["y"] = y;
+                data["z"] = z;
+                data["xx"]=xx.ToJson();
+                if(xxx != null)
+                {
+                    data["xxx"] = new JsonData();
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        data["xxx"].Add(xxx[i].ToJson());
+                    }
+                }
+                return data;
+            }
+            public void FromJson(JsonData ret)
+            {
+                Reset();
+                this.x= ret.ContainsKey("x")?(float)ret["x"]:0.0f;
+                this.y= ret.ContainsKey("y")?(float)ret["y"]:0.0f;
+                this.z= ret.ContainsKey("z")?(float)ret["z"]:0.0f;
+                if(ret.ContainsKey("xx"))
+                {
+                    this.xx = new Vec2();
+                    this.xx.FromJson(ret["xx"]);
+                }
+                if(ret.ContainsKey("xxx") && ret["xxx"].IsArray && ret["xxx"].Count > 0)
+                {
+                    this.xxx = ProtoPool.Reuse(this.xxx, ref this.spare_xxx, ret["xxx"].Count);
+                    for(int i=0;i<ret["xxx"].Count;++i)
+                    {
+                        this.xxx[i] = new Vec2();
+                        this.xxx[i].FromJson(ret["xxx"][i]);
+                    }
+                }
+            }
+            public void WriteJson(JsonWriter w)
+            {
+                w.WriteObjectStart();
+                w.WritePropertyName("x");
+                w.Write(x);
+                w.WritePropertyName("y");
+                w.Write(y);
+                w.WritePropertyName("z");
+                w.Write(z);
+                w.WritePropertyName("xx");
+                xx.WriteJson(w);
+                if(xxx != null)
+                {
+                    w.WritePropertyName("xxx");
+                    w.WriteArrayStart();
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        xxx[i].WriteJson(w);
+                    }
+                    w.WriteArrayEnd();
+                }
+                w.WriteObjectEnd();
+            }
+            public void ReadJson(JsonReader r)
+            {
+                Reset();
+                this.x = 0.0f;
+                this.y = 0.0f;
+                this.z = 0.0f;
+                while(r.Read() && r.Token == JsonToken.PropertyName)
+                {
+                    string key = (string)r.Value;
+                    r.Read();
+                    switch(key)
+                    {
+                        case "x":this.x = (float)ProtoJson.ReadDouble(r);
+                        break;
+                        case "y":this.y = (float)ProtoJson.ReadDouble(r);
+                        break;
+                        case "z":this.z = (float)ProtoJson.ReadDouble(r);
+                        break;
+                        case "xx":if(r.Token == JsonToken.ObjectStart)
+                        {
+                            this.xx = new Vec2();
+                            this.xx.ReadJson(r);
+                        }
+                        else
+                        {
+                            ProtoJson.Skip(r);
+                        }
+                        break;
+                        case "xxx":if(r.Token != JsonToken.ArrayStart)
+                        {
+                            ProtoJson.Skip(r);
+                            break;
+                        }
+                        {
+                            int n = 0;
+                            while(r.Read() && r.Token != JsonToken.ArrayEnd)
+                            {
+                                if(this.xxx == null || n == this.xxx.Length)
+                                {
+                                    System.Array.Resize(ref this.xxx, n == 0 ? 4 : n * 2);
+                                }
+                                this.xxx[n] = new Vec2();
+                                if(r.Token == JsonToken.ObjectStart)
+                                {
+                                    this.xxx[n].ReadJson(r);
+                                }
+                                else
+                                {
+                                    ProtoJson.Skip(r);
+                                }
+                                ++n;
+                            }
+                            if(n > 0 && n != this.xxx.Length)
+                            {
+                                System.Array.Resize(ref this.xxx, n);
+                            }
+                        }
+                        break;
+                        default:ProtoJson.Skip(r);
+                        break;
+                    }
+                }
+            }
+            public int CalculateSize()
+            {
+                int size = 0;
+                size += 1 + 4;
+                size += 1 + 4;
+                size += 1 + 4;
+                size += 1 + ProtoWriter.MessageSize(this.xx.CalculateSize());
+                if(this.xxx != null && this.xxx.Length > 0)
+                {
+                    for(int i=0;i<this.xxx.Length;++i)
+                    {
+                        size += 1 + ProtoWriter.MessageSize(this.xxx[i].CalculateSize());
+                    }
+                }
+                return size;
+            }
+            public void Encode(ProtoWriter w)
+            {
+                w.WriteTag(1, 5);
+                w.WriteFloat(x);
+                w.WriteTag(2, 5);
+                w.WriteFloat(y);
+                w.WriteTag(3, 5);
+                w.WriteFloat(z);
+                w.WriteTag(4, 2);
+                {
+                    int m = w.BeginMessage();
+                    xx.Encode(w);
+                    w.EndMessage(m);
+                }
+                if(xxx != null && xxx.Length > 0)
+                {
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        w.WriteTag(5, 2);
+                        {
+                            int m = w.BeginMessage();
+                            xxx[i].Encode(w);
+                            w.EndMessage(m);
+                        }
+                    }
+                }
+            }
+            public void Encode(System.IO.Stream s)
+            {
+                ProtoWriter w = ProtoWriter.Shared;
+                Encode(w);
+                s.Write(w.buffer, 0, w.position);
+            }
+            public byte[] Encode()
+            {
+                ProtoWriter w = ProtoWriter.Shared;
+                Encode(w);
+                return w.ToArray();
+            }
+            public int Encode(byte[] buf, int offset)
+            {
+                int size = CalculateSize();
+                ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                Encode(w);
+                w.Unwrap();
+                return size;
+            }
+            public void Decode(byte[] buf, int offset, int length)
+            {
+                Reset();
+                int end = offset + length;
+                int n_xxx = 0;
+                while(offset < end)
+                {
+                    uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                    switch((int)(tag >> 3))
+                    {
+                        case 1:this.x = ProtoReader.ReadFloat(buf, ref offset);
+                        break;
+                        case 2:this.y = ProtoReader.ReadFloat(buf, ref offset);
+                        break;
+                        case 3:this.z = ProtoReader.ReadFloat(buf, ref offset);
+                        break;
+                        case 4:
+                        {
+                            int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                            this.xx = new Vec2();
+                            this.xx.Decode(buf, offset, len);
+                            offset += len;
+                        }
+                        break;
+                        case 5:if(this.xxx == null || n_xxx == this.xxx.Length)
+                        {
+                            System.Array.Resize(ref this.xxx, n_xxx == 0 ? 4 : n_xxx * 2);
+                        }
+                        {
+                            int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                            this.xxx[n_xxx] = new Vec2();
+                            this.xxx[n_xxx].Decode(buf, offset, len);
+                            offset += len;
+                        }
+                        ++n_xxx;
+                        break;
+                        default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                        break;
+                    }
+                }
+                if(n_xxx > 0 && n_xxx != this.xxx.Length)
+                {
+                    System.Array.Resize(ref this.xxx, n_xxx);
+                }
+            }
+        }
+        public static bool recv(int x,int y,int z,recv_Vec3 pos=null)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Requests.recv(w, x, y, z, pos);
+            pc.notify(Routes.recv, w.ToArray());
+            return true;
+        }
+        public class send_Vec3
+        {
+            public struct Vec2
+            {
+                public int x;
+                public int y;
+                public JsonData ToJson()
+                {
+                    JsonData data = new JsonData();
+                    data["x"] = x;
+                    data["y"] = y;
+                    return data;
+                }
+                public void FromJson(JsonData ret)
+                {
+                    this.x= ret.ContainsKey("x")?(int)ret["x"]:0;
+                    this.y= ret.ContainsKey("y")?(int)ret["y"]:0;
+                }
+                public void WriteJson(JsonWriter w)
+                {
+                    w.WriteObjectStart();
+                    w.WritePropertyName("x");
+                    w.Write(x);
+                    w.WritePropertyName("y");
+                    w.Write(y);
+                    w.WriteObjectEnd();
+                }
+                public void ReadJson(JsonReader r)
+                {
+                    this.x = 0;
+                    this.y = 0;
+                    while(r.Read() && r.Token == JsonToken.PropertyName)
+                    {
+                        string key = (string)r.Value;
+                        r.Read();
+                        switch(key)
+                        {
+                            case "x":this.x = ProtoJson.ReadInt(r);
+                            break;
+                            case "y":this.y = ProtoJson.ReadInt(r);
+                            break;
+                            default:ProtoJson.Skip(r);
+                            break;
+                        }
+                    }
+                }
+                public int CalculateSize()
+                {
+                    int size = 0;
+                    size += 1 + ProtoWriter.SInt32Size(this.x);
+                    size += 1 + ProtoWriter.SInt32Size(this.y);
+                    return size;
+                }
+                public void Encode(ProtoWriter w)
+                {
+                    w.WriteTag(1, 0);
+                    w.WriteSInt32(x);
+                    w.WriteTag(2, 0);
+                    w.WriteSInt32(y);
+                }
+                public void Encode(System.IO.Stream s)
+                {
+                    ProtoWriter w = ProtoWriter.Shared;
+                    Encode(w);
+                    s.Write(w.buffer, 0, w.position);
+                }
+                public byte[] Encode()
+                {
+                    ProtoWriter w = ProtoWriter.Shared;
+                    Encode(w);
+                    return w.ToArray();
+                }
+                public int Encode(byte[] buf, int offset)
+                {
+                    int size = CalculateSize();
+                    ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                    Encode(w);
+                    w.Unwrap();
+                    return size;
+                }
+                public void Decode(byte[] buf, int offset, int length)
+                {
+                    int end = offset + length;
+                    while(offset < end)
+                    {
+                        uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                        switch((int)(tag >> 3))
+                        {
+                            case 1:this.x = ProtoReader.ReadSInt32(buf, ref offset);
+                            break;
+                            case 2:this.y = ProtoReader.ReadSInt32(buf, ref offset);
+                            break;
+                            default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                            break;
+                        }
+                    }
+                }
+            }
+            public float x;
+            public float y;
+            public float z;
+            public Vec2 xx;
+            public Vec2[] xxx;
+            private Vec2[] spare_xxx;
+            public static send_Vec3 Get()
+            {
+                return ProtoPool<send_Vec3>.Get();
+            }
+            public static void Release(send_Vec3 v)
+            {
+                if(v == null)
+                {
+                    return;
+                }
+                v.Reset();
+                ProtoPool<send_Vec3>.Put(v);
+            }
+            public void Reset()
+            {
+                x = 0.0f;
+                y = 0.0f;
+                z = 0.0f;
+                xx = default(Vec2);
+                if(xxx != null)
+                {
+                    spare_xxx = xxx;
+                    xxx = null;
+                }
+            }
+            public JsonData ToJson()
+            {
+                JsonData data = new JsonData();
+                data["x"] = x;
+                data["y"] = y;
+                data["z"] = z;
+                data["xx"]=xx.ToJson();
+                if(xxx != null)
+                {
+                    data["xxx"] = new JsonData();
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        data["xxx"].Add(xxx[i].ToJson());
+                    }
+                }
+                return data;
+            }
+            public void FromJson(JsonData ret)
+            {
+                Reset();
+                this.x= ret.ContainsKey("x")?(float)ret["x"]:0.0f;
+                this.y= ret.ContainsKey("y")?(float)ret["y"]:0.0f;
+                this.z= ret.ContainsKey("z")?(float)ret["z"]:0.0f;
+                if(ret.ContainsKey("xx"))
+                {
+                    this.xx = new Vec2();
+                    this.xx.FromJson(ret["xx"]);
+                }
+                if(ret.ContainsKey("xxx") && ret["xxx"].IsArray && ret["xxx"].Count > 0)
+                {
+                    this.xxx = ProtoPool.Reuse(this.xxx, ref this.spare_xxx, ret["xxx"].Count);
+                    for(int i=0;i<ret["xxx"].Count;++i)
+                    {
+                        this.xxx[i] = new Vec2();
+                        this.xxx[i].FromJson(ret["xxx"][i]);
+                    }
+                }
+            }
+            public void WriteJson(JsonWriter w)
+            {
+                w.WriteObjectStart();
+                w.WritePropertyName("x");
+                w.Write(x);
+                w.WritePropertyName("y");
+                w.Write(y);
+                w.WritePropertyName("z");
+                w.Write(z);
+                w.WritePropertyName("xx");
+                xx.WriteJson(w);
+                if(xxx != null)
+                {
+                    w.WritePropertyName("xxx");
+                    w.WriteArrayStart();
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        xxx[i].WriteJson(w);
+                    }
+                    w.WriteArrayEnd();
+                }
+                w.WriteObjectEnd();
+            }
+            public void ReadJson(JsonReader r)
+            {
+                Reset();
+                this.x = 0.0f;
+                this.y = 0.0f;
+                this.z = 0.0f;
+                while(r.Read() && r.Token == JsonToken.PropertyName)
+                {
+                    string key = (string)r.Value;
+                    r.Read();
+                    switch(key)
+                    {
+                        case "x":this.x = (float)ProtoJson.ReadDouble(r);
+                        break;
+                        case "y":this.y = (float)ProtoJson.ReadDouble(r);
+                        break;
+                        case "z":this.z = (float)ProtoJson.ReadDouble(r);
+                        break;
+                        case "xx":if(r.Token == JsonToken.ObjectStart)
+                        {
+                            this.xx = new Vec2();
+                            this.xx.ReadJson(r);
+                        }
+                        else
+                        {
+                            ProtoJson.Skip(r);
+                        }
+                        break;
+                        case "xxx":if(r.Token != JsonToken.ArrayStart)
+                        {
+                            ProtoJson.Skip(r);
+                            break;
+                        }
+                        {
+                            int n = 0;
+                            while(r.Read() && r.Token != JsonToken.ArrayEnd)
+                            {
+                                if(this.xxx == null || n == this.xxx.Length)
+                                {
+                                    System.Array.Resize(ref this.xxx, n == 0 ? 4 : n * 2);
+                                }
+                                this.xxx[n] = new Vec2();
+                                if(r.Token == JsonToken.ObjectStart)
+                                {
+                                    this.xxx[n].ReadJson(r);
+                                }
+                                else
+                                {
+                                    ProtoJson.Skip(r);
+                                }
+                                ++n;
+                            }
+                            if(n > 0 && n != this.xxx.Length)
+                            {
+                                System.Array.Resize(ref this.xxx, n);
+                            }
+                        }
+                        break;
+                        default:ProtoJson.Skip(r);
+                        break;
+                    }
+                }
+            }
+            public int CalculateSize()
+            {
+                int size = 0;
+                size += 1 + 4;
+                size += 1 + 4;
+                size += 1 + 4;
+                size += 1 + ProtoWriter.MessageSize(this.xx.CalculateSize());
+                if(this.xxx != null && this.xxx.Length > 0)
+                {
+                    for(int i=0;i<this.xxx.Length;++i)
+                    {
+                        size += 1 + ProtoWriter.MessageSize(this.xxx[i].CalculateSize());
+                    }
+                }
+                return size;
+            }
+            public void Encode(ProtoWriter w)
+            {
+                w.WriteTag(1, 5);
+                w.WriteFloat(x);
+                w.WriteTag(2, 5);
+                w.WriteFloat(y);
+                w.WriteTag(3, 5);
+                w.WriteFloat(z);
+                w.WriteTag(4, 2);
+                {
+                    int m = w.BeginMessage();
+                    xx.Encode(w);
+                    w.EndMessage(m);
+                }
+                if(xxx != null && xxx.Length > 0)
+                {
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        w.WriteTag(5, 2);
+                        {
+                            int m = w.BeginMessage();
+                            xxx[i].Encode(w);
+                            w.EndMessage(m);
+                        }
+                    }
+                }
+            }
+            public void Encode(System.IO.Stream s)
+            {
+                ProtoWriter w = ProtoWriter.Shared;
+                Encode(w);
+                s.Write(w.buffer, 0, w.position);
+            }
+            public byte[] Encode()
+            {
+                ProtoWriter w = ProtoWriter.Shared;
+                Encode(w);
+                return w.ToArray();
+            }
+            public int Encode(byte[] buf, int offset)
+            {
+                int size = CalculateSize();
+                ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                Encode(w);
+                w.Unwrap();
+                return size;
+            }
+            public void Decode(byte[] buf, int offset, int length)
+            {
+                Reset();
+                int end = offset + length;
+                int n_xxx = 0;
+                while(offset < end)
+                {
+                    uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                    switch((int)(tag >> 3))
+                    {
+                        case 1:this.x = ProtoReader.ReadFloat(buf, ref offset);
+                        break;
+                        case 2:this.y = ProtoReader.ReadFloat(buf, ref offset);
+                        break;
+                        case 3:this.z = ProtoReader.ReadFloat(buf, ref offset);
+                        break;
+                        case 4:
+                        {
+                            int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                            this.xx = new Vec2();
+                            this.xx.Decode(buf, offset, len);
+                            offset += len;
+                        }
+                        break;
+                        case 5:if(this.xxx == null || n_xxx == this.xxx.Length)
+                        {
+                            System.Array.Resize(ref this.xxx, n_xxx == 0 ? 4 : n_xxx * 2);
+                        }
+                        {
+                            int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                            this.xxx[n_xxx] = new Vec2();
+                            this.xxx[n_xxx].Decode(buf, offset, len);
+                            offset += len;
+                        }
+                        ++n_xxx;
+                        break;
+                        default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                        break;
+                    }
+                }
+                if(n_xxx > 0 && n_xxx != this.xxx.Length)
+                {
+                    System.Array.Resize(ref this.xxx, n_xxx);
+                }
+            }
+        }
+        public static bool send(string rid,string content,string from,string target,send_Vec3[] positions,int opti=0,send_Vec3 pos=null)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Requests.send(w, rid, content, from, target, positions, opti, pos);
+            pc.notify(Routes.send, w.ToArray());
+            return true;
+        }
+    }
+}
+namespace connector
+{
+    public class entryHandler
+    {
+        public static PomeloClient pc = null;
+        public static class Routes
+        {
+            public const ushort enter = 3;
+        }
+        public static class Requests
+        {
+            public static void enter(ProtoWriter w, string username,string rid)
+            {
+                w.WriteTag(1, 2);
+                w.WriteString(username);
+                w.WriteTag(2, 2);
+                w.WriteString(rid);
+            }
+        }
+        public static bool enter(string username,string rid)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Requests.enter(w, username, rid);
+            pc.notify(Routes.enter, w.ToArray());
+            return true;
+        }
+    }
+}
+namespace gate
+{
+    public class gateHandler
+    {
+        public static PomeloClient pc = null;
+        public static class Routes
+        {
+            public const ushort queryEntry = 4;
+        }
+        public static class Requests
+        {
+            public static void queryEntry(ProtoWriter w, string uid)
+            {
+                w.WriteTag(1, 2);
+                w.WriteString(uid);
+            }
+        }
+        public class queryEntry_result
+        {
+            public class Vec3
+            {
+                public struct Vec2
+                {
+                    public int x;
+                    public int y;
+                    public JsonData ToJson()
+                    {
+                        JsonData data = new JsonData();
+                        data["x"] = x;
+                        data["y"] = y;
+                        return data;
+                    }
+                    public void FromJson(JsonData ret)
+                    {
+                        this.x= ret.ContainsKey("x")?(int)ret["x"]:0;
+                        this.y= ret.ContainsKey("y")?(int)ret["y"]:0;
+                    }
+                    public void WriteJson(JsonWriter w)
+                    {
+                        w.WriteObjectStart();
+                        w.WritePropertyName("x");
+                        w.Write(x);
+                        w.WritePropertyName("y");
+                        w.Write(y);
+                        w.WriteObjectEnd();
+                    }
+                    public void ReadJson(JsonReader r)
+                    {
+                        this.x = 0;
+                        this.y = 0;
+                        while(r.Read() && r.Token == JsonToken.PropertyName)
+                        {
+                            string key = (string)r.Value;
+                            r.Read();
+                            switch(key)
+                            {
+                                case "x":this.x = ProtoJson.ReadInt(r);
+                                break;
+                                case "y":this.y = ProtoJson.ReadInt(r);
+                                break;
+                                default:ProtoJson.Skip(r);
+                                break;
+                            }
+                        }
+                    }
+                    public int CalculateSize()
+                    {
+                        int size = 0;
+                        size += 1 + ProtoWriter.SInt32Size(this.x);
+                        size += 1 + ProtoWriter.SInt32Size(this.y);
+                        return size;
+                    }
+                    public void Encode(ProtoWriter w)
+                    {
+                        w.WriteTag(1, 0);
+                        w.WriteSInt32(x);
+                        w.WriteTag(2, 0);
+                        w.WriteSInt32(y);
+                    }
+                    public void Encode(System.IO.Stream s)
+                    {
+                        ProtoWriter w = ProtoWriter.Shared;
+                        Encode(w);
+                        s.Write(w.buffer, 0, w.position);
+                    }
+                    public byte[] Encode()
+                    {
+                        ProtoWriter w = ProtoWriter.Shared;
+                        Encode(w);
+                        return w.ToArray();
+                    }
+                    public int Encode(byte[] buf, int offset)
+                    {
+                        int size = CalculateSize();
+                        ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                        Encode(w);
+                        w.Unwrap();
+                        return size;
+                    }
+                    public void Decode(byte[] buf, int offset, int length)
+                    {
+                        int end = offset + length;
+                        while(offset < end)
+                        {
+                            uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                            switch((int)(tag >> 3))
+                            {
+                                case 1:this.x = ProtoReader.ReadSInt32(buf, ref offset);
+                                break;
+                                case 2:this.y = ProtoReader.ReadSInt32(buf, ref offset);
+                                break;
+                                default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                                break;
+                            }
+                        }
+                    }
+                }
+                public float x;
+                public float y;
+                public float z;
+                public Vec2 xx;
+                public Vec2[] xxx;
+                private Vec2[] spare_xxx;
+                public static Vec3 Get()
+                {
+                    return ProtoPool<Vec3>.Get();
+                }
+                public static void Release(Vec3 v)
+                {
+                    if(v == null)
+                    {
+                        return;
+                    }
+                    v.Reset();
+                    ProtoPool<Vec3>.Put(v);
+                }
+                public void Reset()
+                {
+                    x = 0.0f;
+                    y = 0.0f;
+                    z = 0.0f;
+                    xx = default(Vec2);
+                    if(xxx != null)
+                    {
+                        spare_xxx = xxx;
+                        xxx = null;
+                    }
+                }
+                public JsonData ToJson()
+                {
+                    JsonData data = new JsonData();
+                    data["x"] = x;
+                    data["y"] = y;
+                    data["z"] = z;
+                    data["xx"]=xx.ToJson();
+                    if(xxx != null)
+                    {
+                        data["xxx"] = new JsonData();
+                        for(int i=0;i<xxx.Length;++i)
+                        {
+                            data["xxx"].Add(xxx[i].ToJson());
+                        }
+                    }
+                    return data;
+                }
+                public void FromJson(JsonData ret)
+                {
+                    Reset();
+                    this.x= ret.ContainsKey("x")?(float)ret["x"]:0.0f;
+                    this.y= ret.ContainsKey("y")?(float)ret["y"]:0.0f;
+                    this.z= ret.ContainsKey("z")?(float)ret["z"]:0.0f;
+                    if(ret.ContainsKey("xx"))
+                    {
+                        this.xx = new Vec2();
+                        this.xx.FromJson(ret["xx"]);
+                    }
+                    if(ret.ContainsKey("xxx") && ret["xxx"].IsArray && ret["xxx"].Count > 0)
+                    {
+                        this.xxx = ProtoPool.Reuse(this.xxx, ref this.spare_xxx, ret["xxx"].Count);
+                        for(int i=0;i<ret["xxx"].Count;++i)
+                        {
+                            this.xxx[i] = new Vec2();
+                            this.xxx[i].FromJson(ret["xxx"][i]);
+                        }
+                    }
+                }
+                public void WriteJson(JsonWriter w)
+                {
+                    w.WriteObjectStart();
+                    w.WritePropertyName("x");
+                    w.Write(x);
+                    w.WritePropertyName("y");
+                    w.Write(y);
+                    w.WritePropertyName("z");
+                    w.Write(z);
+                    w.WritePropertyName("xx");
+                    xx.WriteJson(w);
+                    if(xxx != null)
+                    {
+                        w.WritePropertyName("xxx");
+                        w.WriteArrayStart();
+                        for(int i=0;i<xxx.Length;++i)
+                        {
+                            xxx[i].WriteJson(w);
+                        }
+                        w.WriteArrayEnd();
+                    }
+                    w.WriteObjectEnd();
+                }
+                public void ReadJson(JsonReader r)
+                {
+                    Reset();
+                    this.x = 0.0f;
+                    this.y = 0.0f;
+                    this.z = 0.0f;
+                    while(r.Read() && r.Token == JsonToken.PropertyName)
+                    {
+                        string key = (string)r.Value;
+                        r.Read();
+                        switch(key)
+                        {
+                            case "x":this.x = (float)ProtoJson.ReadDouble(r);
+                            break;
+                            case "y":this.y = (float)ProtoJson.ReadDouble(r);
+                            break;
+                            case "z":this.z = (float)ProtoJson.ReadDouble(r);
+                            break;
+                            case "xx":if(r.Token == JsonToken.ObjectStart)
+                            {
+                                this.xx = new Vec2();
+                                this.xx.ReadJson(r);
+                            }
+                            else
+                            {
+                                ProtoJson.Skip(r);
+                            }
+                            break;
+                            case "xxx":if(r.Token != JsonToken.ArrayStart)
+                            {
+                                ProtoJson.Skip(r);
+                                break;
+                            }
+                            {
+                                int n = 0;
+                                while(r.Read() && r.Token != JsonToken.ArrayEnd)
+                                {
+                                    if(this.xxx == null || n == this.xxx.Length)
+                                    {
+                                        System.Array.Resize(ref this.xxx, n == 0 ? 4 : n * 2);
+                                    }
+                                    this.xxx[n] = new Vec2();
+                                    if(r.Token == JsonToken.ObjectStart)
+                                    {
+                                        this.xxx[n].ReadJson(r);
+                                    }
+                                    else
+                                    {
+                                        ProtoJson.Skip(r);
+                                    }
+                                    ++n;
+                                }
+                                if(n > 0 && n != this.xxx.Length)
+                                {
+                                    System.Array.Resize(ref this.xxx, n);
+                                }
+                            }
+                            break;
+                            default:ProtoJson.Skip(r);
+                            break;
+                        }
+                    }
+                }
+                public int CalculateSize()
+                {
+                    int size = 0;
+                    size += 1 + 4;
+                    size += 1 + 4;
+                    size += 1 + 4;
+                    size += 1 + ProtoWriter.MessageSize(this.xx.CalculateSize());
+                    if(this.xxx != null && this.xxx.Length > 0)
+                    {
+                        for(int i=0;i<this.xxx.Length;++i)
+                        {
+                            size += 1 + ProtoWriter.MessageSize(this.xxx[i].CalculateSize());
+                        }
+                    }
+                    return size;
+                }
+                public void Encode(ProtoWriter w)
+                {
+                    w.WriteTag(1, 5);
+                    w.WriteFloat(x);
+                    w.WriteTag(2, 5);
+                    w.WriteFloat(y);
+                    w.WriteTag(3, 5);
+                    w.WriteFloat(z);
+                    w.WriteTag(4, 2);
+                    {
+                        int m = w.BeginMessage();
+                        xx.Encode(w);
+                        w.EndMessage(m);
+                    }
+                    if(xxx != null && xxx.Length > 0)
+                    {
+                        for(int i=0;i<xxx.Length;++i)
+                        {
+                            w.WriteTag(5, 2);
+                            {
+                                int m = w.BeginMessage();
+                                xxx[i].Encode(w);
+                                w.EndMessage(m);
+                            }
+                        }
+                    }
+                }
+                public void Encode(System.IO.Stream s)
+                {
+                    ProtoWriter w = ProtoWriter.Shared;
+                    Encode(w);
+                    s.Write(w.buffer, 0, w.position);
+                }
+                public byte[] Encode()
+                {
+                    ProtoWriter w = ProtoWriter.Shared;
+                    Encode(w);
+                    return w.ToArray();
+                }
+                public int Encode(byte[] buf, int offset)
+                {
+                    int size = CalculateSize();
+                    ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                    Encode(w);
+                    w.Unwrap();
+                    return size;
+                }
+                public void Decode(byte[] buf, int offset, int length)
+                {
+                    Reset();
+                    int end = offset + length;
+                    int n_xxx = 0;
+                    while(offset < end)
+                    {
+                        uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                        switch((int)(tag >> 3))
+                        {
+                            case 1:this.x = ProtoReader.ReadFloat(buf, ref offset);
+                            break;
+                            case 2:this.y = ProtoReader.ReadFloat(buf, ref offset);
+                            break;
+                            case 3:this.z = ProtoReader.ReadFloat(buf, ref offset);
+                            break;
+                            case 4:
+                            {
+                                int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                                this.xx = new Vec2();
+                                this.xx.Decode(buf, offset, len);
+                                offset += len;
+                            }
+                            break;
+                            case 5:if(this.xxx == null || n_xxx == this.xxx.Length)
+                            {
+                                System.Array.Resize(ref this.xxx, n_xxx == 0 ? 4 : n_xxx * 2);
+                            }
+                            {
+                                int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                                this.xxx[n_xxx] = new Vec2();
+                                this.xxx[n_xxx].Decode(buf, offset, len);
+                                offset += len;
+                            }
+                            ++n_xxx;
+                            break;
+                            default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                            break;
+                        }
+                    }
+                    if(n_xxx > 0 && n_xxx != this.xxx.Length)
+                    {
+                        System.Array.Resize(ref this.xxx, n_xxx);
+                    }
+                }
+            }
+            public int code;
+            public string host;
+            public int port;
+            public int[] xxx;
+            public Vec3[] positions;
+            private int[] spare_xxx;
+            private Vec3[] spare_positions;
+            public static queryEntry_result Get()
+            {
+                return ProtoPool<queryEntry_result>.Get();
+            }
+            public static void Release(queryEntry_result v)
+            {
+                if(v == null)
+                {
+                    return;
+                }
+                v.Reset();
+                ProtoPool<queryEntry_result>.Put(v);
+            }
+            public void Reset()
+            {
+                code = 0;
+                host = null;
+                port = 0;
+                if(xxx != null)
+                {
+                    spare_xxx = xxx;
+                    xxx = null;
+                }
+                if(positions != null)
+                {
+                    for(int i=0;i<positions.Length;++i)
+                    {
+                        Vec3.Release(positions[i]);
+                        positions[i] = null;
+                    }
+                    spare_positions = positions;
+                    positions = null;
+                }
+            }
+            public JsonData ToJson()
+            {
+                JsonData data = new JsonData();
+                data["code"] = code;
+                data["host"] = host;
+                data["port"] = port;
+                for(int i=0;i<xxx.Length;++i)
+                {
+                    data["xxx"].Add(xxx[i]);
+                }
+                if(positions != null)
+                {
+                    data["positions"] = new JsonData();
+                    for(int i=0;i<positions.Length;++i)
+                    {
+                        data["positions"].Add(positions[i].ToJson());
+                    }
+                }
+                return data;
+            }
+            public void FromJson(JsonData ret)
+            {
+                Reset();
+                this.code= ret.ContainsKey("code")?(int)ret["code"]:0;
+                this.host= ret.ContainsKey("host")?(string)ret["host"]:"";
+                this.port= ret.ContainsKey("port")?(int)ret["port"]:0;
+                if(ret.ContainsKey("xxx") && ret["xxx"].IsArray && ret["xxx"].Count > 0)
+                {
+                    this.xxx = ProtoPool.Reuse(this.xxx, ref this.spare_xxx, ret["xxx"].Count);
+                    for(int i=0;i<ret["xxx"].Count;++i)
+                    {
+                        this.xxx[i]=(int)ret["xxx"][i];
+                    }
+                }
+                if(ret.ContainsKey("positions") && ret["positions"].IsArray && ret["positions"].Count > 0)
+                {
+                    this.positions = ProtoPool.Reuse(this.positions, ref this.spare_positions, ret["positions"].Count);
+                    for(int i=0;i<ret["positions"].Count;++i)
+                    {
+                        Vec3.Release(this.positions[i]);
+                        this.positions[i] = Vec3.Get();
+                        this.positions[i].FromJson(ret["positions"][i]);
+                    }
+                }
+            }
+            public void WriteJson(JsonWriter w)
+            {
+                w.WriteObjectStart();
+                w.WritePropertyName("code");
+                w.Write(code);
+                w.WritePropertyName("host");
+                w.Write(host);
+                w.WritePropertyName("port");
+                w.Write(port);
+                if(xxx != null)
+                {
+                    w.WritePropertyName("xxx");
+                    w.WriteArrayStart();
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        w.Write(xxx[i]);
+                    }
+                    w.WriteArrayEnd();
+                }
+                if(positions != null)
+                {
+                    w.WritePropertyName("positions");
+                    w.WriteArrayStart();
+                    for(int i=0;i<positions.Length;++i)
+                    {
+                        positions[i].WriteJson(w);
+                    }
+                    w.WriteArrayEnd();
+                }
+                w.WriteObjectEnd();
+            }
+            public void ReadJson(JsonReader r)
+            {
+                Reset();
+                this.code = 0;
+                this.host = "";
+                this.port = 0;
+                while(r.Read() && r.Token == JsonToken.PropertyName)
+                {
+                    string key = (string)r.Value;
+                    r.Read();
+                    switch(key)
+                    {
+                        case "code":this.code = ProtoJson.ReadInt(r);
+                        break;
+                        case "host":this.host = ProtoJson.ReadString(r);
+                        break;
+                        case "port":this.port = ProtoJson.ReadInt(r);
+                        break;
+                        case "xxx":if(r.Token != JsonToken.ArrayStart)
+                        {
+                            ProtoJson.Skip(r);
+                            break;
+                        }
+                        {
+                            int n = 0;
+                            while(r.Read() && r.Token != JsonToken.ArrayEnd)
+                            {
+                                if(this.xxx == null || n == this.xxx.Length)
+                                {
+                                    System.Array.Resize(ref this.xxx, n == 0 ? 4 : n * 2);
+                                }
+                                this.xxx[n] = ProtoJson.ReadInt(r);
+                                ++n;
+                            }
+                            if(n > 0 && n != this.xxx.Length)
+                            {
+                                System.Array.Resize(ref this.xxx, n);
+                            }
+                        }
+                        break;
+                        case "positions":if(r.Token != JsonToken.ArrayStart)
+                        {
+                            ProtoJson.Skip(r);
+                            break;
+                        }
+                        {
+                            int n = 0;
+                            while(r.Read() && r.Token != JsonToken.ArrayEnd)
+                            {
+                                if(this.positions == null || n == this.positions.Length)
+                                {
+                                    System.Array.Resize(ref this.positions, n == 0 ? 4 : n * 2);
+                                }
+                                Vec3.Release(this.positions[n]);
+                                this.positions[n] = Vec3.Get();
+                                if(r.Token == JsonToken.ObjectStart)
+                                {
+                                    this.positions[n].ReadJson(r);
+                                }
+                                else
+                                {
+                                    ProtoJson.Skip(r);
+                                }
+                                ++n;
+                            }
+                            if(n > 0 && n != this.positions.Length)
+                            {
+                                System.Array.Resize(ref this.positions, n);
+                            }
+                        }
+                        break;
+                        default:ProtoJson.Skip(r);
+                        break;
+                    }
+                }
+            }
+            public int CalculateSize()
+            {
+                int size = 0;
+                size += 1 + ProtoWriter.SInt32Size(this.code);
+                size += 1 + ProtoWriter.StringSize(this.host);
+                size += 1 + ProtoWriter.SInt32Size(this.port);
+                if(this.xxx != null && this.xxx.Length > 0)
+                {
+                    size += 1 + ProtoWriter.VarintSize((uint)this.xxx.Length);
+                    for(int i=0;i<this.xxx.Length;++i)
+                    {
+                        size += ProtoWriter.SInt32Size(this.xxx[i]);
+                    }
+                }
+                if(this.positions != null && this.positions.Length > 0)
+                {
+                    for(int i=0;i<this.positions.Length;++i)
+                    {
+                        if(this.positions[i] == null)
+                        {
+                            continue;
+                        }
+                        size += 1 + ProtoWriter.MessageSize(this.positions[i].CalculateSize());
+                    }
+                }
+                return size;
+            }
+            public void Encode(ProtoWriter w)
+            {
+                w.WriteTag(1, 0);
+                w.WriteSInt32(code);
+                w.WriteTag(2, 2);
+                w.WriteString(host);
+                w.WriteTag(3, 0);
+                w.WriteSInt32(port);
+                if(xxx != null && xxx.Length > 0)
+                {
+                    w.WriteTag(4, 0);
+                    w.WriteUInt32((uint)xxx.Length);
+                    for(int i=0;i<xxx.Length;++i)
+                    {
+                        w.WriteSInt32(xxx[i]);
+                    }
+                }
+                if(positions != null && positions.Length > 0)
+                {
+                    for(int i=0;i<positions.Length;++i)
+                    {
+                        if(positions[i] == null)
+                        {
+                            continue;
+                        }
+                        w.WriteTag(5, 2);
+                        {
+                            int m = w.BeginMessage();
+                            positions[i].Encode(w);
+                            w.EndMessage(m);
+                        }
+                    }
+                }
+            }
+            public void Encode(System.IO.Stream s)
+            {
+                ProtoWriter w = ProtoWriter.Shared;
+                Encode(w);
+                s.Write(w.buffer, 0, w.position);
+            }
+            public byte[] Encode()
+            {
+                ProtoWriter w = ProtoWriter.Shared;
+                Encode(w);
+                return w.ToArray();
+            }
+            public int Encode(byte[] buf, int offset)
+            {
+                int size = CalculateSize();
+                ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+                Encode(w);
+                w.Unwrap();
+                return size;
+            }
+            public void Decode(byte[] buf, int offset, int length)
+            {
+                Reset();
+                int end = offset + length;
+                int n_positions = 0;
+                while(offset < end)
+                {
+                    uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                    switch((int)(tag >> 3))
+                    {
+                        case 1:this.code = ProtoReader.ReadSInt32(buf, ref offset);
+                        break;
+                        case 2:this.host = ProtoReader.ReadString(buf, ref offset);
+                        break;
+                        case 3:this.port = ProtoReader.ReadSInt32(buf, ref offset);
+                        break;
+                        case 4:
+                        {
+                            int count = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                            int start = this.xxx == null ? 0 : this.xxx.Length;
+                            if(start == 0)
+                            {
+                                this.xxx = ProtoPool.Reuse(this.xxx, ref this.spare_xxx, count);
+                            }
+                            else
+                            {
+                                System.Array.Resize(ref this.xxx, start + count);
+                            }
+                            for(int i=start;i<start + count;++i)
+                            {
+                                this.xxx[i] = ProtoReader.ReadSInt32(buf, ref offset);
+                            }
+                        }
+                        break;
+                        case 5:if(this.positions == null || n_positions == this.positions.Length)
+                        {
+                            System.Array.Resize(ref this.positions, n_positions == 0 ? 4 : n_positions * 2);
+                        }
+                        {
+                            int len = (int)ProtoReader.ReadUInt32(buf, ref offset);
+                            Vec3.Release(this.positions[n_positions]);
+                            this.positions[n_positions] = Vec3.Get();
+                            this.positions[n_positions].Decode(buf, offset, len);
+                            offset += len;
+                        }
+                        ++n_positions;
+                        break;
+                        default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                        break;
+                    }
+                }
+                if(n_positions > 0 && n_positions != this.positions.Length)
+                {
+                    System.Array.Resize(ref this.positions, n_positions);
+                }
+            }
+        }
+        public static bool queryEntry(string uid,System.Action<queryEntry_result> cb)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Requests.queryEntry(w, uid);
+            pc.request(Routes.queryEntry, w.ToArray(), delegate (byte[] ret)
+            {
+                queryEntry_result result = queryEntry_result.Get();
+                result.Decode(ret, 0, ret.Length);
+                try
+                {
+                    cb(result);
+                }
+                finally
+                {
+                    queryEntry_result.Release(result);
+                }
+            }
+            );
+            return true;
+        }
+    }
+}
+public class ServerEvent
+{
+    public static PomeloClient pc = null;
+    public static class Routes
+    {
+        public const ushort onAdd = 5;
+        public const ushort onChat = 6;
+        public const ushort onLeave = 7;
+    }
+    public class onAdd_event
+    {
+        public string user;
+        public static onAdd_event Get()
+        {
+            return ProtoPool<onAdd_event>.Get();
+        }
+        public static void Release(onAdd_event v)
+        {
+            if(v == null)
+            {
+                return;
+            }
+            v.Reset();
+            ProtoPool<onAdd_event>.Put(v);
+        }
+        public void Reset()
+        {
+            user = null;
+        }
+        public JsonData ToJson()
+        {
+            JsonData data = new JsonData();
+            data["user"] = user;
+            return data;
+        }
+        public void FromJson(JsonData ret)
+        {
+            Reset();
+            this.user= ret.ContainsKey("user")?(string)ret["user"]:"";
+        }
+        public void WriteJson(JsonWriter w)
+        {
+            w.WriteObjectStart();
+            w.WritePropertyName("user");
+            w.Write(user);
+            w.WriteObjectEnd();
+        }
+        public void ReadJson(JsonReader r)
+        {
+            Reset();
+            this.user = "";
+            while(r.Read() && r.Token == JsonToken.PropertyName)
+            {
+                string key = (string)r.Value;
+                r.Read();
+                switch(key)
+                {
+                    case "user":this.user = ProtoJson.ReadString(r);
+                    break;
+                    default:ProtoJson.Skip(r);
+                    break;
+                }
+            }
+        }
+        public int CalculateSize()
+        {
+            int size = 0;
+            size += 1 + ProtoWriter.StringSize(this.user);
+            return size;
+        }
+        public void Encode(ProtoWriter w)
+        {
+            w.WriteTag(1, 2);
+            w.WriteString(user);
+        }
+        public void Encode(System.IO.Stream s)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Encode(w);
+            s.Write(w.buffer, 0, w.position);
+        }
+        public byte[] Encode()
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Encode(w);
+            return w.ToArray();
+        }
+        public int Encode(byte[] buf, int offset)
+        {
+            int size = CalculateSize();
+            ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+            Encode(w);
+            w.Unwrap();
+            return size;
+        }
+        public void Decode(byte[] buf, int offset, int length)
+        {
+            Reset();
+            int end = offset + length;
+            while(offset < end)
+            {
+                uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                switch((int)(tag >> 3))
+                {
+                    case 1:this.user = ProtoReader.ReadString(buf, ref offset);
+                    break;
+                    default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                    break;
+                }
+            }
+        }
+    }
+    public static bool onAdd(System.Action<onAdd_event> cb)
+    {
+        pc.on(Routes.onAdd, delegate (byte[] ret)
+        {
+            onAdd_event result = onAdd_event.Get();
+            result.Decode(ret, 0, ret.Length);
+            try
+            {
+                cb(result);
+            }
+            finally
+            {
+                onAdd_event.Release(result);
+            }
+        }
+        );
+        return true;
+    }
+    public class onChat_event
+    {
+        public string msg;
+        public string from;
+        public string target;
+        public static onChat_event Get()
+        {
+            return ProtoPool<onChat_event>.Get();
+        }
+        public static void Release(onChat_event v)
+        {
+            if(v == null)
+            {
+                return;
+            }
+            v.Reset();
+            ProtoPool<onChat_event>.Put(v);
+        }
+        public void Reset()
+        {
+            msg = null;
+            from = null;
+            target = null;
+        }
+        public JsonData ToJson()
+        {
+            JsonData data = new JsonData();
+            data["msg"] = msg;
+            data["from"] = from;
+            data["target"] = target;
+            return data;
+        }
+        public void FromJson(JsonData ret)
+        {
+            Reset();
+            this.msg= ret.ContainsKey("msg")?(string)ret["msg"]:"";
+            this.from= ret.ContainsKey("from")?(string)ret["from"]:"";
+            this.target= ret.ContainsKey("target")?(string)ret["target"]:"";
+        }
+        public void WriteJson(JsonWriter w)
+        {
+            w.WriteObjectStart();
+            w.WritePropertyName("msg");
+            w.Write(msg);
+            w.WritePropertyName("from");
+            w.Write(from);
+            w.WritePropertyName("target");
+            w.Write(target);
+            w.WriteObjectEnd();
+        }
+        public void ReadJson(JsonReader r)
+        {
+            Reset();
+            this.msg = "";
+            this.from = "";
+            this.target = "";
+            while(r.Read() && r.Token == JsonToken.PropertyName)
+            {
+                string key = (string)r.Value;
+                r.Read();
+                switch(key)
+                {
+                    case "msg":this.msg = ProtoJson.ReadString(r);
+                    break;
+                    case "from":this.from = ProtoJson.ReadString(r);
+                    break;
+                    case "target":this.target = ProtoJson.ReadString(r);
+                    break;
+                    default:ProtoJson.Skip(r);
+                    break;
+                }
+            }
+        }
+        public int CalculateSize()
+        {
+            int size = 0;
+            size += 1 + ProtoWriter.StringSize(this.msg);
+            size += 1 + ProtoWriter.StringSize(this.from);
+            size += 1 + ProtoWriter.StringSize(this.target);
+            return size;
+        }
+        public void Encode(ProtoWriter w)
+        {
+            w.WriteTag(1, 2);
+            w.WriteString(msg);
+            w.WriteTag(2, 2);
+            w.WriteString(from);
+            w.WriteTag(3, 2);
+            w.WriteString(target);
+        }
+        public void Encode(System.IO.Stream s)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Encode(w);
+            s.Write(w.buffer, 0, w.position);
+        }
+        public byte[] Encode()
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Encode(w);
+            return w.ToArray();
+        }
+        public int Encode(byte[] buf, int offset)
+        {
+            int size = CalculateSize();
+            ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+            Encode(w);
+            w.Unwrap();
+            return size;
+        }
+        public void Decode(byte[] buf, int offset, int length)
+        {
+            Reset();
+            int end = offset + length;
+            while(offset < end)
+            {
+                uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                switch((int)(tag >> 3))
+                {
+                    case 1:this.msg = ProtoReader.ReadString(buf, ref offset);
+                    break;
+                    case 2:this.from = ProtoReader.ReadString(buf, ref offset);
+                    break;
+                    case 3:this.target = ProtoReader.ReadString(buf, ref offset);
+                    break;
+                    default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                    break;
+                }
+            }
+        }
+    }
+    public static bool onChat(System.Action<onChat_event> cb)
+    {
+        pc.on(Routes.onChat, delegate (byte[] ret)
+        {
+            onChat_event result = onChat_event.Get();
+            result.Decode(ret, 0, ret.Length);
+            try
+            {
+                cb(result);
+            }
+            finally
+            {
+                onChat_event.Release(result);
+            }
+        }
+        );
+        return true;
+    }
+    public class onLeave_event
+    {
+        public string user;
+        public static onLeave_event Get()
+        {
+            return ProtoPool<onLeave_event>.Get();
+        }
+        public static void Release(onLeave_event v)
+        {
+            if(v == null)
+            {
+                return;
+            }
+            v.Reset();
+            ProtoPool<onLeave_event>.Put(v);
+        }
+        public void Reset()
+        {
+            user = null;
+        }
+        public JsonData ToJson()
+        {
+            JsonData data = new JsonData();
+            data["user"] = user;
+            return data;
+        }
+        public void FromJson(JsonData ret)
+        {
+            Reset();
+            this.user= ret.ContainsKey("user")?(string)ret["user"]:"";
+        }
+        public void WriteJson(JsonWriter w)
+        {
+            w.WriteObjectStart();
+            w.WritePropertyName("user");
+            w.Write(user);
+            w.WriteObjectEnd();
+        }
+        public void ReadJson(JsonReader r)
+        {
+            Reset();
+            this.user = "";
+            while(r.Read() && r.Token == JsonToken.PropertyName)
+            {
+                string key = (string)r.Value;
+                r.Read();
+                switch(key)
+                {
+                    case "user":this.user = ProtoJson.ReadString(r);
+                    break;
+                    default:ProtoJson.Skip(r);
+                    break;
+                }
+            }
+        }
+        public int CalculateSize()
+        {
+            int size = 0;
+            size += 1 + ProtoWriter.StringSize(this.user);
+            return size;
+        }
+        public void Encode(ProtoWriter w)
+        {
+            w.WriteTag(1, 2);
+            w.WriteString(user);
+        }
+        public void Encode(System.IO.Stream s)
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Encode(w);
+            s.Write(w.buffer, 0, w.position);
+        }
+        public byte[] Encode()
+        {
+            ProtoWriter w = ProtoWriter.Shared;
+            Encode(w);
+            return w.ToArray();
+        }
+        public int Encode(byte[] buf, int offset)
+        {
+            int size = CalculateSize();
+            ProtoWriter w = ProtoWriter.Wrap(buf, offset, size);
+            Encode(w);
+            w.Unwrap();
+            return size;
+        }
+        public void Decode(byte[] buf, int offset, int length)
+        {
+            Reset();
+            int end = offset + length;
+            while(offset < end)
+            {
+                uint tag = ProtoReader.ReadUInt32(buf, ref offset);
+                switch((int)(tag >> 3))
+                {
+                    case 1:this.user = ProtoReader.ReadString(buf, ref offset);
+                    break;
+                    default:ProtoReader.Skip(buf, ref offset, (int)(tag & 7));
+                    break;
+                }
+            }
+        }
+    }
+    public static bool onLeave(System.Action<onLeave_event> cb)
+    {
+        pc.on(Routes.onLeave, delegate (byte[] ret)
+        {
+            onLeave_event result = onLeave_event.Get();
+            result.Decode(ret, 0, ret.Length);
+            try
+            {
+                cb(result);
+            }
+            finally
+            {
+                onLeave_event.Release(result);
+            }
+        }
+        );
+        return true;
+    }
+}
@@ -0,0 +1,323 @@
+#include "pomeloc/pomeloc.h"
+#include "pomeloc/idl.h"
+#include "pomeloc/codec.h"
+#include "pomeloc/binary_schema.h"
+#include <cstdio>
+#include <string>
+
+// Round trips of the runtime codec over the testdata routes and a proto
+// with every pomelo type, in all three route directions, through the json
+// and the typed visitor interfaces, plus truncated and random input that
+// must fail cleanly.
+//
+//   pomeloc_codec_test <testdata dir>
+
+static int checks = 0;
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        ++checks; \
+        if (!(cond)) { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+// Every scalar type, packed and non-packed repeated fields and nested
+// messages, as the client protos of one route.
+static const char* const kTypesProtos =
+    "{\"test.typeHandler.all\": {"
+    "  \"message Inner\": {"
+    "    \"required double d\": 1,"
+    "    \"repeated sInt32 s\": 2"
+    "  },"
+    "  \"required uInt32 u\": 1,"
+    "  \"required sInt32 s\": 2,"
+    "  \"required int32 i\": 3,"
+    "  \"required float f\": 4,"
+    "  \"required double d\": 5,"
+    "  \"required string str\": 6,"
+    "  \"repeated double ds\": 7,"
+    "  \"repeated float fs\": 8,"
+    "  \"repeated uInt32 us\": 9,"
+    "  \"repeated string strs\": 10,"
+    "  \"optional Inner inner\": 11,"
+    "  \"repeated Inner inners\": 12"
+    "}}";
+
+static const uint8_t* Bytes(const std::string& str)
+{
+    return reinterpret_cast<const uint8_t*>(str.data());
+}
+
+// Encodes msg on a route and expects the decode of the bytes to give it
+// back.
+static std::string RoundTrip(pomeloc::Codec& codec, const std::string& route,
+    pomeloc::RouteDirection dir, const json& msg)
+{
+    std::string bytes;
+    bool encoded = codec.Encode(route, dir, msg, &bytes);
+    CHECK(encoded);
+    if (!encoded)
+    {
+        printf("  %s %s\n", route.c_str(), codec.error_.c_str());
+        return bytes;
+    }
+    json decoded;
+    bool ok = codec.Decode(route, dir, Bytes(bytes), bytes.size(), &decoded);
+    CHECK(ok);
+    CHECK(decoded == msg);
+    if (decoded != msg)
+    {
+        printf("  %s\n  expected %s\n  decoded  %s\n", route.c_str(), msg.dump().c_str(),
+            decoded.dump().c_str());
+    }
+    return bytes;
+}
+
+// Writes the visitor calls as text, nested messages in braces.
+class TraceVisitor : public pomeloc::CodecVisitor
+{
+public:
+    void OnInt32(const pomeloc::CodecField& field, int32_t val)
+    {
+        trace += field.name_ + "=" + pomeloc::NumToString(val) + ";";
+        ++ints;
+    }
+    void OnUInt32(const pomeloc::CodecField& field, uint32_t val)
+    {
+        trace += field.name_ + "=u" + pomeloc::NumToString(val) + ";";
+    }
+    void OnFloat(const pomeloc::CodecField& field, float val)
+    {
+        trace += field.name_ + "=f" + pomeloc::NumToString(val) + ";";
+    }
+    void OnDouble(const pomeloc::CodecField& field, double val)
+    {
+        trace += field.name_ + "=d" + pomeloc::NumToString(val) + ";";
+    }
+    void OnString(const pomeloc::CodecField& field, const char* str, size_t len)
+    {
+        trace += field.name_ + "=\"" + std::string(str, len) + "\";";
+    }
+    void BeginMessage(const pomeloc::CodecField& field, const pomeloc::CodecMessage&)
+    {
+        trace += field.name_ + "{";
+        ++depth;
+    }
+    void EndMessage(const pomeloc::CodecField&, const pomeloc::CodecMessage&)
+    {
+        trace += "}";
+        --depth;
+    }
+
+    std::string trace;
+    int ints = 0;
+    int depth = 0;
+};
+
+// Every proper prefix of a message that ends inside a field fails, and no
+// prefix crashes.
+static void CheckTruncated(pomeloc::Codec& codec, int32_t id, const std::string& bytes)
+{
+    int errors = 0;
+    for (size_t len = 0; len < bytes.size(); ++len)
+    {
+        json out;
+        if (!codec.Decode(id, Bytes(bytes), len, &out))
+        {
+            CHECK(!codec.error_.empty());
+            ++errors;
+        }
+    }
+    CHECK(errors > 0);
+    json out;
+    CHECK(!codec.Decode(id, Bytes(bytes), bytes.size() - 1, &out));
+}
+
+// Random bytes decode or fail, they never crash.
+static void CheckGarbage(pomeloc::Codec& codec, int32_t id)
+{
+    uint32_t state = 0x9E3779B9u;
+    int errors = 0;
+    std::string buf;
+    for (int i = 0; i < 4000; ++i)
+    {
+        buf.clear();
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        size_t len = state % 48;
+        for (size_t j = 0; j < len; ++j)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            buf += static_cast<char>(state >> 24);
+        }
+        json out;
+        if (!codec.Decode(id, Bytes(buf), buf.size(), &out)) ++errors;
+    }
+    CHECK(errors > 0);
+    const std::string endless("\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff", 11);
+    json out;
+    CHECK(!codec.Decode(id, Bytes(endless), endless.size(), &out));
+}
+
+static void TestTypes()
+{
+    pomeloc::Parser parser;
+    CHECK(parser.Parse(kTypesProtos, "types.json"));
+    pomeloc::Codec codec;
+    bool loaded = codec.Load(parser);
+    CHECK(loaded);
+    if (!loaded)
+    {
+        printf("  %s\n", codec.error_.c_str());
+        return;
+    }
+    const std::string route = "test.typeHandler.all";
+    json msg = {
+        { "u", 4000000000u },
+        { "s", -2147483647 - 1 },
+        { "i", -1 },
+        { "f", -2.5 },
+        { "d", 0.1 },
+        { "str", "h\xc3\xa9llo \xe4\xb8\x96\xe7\x95\x8c \xf0\x9f\x9a\x80" },
+        { "ds", { 1e300, -0.0078125, 0.0 } },
+        { "fs", { 0.5, -1024.0 } },
+        { "us", { 0u, 127u, 128u, 4294967295u } },
+        { "strs", { "", "a", "\xe2\x82\xac" } },
+        { "inner", { { "d", -3.25 }, { "s", { -1, 1, 2147483647 } } } },
+        { "inners", { { { "d", 1.0 } }, { { "d", 2.0 }, { "s", { -64, 63 } } } } },
+    };
+    std::string bytes = RoundTrip(codec, route, pomeloc::kRequest, msg);
+
+    // zigzag keeps small negatives short: -1 is the single byte 0x01
+    const std::string tag_i_minus_one("\x18\x01", 2);
+    CHECK(bytes.find(tag_i_minus_one) != std::string::npos);
+
+    // a repeated field sent twice appends
+    json twice = { { "u", 1u }, { "s", 0 }, { "i", 0 }, { "f", 0.0 }, { "d", 0.0 },
+        { "str", "" }, { "us", { 7u } } };
+    std::string once;
+    CHECK(codec.EncodeRequest(route, twice, &once));
+    std::string doubled = once + once;
+    json out;
+    CHECK(codec.Decode(route, pomeloc::kRequest, Bytes(doubled), doubled.size(), &out));
+    CHECK(out["us"] == json({ 7u, 7u }));
+
+    int32_t id = codec.LookupRoute(route, pomeloc::kRequest);
+    CHECK(id >= 0);
+    TraceVisitor visitor;
+    CHECK(codec.Decode(id, Bytes(bytes), bytes.size(), &visitor));
+    CHECK(visitor.depth == 0);
+    CHECK(visitor.trace.find("u=u4000000000;s=-2147483648;i=-1;f=f-2.5;") == 0);
+    CHECK(visitor.trace.find("inner{d=d-3.25;s=-1;s=1;s=2147483647;}") != std::string::npos);
+
+    CheckTruncated(codec, id, bytes);
+    CheckGarbage(codec, id);
+}
+
+static void TestRoutes(const std::string& testdata)
+{
+    pomeloc::BinarySchemaFile file;
+    bool opened = file.Open(testdata + "/golden/default/clientProtos.pbfs");
+    CHECK(opened);
+    if (!opened)
+    {
+        printf("  %s\n", file.error_.c_str());
+        return;
+    }
+    pomeloc::Codec codec;
+    CHECK(codec.Load(*file.schema()));
+
+    // The same routes rebuilt as a merged parser compile to the same codes.
+    pomeloc::Parser parser;
+    std::string error;
+    CHECK(pomeloc::LoadBinarySchema(*file.schema(), &parser, &error));
+    pomeloc::Codec from_parser;
+    CHECK(from_parser.Load(parser));
+
+    const std::string query = "gate.gateHandler.queryEntry";
+    CHECK(codec.LookupRoute(query, pomeloc::kRequest) >= 0);
+    CHECK(codec.LookupRoute(query, pomeloc::kResponse) >= 0);
+    CHECK(codec.LookupRoute(query, pomeloc::kRequest) !=
+        codec.LookupRoute(query, pomeloc::kResponse));
+    CHECK(codec.LookupRoute(query, pomeloc::kPush) < 0);
+    CHECK(codec.LookupRoute("chat.chatHandler.recv", pomeloc::kResponse) < 0);
+    CHECK(codec.LookupRoute("onChat", pomeloc::kPush) >= 0);
+    CHECK(codec.LookupRoute("onChat", pomeloc::kRequest) < 0);
+
+    json request = { { "uid", "\xe7\x8e\xa9\xe5\xae\xb6" } };
+    RoundTrip(codec, query, pomeloc::kRequest, request);
+
+    json response = {
+        { "code", -1 },
+        { "host", "h\xc3\xa9.example" },
+        { "port", 70000 },
+        { "xxx", { -1, 0, 2147483647, -2147483647 - 1 } },
+        { "positions", {
+            { { "x", 1.0 }, { "y", 0.0 }, { "z", -1.0 } },
+            { { "x", 2.5 }, { "y", -0.5 }, { "z", 0.25 },
+              { "xx", { { "x", -3 }, { "y", 4 } } },
+              { "xxx", { { { "x", 7 }, { "y", -8 } }, { { "x", 9 }, { "y", 10 } } } } },
+        } },
+    };
+    std::string bytes = RoundTrip(codec, query, pomeloc::kResponse, response);
+    std::string same;
+    CHECK(from_parser.Encode(query, pomeloc::kResponse, response, &same));
+    CHECK(same == bytes);
+
+    // A bot decodes what the server sends back on the route it asked.
+    json out;
+    CHECK(codec.DecodeResponse(query, Bytes(bytes), bytes.size(), &out));
+    CHECK(out == response);
+    TraceVisitor visitor;
+    CHECK(codec.DecodeResponse(query, Bytes(bytes), bytes.size(), &visitor));
+    CHECK(visitor.depth == 0);
+    CHECK(visitor.trace.find("xxx=-1;xxx=0;xxx=2147483647;xxx=-2147483648;") !=
+        std::string::npos);
+    CHECK(visitor.trace.find("xxx{x=7;y=-8;}xxx{x=9;y=10;}") != std::string::npos);
+
+    // The response does not encode as the request of its route.
+    std::string wrong;
+    CHECK(!codec.EncodeRequest(query, response, &wrong));
+    CHECK(!codec.DecodePush(query, Bytes(bytes), bytes.size(), &out));
+    CHECK(!codec.error_.empty());
+
+    json chat = {
+        { "rid", "room" },
+        { "content", "\xe4\xbd\xa0\xe5\xa5\xbd" },
+        { "opti", -300 },
+        { "from", "a" },
+        { "target", "*" },
+        { "pos", { { "x", 1.5 }, { "y", 2.0 }, { "z", 3.0 } } },
+        { "positions", { { { "x", 0.0 }, { "y", 0.0 }, { "z", 0.0 },
+            { "xxx", { { { "x", -1 }, { "y", -2 } } } } } } },
+    };
+    RoundTrip(codec, "chat.chatHandler.send", pomeloc::kRequest, chat);
+
+    json push = { { "msg", "\xf0\x9f\x91\x8b" }, { "from", "a" }, { "target", "b" } };
+    std::string push_bytes = RoundTrip(codec, "onChat", pomeloc::kPush, push);
+    CHECK(codec.DecodePush("onChat", Bytes(push_bytes), push_bytes.size(), &out));
+    CHECK(out == push);
+
+    int32_t id = codec.LookupRoute(query, pomeloc::kResponse);
+    CheckTruncated(codec, id, bytes);
+    CheckGarbage(codec, id);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        printf("usage: %s <testdata dir>\n", argv[0]);
+        return 2;
+    }
+    TestTypes();
+    TestRoutes(argv[1]);
+    printf("%d checks, %d failures\n", checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,97 @@
+# Generated code must only depend on the protos, not on the order of their
+# keys, thread scheduling or the hash order of the standard library.
+# Compiles the testdata protos with every generator, in one file and in
+# --split mode, and once more with every C# option, and checks that
+#   - one thread and several threads write the same files,
+#   - the same protos with every key in reverse order do too,
+#   - the one file and the options outputs match the golden files in
+#     testdata/golden/default and testdata/golden/options.
+# After an intended change of the generated code refresh the golden files
+# with -DUPDATE_GOLDEN=ON.
+#
+#   cmake -DPOMELOC=<pomeloc> -DTESTDATA=<dir> -DWORK=<dir> -P deterministic_output.cmake
+
+foreach(var POMELOC TESTDATA WORK)
+  if(NOT DEFINED ${var})
+    message(FATAL_ERROR "${var} is not set")
+  endif()
+endforeach()
+
+set(generators --csharp --cpp --binary --route-dict --binary-schema)
+set(csharp_options --csharp --binary --route-dict
+  --pooled --value-structs --stream-json --read-json)
+
+function(run_pomeloc dir protos jobs)
+  file(REMOVE_RECURSE ${dir})
+  file(MAKE_DIRECTORY ${dir})
+  execute_process(
+    COMMAND ${POMELOC} ${ARGN} -j ${jobs} -o ${dir}/
+      --client ${protos}/clientProtos.json --server ${protos}/serverProtos.json
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE output)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "pomeloc failed in ${dir}:\n${output}")
+  endif()
+endfunction()
+
+# The manifest hashes the options, so it differs with -j by design.
+function(generated_files dir out)
+  file(GLOB_RECURSE files RELATIVE ${dir} ${dir}/*)
+  list(REMOVE_ITEM files .pomeloc.manifest)
+  list(SORT files)
+  set(${out} ${files} PARENT_SCOPE)
+endfunction()
+
+function(compare_dirs what expected actual)
+  generated_files(${expected} expected_files)
+  generated_files(${actual} actual_files)
+  if(NOT expected_files)
+    message(FATAL_ERROR "${what}: no files in ${expected}")
+  endif()
+  if(NOT expected_files STREQUAL actual_files)
+    message(FATAL_ERROR "${what}: different files\n  ${expected_files}\n  ${actual_files}")
+  endif()
+  foreach(file ${expected_files})
+    execute_process(
+      COMMAND ${CMAKE_COMMAND} -E compare_files ${expected}/${file} ${actual}/${file}
+      RESULT_VARIABLE different)
+    if(different)
+      message(FATAL_ERROR "${what}: ${file} differs")
+    endif()
+  endforeach()
+  list(LENGTH expected_files count)
+  message(STATUS "${what}: ${count} files identical")
+endfunction()
+
+foreach(mode one_file split options)
+  if(mode STREQUAL "split")
+    set(mode_args ${generators} --split)
+  elseif(mode STREQUAL "options")
+    set(mode_args ${csharp_options})
+  else()
+    set(mode_args ${generators})
+  endif()
+  run_pomeloc(${WORK}/${mode}/serial ${TESTDATA} 1 ${mode_args})
+  run_pomeloc(${WORK}/${mode}/parallel ${TESTDATA} 8 ${mode_args})
+  run_pomeloc(${WORK}/${mode}/reordered ${TESTDATA}/reordered 8 ${mode_args})
+  compare_dirs("${mode} -j 1 / -j 8" ${WORK}/${mode}/serial ${WORK}/${mode}/parallel)
+  compare_dirs("${mode} reordered keys" ${WORK}/${mode}/serial ${WORK}/${mode}/reordered)
+endforeach()
+
+foreach(golden default options)
+  if(golden STREQUAL "default")
+    set(serial ${WORK}/one_file/serial)
+  else()
+    set(serial ${WORK}/${golden}/serial)
+  endif()
+  if(UPDATE_GOLDEN)
+    file(REMOVE_RECURSE ${TESTDATA}/golden/${golden})
+    generated_files(${serial} files)
+    foreach(file ${files})
+      configure_file(${serial}/${file} ${TESTDATA}/golden/${golden}/${file} COPYONLY)
+    endforeach()
+    message(STATUS "updated ${TESTDATA}/golden/${golden}")
+  endif()
+  compare_dirs("golden ${golden}" ${TESTDATA}/golden/${golden} ${serial})
+endforeach()